@@ -0,0 +1,356 @@
+#define _POSIX_C_SOURCE 199309L
+#define CU_ARRAY_IMPL
+#include "../cu_array.h"
+#include "../cu_bench.h"
+
+void bench_cu_array_append();
+void bench_cu_array_extend();
+void bench_cu_array_insert_front();
+void bench_cu_array_remove_front();
+void bench_cu_array_qsort();
+void bench_cu_array_stable_sort();
+void bench_cu_array_merge_k();
+void bench_cu_array_scan();
+
+CU_RUN_BENCHES("cu_array benchmarks")
+{
+    CU_BENCH_PARSE_ARGS();
+    bench_cu_array_append();
+    bench_cu_array_extend();
+    bench_cu_array_insert_front();
+    bench_cu_array_remove_front();
+    bench_cu_array_qsort();
+    bench_cu_array_stable_sort();
+    bench_cu_array_merge_k();
+    bench_cu_array_scan();
+
+    CU_RUN_BENCHES_END();
+}
+
+static const size_t bench_item_sizes[3] = {4, 16, 64};
+
+// Items are `item_size` bytes with a random `uint32_t` key in the first 4.
+static unsigned char *bench_random_items(size_t item_size, size_t num_items)
+{
+    unsigned char *items = (unsigned char *)malloc(item_size * num_items);
+    uint32_t state = 2463534242u;
+    for (size_t i = 0; i < item_size * num_items; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        items[i] = (unsigned char)state;
+    }
+    return items;
+}
+
+void bench_cu_array_append()
+{
+    static const size_t sizes[2] = {1000, 100000};
+    char name[64];
+    unsigned char item[64] = {0};
+    for (size_t s = 0; s < 3; s++)
+    {
+        for (size_t n = 0; n < 2; n++)
+        {
+            snprintf(name, sizeof(name), "append n=%zu item=%zu", sizes[n], bench_item_sizes[s]);
+            CU_BENCH(name, sizes[n])
+            {
+                cu_array_t arr = (cu_array_t){0};
+                cu_array_init(&arr, bench_item_sizes[s]);
+                for (size_t i = 0; i < sizes[n]; i++)
+                {
+                    cu_array_append(&arr, item);
+                }
+                CU_BENCH_DO_NOT_OPTIMIZE(arr);
+                cu_array_deinit(&arr);
+            }
+        }
+    }
+}
+
+void bench_cu_array_extend()
+{
+    static const size_t sizes[2] = {1000, 100000};
+    char name[64];
+    for (size_t s = 0; s < 3; s++)
+    {
+        unsigned char *items = bench_random_items(bench_item_sizes[s], 100);
+        for (size_t n = 0; n < 2; n++)
+        {
+            snprintf(name, sizeof(name), "extend by 100 n=%zu item=%zu", sizes[n], bench_item_sizes[s]);
+            CU_BENCH(name, sizes[n])
+            {
+                cu_array_t arr = (cu_array_t){0};
+                cu_array_init(&arr, bench_item_sizes[s]);
+                for (size_t i = 0; i < sizes[n]; i += 100)
+                {
+                    cu_array_extend(&arr, items, 100);
+                }
+                CU_BENCH_DO_NOT_OPTIMIZE(arr);
+                cu_array_deinit(&arr);
+            }
+        }
+        free(items);
+    }
+}
+
+void bench_cu_array_insert_front()
+{
+    static const size_t sizes[2] = {1000, 10000};
+    char name[64];
+    unsigned char item[64] = {0};
+    for (size_t s = 0; s < 3; s++)
+    {
+        for (size_t n = 0; n < 2; n++)
+        {
+            snprintf(name, sizeof(name), "insert front n=%zu item=%zu", sizes[n], bench_item_sizes[s]);
+            CU_BENCH(name, sizes[n])
+            {
+                cu_array_t arr = (cu_array_t){0};
+                cu_array_init(&arr, bench_item_sizes[s]);
+                for (size_t i = 0; i < sizes[n]; i++)
+                {
+                    cu_array_insert(&arr, item, 0);
+                }
+                CU_BENCH_DO_NOT_OPTIMIZE(arr);
+                cu_array_deinit(&arr);
+            }
+        }
+    }
+}
+
+void bench_cu_array_remove_front()
+{
+    static const size_t sizes[2] = {1000, 10000};
+    char name[64];
+    for (size_t s = 0; s < 3; s++)
+    {
+        unsigned char *items = bench_random_items(bench_item_sizes[s], 10000);
+        for (size_t n = 0; n < 2; n++)
+        {
+            snprintf(name, sizeof(name), "remove_at front n=%zu item=%zu", sizes[n], bench_item_sizes[s]);
+            cu_array_t arr = (cu_array_t){0};
+            cu_array_init(&arr, bench_item_sizes[s]);
+            CU_BENCH(name, sizes[n])
+            {
+                CU_BENCH_PAUSE();
+                cu_array_extend(&arr, items, sizes[n]);
+                CU_BENCH_RESUME();
+                for (size_t i = 0; i < sizes[n]; i++)
+                {
+                    cu_array_remove_at(&arr, 0);
+                }
+                CU_BENCH_DO_NOT_OPTIMIZE(arr);
+            }
+            cu_array_deinit(&arr);
+        }
+        free(items);
+    }
+}
+
+static int bench_compare_key(void *a, void *b)
+{
+    uint32_t x, y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+static int bench_compare_key_libc(const void *a, const void *b)
+{
+    return bench_compare_key((void *)a, (void *)b);
+}
+
+void bench_cu_array_qsort()
+{
+    static const size_t sizes[3] = {100, 10000, 100000};
+    char name[64];
+    for (size_t s = 0; s < 3; s++)
+    {
+        size_t item_size = bench_item_sizes[s];
+        for (size_t n = 0; n < 3; n++)
+        {
+            unsigned char *items = bench_random_items(item_size, sizes[n]);
+            cu_array_t arr = (cu_array_t){0};
+            cu_array_init(&arr, item_size);
+            cu_array_extend(&arr, items, sizes[n]);
+
+            snprintf(name, sizeof(name), "cu_array_qsort n=%zu item=%zu", sizes[n], item_size);
+            CU_BENCH(name, sizes[n])
+            {
+                CU_BENCH_PAUSE();
+                memcpy(arr.data, items, item_size * sizes[n]);
+                CU_BENCH_RESUME();
+                cu_array_qsort(&arr, bench_compare_key);
+                CU_BENCH_DO_NOT_OPTIMIZE(arr);
+            }
+            snprintf(name, sizeof(name), "libc qsort n=%zu item=%zu", sizes[n], item_size);
+            CU_BENCH(name, sizes[n])
+            {
+                CU_BENCH_PAUSE();
+                memcpy(arr.data, items, item_size * sizes[n]);
+                CU_BENCH_RESUME();
+                qsort(arr.data, sizes[n], item_size, bench_compare_key_libc);
+                CU_BENCH_DO_NOT_OPTIMIZE(arr);
+            }
+            cu_array_deinit(&arr);
+            free(items);
+        }
+    }
+}
+
+void bench_cu_array_stable_sort()
+{
+    enum
+    {
+        N = 100000
+    };
+    static const char *patterns[2] = {"random", "runs=64"};
+    char name[64];
+    unsigned char *items = bench_random_items(sizeof(uint32_t), N);
+    cu_array_t input = (cu_array_t){0};
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&input, sizeof(uint32_t));
+    cu_array_init(&arr, sizeof(uint32_t));
+    cu_array_extend(&input, items, N);
+    cu_array_extend(&arr, items, N);
+    for (size_t p = 0; p < 2; p++)
+    {
+        if (p == 1)
+        {
+            // 64 sorted runs, e.g. concatenated shards.
+            for (size_t r = 0; r < 64; r++)
+            {
+                cu_array_t run = (cu_array_t){0};
+                cu_array_init_with_buffer(&run, sizeof(uint32_t), cu_array_at(&input, r * (N / 64)), N / 64);
+                run.length = N / 64;
+                cu_array_qsort(&run, bench_compare_key);
+            }
+        }
+        snprintf(name, sizeof(name), "stable_sort n=%d %s", N, patterns[p]);
+        CU_BENCH(name, N)
+        {
+            CU_BENCH_PAUSE();
+            memcpy(arr.data, input.data, sizeof(uint32_t) * N);
+            CU_BENCH_RESUME();
+            cu_array_stable_sort(&arr, bench_compare_key);
+            CU_BENCH_DO_NOT_OPTIMIZE(arr);
+        }
+        snprintf(name, sizeof(name), "qsort n=%d %s", N, patterns[p]);
+        CU_BENCH(name, N)
+        {
+            CU_BENCH_PAUSE();
+            memcpy(arr.data, input.data, sizeof(uint32_t) * N);
+            CU_BENCH_RESUME();
+            cu_array_qsort(&arr, bench_compare_key);
+            CU_BENCH_DO_NOT_OPTIMIZE(arr);
+        }
+    }
+    cu_array_deinit(&arr);
+    cu_array_deinit(&input);
+    free(items);
+}
+
+void bench_cu_array_merge_k()
+{
+    enum
+    {
+        N = 100000,
+        K = 32
+    };
+    unsigned char *items = bench_random_items(sizeof(uint32_t), N);
+    cu_array_t shards[K];
+    cu_array_t *srcs[K];
+    for (size_t k = 0; k < K; k++)
+    {
+        shards[k] = (cu_array_t){0};
+        cu_array_init(&shards[k], sizeof(uint32_t));
+        cu_array_extend(&shards[k], items + sizeof(uint32_t) * k * (N / K), N / K);
+        cu_array_qsort(&shards[k], bench_compare_key);
+        srcs[k] = &shards[k];
+    }
+    cu_array_t out = (cu_array_t){0};
+    cu_array_init(&out, sizeof(uint32_t));
+
+    CU_BENCH("merge_k n=100000 k=32", N)
+    {
+        cu_array_clear(&out);
+        cu_array_merge_k(&out, srcs, K, bench_compare_key);
+        CU_BENCH_DO_NOT_OPTIMIZE(out);
+    }
+    CU_BENCH("concat+qsort n=100000 k=32", N)
+    {
+        cu_array_clear(&out);
+        for (size_t k = 0; k < K; k++)
+        {
+            cu_array_extend(&out, shards[k].data, shards[k].length);
+        }
+        cu_array_qsort(&out, bench_compare_key);
+        CU_BENCH_DO_NOT_OPTIMIZE(out);
+    }
+    CU_BENCH("concat+stable_sort n=100000 k=32", N)
+    {
+        cu_array_clear(&out);
+        for (size_t k = 0; k < K; k++)
+        {
+            cu_array_extend(&out, shards[k].data, shards[k].length);
+        }
+        cu_array_stable_sort(&out, bench_compare_key);
+        CU_BENCH_DO_NOT_OPTIMIZE(out);
+    }
+    cu_array_deinit(&out);
+    for (size_t k = 0; k < K; k++)
+    {
+        cu_array_deinit(&shards[k]);
+    }
+    free(items);
+}
+
+static void bench_sum_chunk(void *items, size_t count, void *ctx)
+{
+    const uint32_t *keys = (const uint32_t *)items;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += keys[i];
+    }
+    *(uint64_t *)ctx += sum;
+}
+
+void bench_cu_array_scan()
+{
+    enum
+    {
+        N = 100000
+    };
+    unsigned char *items = bench_random_items(sizeof(uint32_t), N);
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(uint32_t));
+    cu_array_extend(&arr, items, N);
+    uint64_t sum = 0;
+
+    CU_BENCH("scan cu_array_at n=100000", N)
+    {
+        for (size_t i = 0; i < arr.length; i++)
+        {
+            sum += *(uint32_t *)cu_array_at(&arr, i);
+        }
+        CU_BENCH_DO_NOT_OPTIMIZE(sum);
+    }
+    CU_BENCH("scan CU_ARRAY_FOREACH n=100000", N)
+    {
+        CU_ARRAY_FOREACH(uint32_t, key, &arr)
+        {
+            sum += *key;
+        }
+        CU_BENCH_DO_NOT_OPTIMIZE(sum);
+    }
+    CU_BENCH("scan cu_array_for_each_chunk n=100000", N)
+    {
+        cu_array_for_each_chunk(&arr, 4096, bench_sum_chunk, &sum);
+        CU_BENCH_DO_NOT_OPTIMIZE(sum);
+    }
+    cu_array_deinit(&arr);
+    free(items);
+}
@@ -0,0 +1,315 @@
+/// @file cu_arena.h
+/// @brief Simple, header-only bump (arena) allocator for C.
+///
+/// Allocations are carved out of large blocks and are all freed at once with
+/// `cu_arena_reset()` or `cu_arena_deinit()`. The arena can be plugged into any
+/// `cu_*` container through `cu_arena_allocator()`, e.g.:
+/// ```C
+/// cu_arena_t arena = {0};
+/// cu_arena_init(&arena, 64 * 1024);
+/// cu_array_t arr = {0};
+/// cu_array_init_with_allocator(&arr, sizeof(int), cu_arena_allocator(&arena));
+/// ...
+/// cu_arena_deinit(&arena); // frees the array too, no need for cu_array_deinit()
+/// ```
+///
+/// To include function implementations, define:
+///     #define CU_ARENA_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_arena_init()`
+/// - `cu_arena_deinit()`
+/// - `cu_arena_alloc()`
+/// - `cu_arena_reset()`
+/// - `cu_arena_allocator()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_ARENA_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+/// @def CU_API
+/// @brief Override linkage keyword (default: extern or empty if CU_ARENA_IMPL is defined).
+/// @def CU_ARENA_ALIGNMENT
+/// @brief Alignment of every allocation, must be a power of two (default: 16). Can be larger than the alignment
+///        of `cu_malloc`, the data of each block is aligned explicitly.
+/// @def CU_NO_LIBC
+/// @brief Disable all standard library includes. You should define cu_malloc, cu_free, cu_memcpy.
+/// @def CU_NO_STDLIB_H
+/// @brief Disable inclusion of <stdlib.h>. You should define cu_malloc, cu_free.
+/// @def CU_NO_STRINGS_H
+/// @brief Disable inclusion of <string.h>. You should define cu_memcpy.
+
+#ifndef CU_ARENA_H
+#define CU_ARENA_H
+
+#ifndef CU_API
+#ifdef CU_ARENA_IMPL
+#define CU_API
+#else
+#define CU_API extern
+#endif // CU_ARENA_IMPL
+#endif // CU_API
+
+#if (!defined(CU_NO_STDLIB_H)) && (!defined(CU_NO_LIBC))
+#include <stdlib.h>
+#endif // (!defined(CU_NO_STDLIB_H)) && (!defined(CU_NO_LIBC))
+
+#if defined(CU_NO_STDLIB_H) || defined(CU_NO_LIBC)
+#include <stddef.h>
+#endif // defined(CU_NO_STDLIB_H) || defined(CU_NO_LIBC)
+
+#if (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
+#include <string.h>
+#endif // (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
+
+#ifndef CU_ARENA_ALIGNMENT
+#define CU_ARENA_ALIGNMENT (16u)
+#endif // CU_ARENA_ALIGNMENT
+
+#ifndef CU_ALLOCATOR_DEFINED
+#define CU_ALLOCATOR_DEFINED
+/// @brief Allocator interface, shared by all `cu_*` headers.
+/// @note The sizes passed to `realloc` and `free` are the sizes of the original allocation,
+///       so simple allocators (e.g. arenas) don't have to track them.
+typedef struct cu_allocator_s
+{
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} cu_allocator_t;
+#endif // CU_ALLOCATOR_DEFINED
+
+typedef struct cu_arena_block_s
+{
+    struct cu_arena_block_s *next;
+    size_t capacity;
+    size_t used;
+    /// Offset of the most recent allocation, it can be resized or freed in place.
+    size_t last;
+} cu_arena_block_t;
+
+typedef struct cu_arena_s
+{
+    cu_arena_block_t *head;
+    size_t block_size;
+    cu_allocator_t allocator;
+} cu_arena_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes an arena. Blocks are allocated lazily on the first `cu_arena_alloc`.
+    /// @note The arena must not be moved after initialization, its allocator points back to it.
+    /// @param arena Pointer to the arena.
+    /// @param block_size Size of each block in bytes. Larger allocations get a block of their own.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_arena_init(cu_arena_t *arena, size_t block_size);
+
+    /// @brief Frees every block of the arena and sets everything to zero.
+    /// @note Every pointer allocated from the arena is invalid afterwards.
+    /// @param arena Pointer to the arena.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_arena_deinit(cu_arena_t *arena);
+
+    /// @brief Allocates `size` bytes aligned to `CU_ARENA_ALIGNMENT`.
+    /// @param arena Pointer to the arena.
+    /// @param size Size of the allocation in bytes.
+    /// @return Pointer to the memory on success, `NULL` on error.
+    CU_API void *cu_arena_alloc(cu_arena_t *arena, size_t size);
+
+    /// @brief Frees all allocations at once, but keeps the most recent block for reuse.
+    /// @note Every pointer allocated from the arena is invalid afterwards.
+    /// @param arena Pointer to the arena.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_arena_reset(cu_arena_t *arena);
+
+    /// @brief Returns an allocator that allocates from `arena`, for `cu_array_init_with_allocator` and friends.
+    /// @note `realloc` grows the most recent allocation in place if it fits, `free` only gives back the most recent allocation.
+    /// @param arena Pointer to an initialized arena.
+    /// @return Pointer to the allocator (owned by the arena) on success, `NULL` on error.
+    CU_API const cu_allocator_t *cu_arena_allocator(cu_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_ARENA_H
+
+#ifdef CU_ARENA_IMPL
+
+#ifndef cu_malloc
+#define cu_malloc malloc
+#endif // cu_malloc
+#ifndef cu_free
+#define cu_free free
+#endif // cu_free
+#ifndef cu_memcpy
+#define cu_memcpy memcpy
+#endif // cu_memcpy
+
+// Definitions
+
+// Helper functions, not "public"
+
+#define __CU_ARENA_ALIGN_UP(x) (((x) + (CU_ARENA_ALIGNMENT - 1u)) & ~(size_t)(CU_ARENA_ALIGNMENT - 1u))
+// Room for the header and for aligning the data after it, `cu_malloc` may align less than `CU_ARENA_ALIGNMENT`.
+#define __CU_ARENA_HEADER_SIZE (sizeof(cu_arena_block_t) + (CU_ARENA_ALIGNMENT - 1u))
+// Largest allocation whose aligned size and block size don't overflow.
+#define __CU_ARENA_MAX_SIZE ((size_t)-1 - (CU_ARENA_ALIGNMENT - 1u) - __CU_ARENA_HEADER_SIZE)
+
+CU_API unsigned char *__cu_arena_block_data(cu_arena_block_t *block)
+{
+    size_t data = (size_t)(void *)((unsigned char *)block + sizeof(cu_arena_block_t));
+    return (unsigned char *)block + (__CU_ARENA_ALIGN_UP(data) - (size_t)(void *)block);
+}
+
+CU_API void *__cu_arena_allocator_alloc(void *ctx, size_t size)
+{
+    return cu_arena_alloc((cu_arena_t *)ctx, size);
+}
+
+CU_API void *__cu_arena_allocator_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+    cu_arena_t *arena = (cu_arena_t *)ctx;
+    cu_arena_block_t *head = arena->head;
+    if (ptr == NULL)
+    {
+        return cu_arena_alloc(arena, new_size);
+    }
+
+    // The most recent allocation can grow or shrink in place.
+    if (head != NULL && (unsigned char *)ptr == __cu_arena_block_data(head) + head->last &&
+        new_size <= head->capacity - head->last)
+    {
+        // Block capacities are aligned, so this can't go past the end.
+        head->used = __CU_ARENA_ALIGN_UP(head->last + new_size);
+        return ptr;
+    }
+
+    void *tmp = cu_arena_alloc(arena, new_size);
+    if (tmp == NULL)
+    {
+        return NULL;
+    }
+    cu_memcpy(tmp, ptr, old_size < new_size ? old_size : new_size);
+    return tmp;
+}
+
+CU_API void __cu_arena_allocator_free(void *ctx, void *ptr, size_t size)
+{
+    (void)size;
+    cu_arena_t *arena = (cu_arena_t *)ctx;
+    cu_arena_block_t *head = arena->head;
+    // Only the most recent allocation can be given back, the rest is freed with the arena.
+    if (head != NULL && ptr != NULL && (unsigned char *)ptr == __cu_arena_block_data(head) + head->last)
+    {
+        head->used = head->last;
+    }
+}
+
+// "Public" function definitions
+
+CU_API int cu_arena_init(cu_arena_t *arena, size_t block_size)
+{
+    if (arena == NULL || arena->head != NULL || block_size == 0u || block_size > __CU_ARENA_MAX_SIZE)
+    {
+        return 1;
+    }
+
+    *arena = (cu_arena_t){0};
+    arena->block_size = __CU_ARENA_ALIGN_UP(block_size);
+    arena->allocator.alloc = __cu_arena_allocator_alloc;
+    arena->allocator.realloc = __cu_arena_allocator_realloc;
+    arena->allocator.free = __cu_arena_allocator_free;
+    arena->allocator.ctx = arena;
+    return 0;
+}
+
+CU_API int cu_arena_deinit(cu_arena_t *arena)
+{
+    if (arena == NULL || arena->block_size == 0u)
+    {
+        return 1;
+    }
+
+    cu_arena_block_t *block = arena->head;
+    while (block != NULL)
+    {
+        cu_arena_block_t *next = block->next;
+        cu_free(block);
+        block = next;
+    }
+    *arena = (cu_arena_t){0};
+    return 0;
+}
+
+CU_API void *cu_arena_alloc(cu_arena_t *arena, size_t size)
+{
+    if (arena == NULL || arena->block_size == 0u || size > __CU_ARENA_MAX_SIZE)
+    {
+        return NULL;
+    }
+
+    size_t aligned_size = __CU_ARENA_ALIGN_UP(size);
+    cu_arena_block_t *head = arena->head;
+    if (head == NULL || head->capacity - head->used < aligned_size)
+    {
+        size_t capacity = aligned_size > arena->block_size ? aligned_size : arena->block_size;
+        cu_arena_block_t *block = (cu_arena_block_t *)cu_malloc(__CU_ARENA_HEADER_SIZE + capacity);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->next = head;
+        block->capacity = capacity;
+        block->used = 0;
+        block->last = 0;
+        arena->head = block;
+        head = block;
+    }
+
+    head->last = head->used;
+    head->used += aligned_size;
+    return __cu_arena_block_data(head) + head->last;
+}
+
+CU_API int cu_arena_reset(cu_arena_t *arena)
+{
+    if (arena == NULL || arena->block_size == 0u)
+    {
+        return 1;
+    }
+    if (arena->head == NULL)
+    {
+        return 0;
+    }
+
+    cu_arena_block_t *block = arena->head->next;
+    while (block != NULL)
+    {
+        cu_arena_block_t *next = block->next;
+        cu_free(block);
+        block = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+    arena->head->last = 0;
+    return 0;
+}
+
+CU_API const cu_allocator_t *cu_arena_allocator(cu_arena_t *arena)
+{
+    if (arena == NULL || arena->block_size == 0u)
+    {
+        return NULL;
+    }
+    return &arena->allocator;
+}
+
+#endif // CU_ARENA_IMPL
@@ -13,14 +13,59 @@
 ///
 /// ### Main API
 /// - `cu_array_init()`
+/// - `cu_array_init_with_allocator()`
+/// - `cu_array_init_with_buffer()`
+/// - `cu_array_init_aligned()` / `cu_array_init_padded()`
+/// - `cu_array_init_mmap()` (with `CU_ARRAY_MMAP`)
+/// - `cu_array_save()` / `cu_array_map()` (with `CU_ARRAY_MMAP`)
+/// - `cu_array_write_fd()` / `cu_array_writev_fd()` / `cu_array_read_chunk()` (with `CU_ARRAY_IO`)
 /// - `cu_array_deinit()`
 /// - `cu_array_append()`
 /// - `cu_array_insert()`
+/// - `cu_array_insert_range()`
+/// - `cu_array_emplace_n()`
 /// - `cu_array_extend()`
 /// - `cu_array_remove_at()`
+/// - `cu_array_remove_range()`
+/// - `cu_array_swap_remove()`
+/// - `cu_array_retain()`
 /// - `cu_array_clear()`
+/// - `cu_array_move()` / `cu_array_swap()` / `cu_array_detach()`
+/// - `cu_array_shrink_to_fit()`
+/// - `cu_array_set_growth()`
 /// - `cu_array_qsort()`
+/// - `cu_array_qsort_r()`
+/// - `cu_array_radix_sort()`
+/// - `cu_array_stable_sort()` / `cu_array_stable_sort_r()`
+/// - `cu_array_merge_k()`
+/// - `cu_array_lower_bound()`
+/// - `cu_array_upper_bound()`
+/// - `cu_array_bsearch()`
+/// - `cu_array_insert_sorted()`
+/// - `cu_array_eytzinger_build()`
+/// - `cu_array_eytzinger_lower_bound()`
+/// - `cu_array_eytzinger_search()`
+/// - `cu_array_view()` / `cu_array_slice()` / `cu_array_view_slice()` / `cu_array_view_at()`
+/// - `cu_array_from_view()`
+/// - `cu_array_view_qsort()` / `cu_array_view_lower_bound()` / `cu_array_view_bsearch()`
 /// - `cu_array_at()`
+/// - `cu_array_begin()` / `cu_array_end()`
+/// - `cu_array_iter()` / `cu_array_iter_next()`
+/// - `cu_array_for_each_chunk()`
+/// - `cu_array_set_stats_hook()` (with `CU_ARRAY_STATS`)
+///
+/// ### Typed arrays
+/// - `CU_ARRAY_DEFINE(T)` generates `cu_array_T_t` and `static inline` wrappers
+///   (`cu_array_T_init()`, `cu_array_T_append()`, `cu_array_T_at()`, ...) with a compile-time item size.
+///
+/// - `CU_ARRAY_DEFINE_ORDERED(T)` adds `cu_array_T_lower_bound()`, `cu_array_T_upper_bound()`, `cu_array_T_bsearch()`,
+///   `cu_array_T_insert_sorted()` and `cu_array_T_eytzinger_lower_bound()` for types ordered by `<`.
+///
+/// ### Small arrays
+/// - `CU_SARRAY(T, N)` declares an array with inline storage for `N` items, initialized with `CU_SARRAY_INIT()`.
+///
+/// ### Loops
+/// - `CU_ARRAY_FOREACH(T, it, arr)` loops over the items as `T *it`, without per-item checks.
 ///
 /// @see `tests/` for examples.
 /// 
@@ -29,23 +74,55 @@
 /// @def CU_API
 /// @brief Override linkage keyword (default: extern or empty if CU_ARRAY_IMPL is defined).
 /// @def CU_UNIT
-/// @brief Type used for raw array storage (default: unsigned char). Override it if you want to store word sized data for example. (Doesn't work at the moment, still needs some work with pointer arithmetics).
+/// @brief Type used for raw array storage (default: unsigned char), e.g. `uint32_t` or `uint64_t` for arrays of word sized items.
+/// Item sizes, offsets and growth stay in bytes, but every item size must be a multiple of `sizeof(CU_UNIT)`, so the storage
+/// (and every item in it) is aligned to the unit. Items of 4, 8 and 16 bytes are copied and swapped with fixed-size word moves.
+/// Pointers returned by the functions are `CU_UNIT *`, cast them to the item type, don't do arithmetic on them.
 /// @def CU_ARRAY_DEFAULT_SIZE
-/// @brief Initial array capacity (default: 32).
-/// @def CU_ARRAY_MAX_ITEM_SIZE
-/// @brief Maximum size used for internal static swap buffer during qsort (default: 128).
+/// @brief Capacity of the first allocation, made lazily by the first insertion (default: 32).
+/// @def CU_ARRAY_SWAP_CHUNK_SIZE
+/// @brief Size of the stack buffer used to swap unaligned items during sorting, larger items are swapped in chunks (default: 64).
+/// @def CU_ARRAY_SORT_INSERTION_THRESHOLD
+/// @brief Partitions with at most this many items are finished with insertion sort (default: 16).
+/// @def CU_ARRAY_SORT_NINTHER_THRESHOLD
+/// @brief Partitions with at least this many items pick the pivot with Tukey's ninther instead of median-of-three (default: 128).
+/// @def CU_ARRAY_STABLE_SORT_MIN_RUN
+/// @brief Runs shorter than this are extended with insertion sort by `cu_array_stable_sort()`, the actual minimum is between it and twice it (default: 32).
+/// @def CU_ARRAY_PREFETCH
+/// @brief Prefetch hint used by the searches, `CU_ARRAY_PREFETCH(addr)` (default: `__builtin_prefetch` on GCC and Clang, nothing otherwise).
+/// @def CU_ARRAY_CHUNK_PREFETCH_DISTANCE
+/// @brief Bytes ahead of the current chunk that `cu_array_for_each_chunk()` prefetches, `0` disables it (default: 0).
+/// Sequential scans are usually covered by the hardware prefetcher, try it when `fn` is heavy on other memory.
 /// @def CU_GROWTH_RATE_SPEED
-/// @brief Use fast power-of-two resizing. Might waste memory.
+/// @brief Use fast power-of-two resizing. Might waste memory. Can be overridden per array with `cu_array_set_growth()`.
 /// @def CU_GROWTH_RATE_SPACE
 /// @brief Use conservative 2x growth. Mutually exclusive with CU_GROWTH_RATE_SPEED. Default behaviour.
 /// @def CU_DEBUG
 /// @brief Enables debug features (like _cu_array_debug_print() and __CU_DEBUG_HERE).
+/// @def CU_ARRAY_STATS
+/// @brief Adds per-array counters (`cu_array_t.stats`) for growth, reserves and the bytes moved by insert/remove,
+/// and `cu_array_set_stats_hook()` to export them. Without it everything compiles to nothing.
 /// @def CU_NO_LIBC
 /// @brief Disable all standard library includes. You should define cu_malloc, cu_free, cu_realloc, cu_memmove, cu_memcpy.
 /// @def CU_NO_STDLIB_H
 /// @brief Disable inclusion of <stdlib.h>. You should define cu_malloc, cu_free, cu_realloc.
 /// @def CU_NO_STRINGS_H
 /// @brief Disable inclusion of <string.h>. You should define cu_memmove, cu_memcpy.
+/// @def CU_ARRAY_THREADS
+/// @brief Enables `cu_array_psort()`. Includes <pthread.h>, link with `-pthread`.
+/// @def CU_ARRAY_PSORT_THRESHOLD
+/// @brief Partitions smaller than this are sorted by a single thread in `cu_array_psort()` (default: 65536).
+/// @def CU_ARRAY_MMAP
+/// @brief Enables the `mmap` storage backend (`cu_array_init_mmap()`) and the file functions (`cu_array_save()`, `cu_array_map()`).
+/// Includes <fcntl.h>, <sys/mman.h>, <sys/stat.h> and <unistd.h>.
+/// On Linux, define `_GNU_SOURCE` before including any header, so growth uses `mremap` and never copies.
+/// @def CU_ARRAY_IO
+/// @brief Enables streaming the items to and from file descriptors (`cu_array_write_fd()`, `cu_array_writev_fd()`,
+/// `cu_array_read_chunk()`). Includes <errno.h>, <limits.h>, <sys/uio.h> and <unistd.h>, needs POSIX (e.g. `_POSIX_C_SOURCE 200809L`).
+/// @def CU_ARRAY_IO_BATCH_SIZE
+/// @brief Maximum number of bytes per `read`/`writev` call of the `CU_ARRAY_IO` functions (default: 1 GiB).
+/// @def CU_ARRAY_HUGE_PAGE_SIZE
+/// @brief Allocation granularity with `CU_ARRAY_MMAP_HUGE_PAGES` (default: 2 MiB).
 
 #ifndef CU_ARRAY_H
 #define CU_ARRAY_H
@@ -89,14 +166,202 @@
 #include <string.h>
 #endif // (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
 
+// Freestanding header, fine with CU_NO_LIBC too.
+#include <stdint.h>
+
+#if defined(CU_ARRAY_THREADS)
+#include <pthread.h>
+#endif // defined(CU_ARRAY_THREADS)
+
+#if defined(CU_ARRAY_MMAP)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if (!defined(MAP_ANONYMOUS)) && (defined(MAP_ANON))
+#define MAP_ANONYMOUS MAP_ANON
+#endif // (!defined(MAP_ANONYMOUS)) && (defined(MAP_ANON))
+#endif // defined(CU_ARRAY_MMAP)
+
+#if defined(CU_ARRAY_IO)
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif // defined(CU_ARRAY_IO)
+
+#ifndef CU_ARRAY_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define CU_ARRAY_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define CU_ARRAY_PREFETCH(addr) ((void)0)
+#endif // defined(__GNUC__) || defined(__clang__)
+#endif // CU_ARRAY_PREFETCH
+
+#ifndef CU_ARRAY_CHUNK_PREFETCH_DISTANCE
+#define CU_ARRAY_CHUNK_PREFETCH_DISTANCE (0u)
+#endif // CU_ARRAY_CHUNK_PREFETCH_DISTANCE
+
+/// @brief Key is an unsigned integer (`cu_array_radix_sort` flag).
+#define CU_RADIX_UNSIGNED (0u)
+/// @brief Key is a two's complement signed integer (`cu_array_radix_sort` flag).
+#define CU_RADIX_SIGNED (1u)
+/// @brief Key is an IEEE 754 `float` (width 4) or `double` (width 8) (`cu_array_radix_sort` flag).
+#define CU_RADIX_FLOAT (2u)
+/// @brief Sort in descending order (`cu_array_radix_sort` flag).
+#define CU_RADIX_DESCENDING (4u)
+
+/// @brief Advise the kernel to back the storage with transparent huge pages (`cu_array_init_mmap` flag).
+#define CU_ARRAY_MMAP_HUGE_PAGES (1u)
+
+/// @brief The storage of the array is not owned by it (`cu_array_t.flags`).
+/// It is never freed or reallocated, the first growth moves the items to memory from the allocator.
+#define CU_ARRAY_EXTERNAL_STORAGE (1u)
+/// @brief The storage is a file mapping from `cu_array_map` (`cu_array_t.flags`).
+/// It is unmapped by `cu_array_deinit`, the first growth moves the items to memory from the allocator.
+#define CU_ARRAY_MAPPED (2u)
+/// @brief The storage can't be written (`cu_array_t.flags`).
+/// The first modification moves the items to memory from the allocator.
+#define CU_ARRAY_READONLY (4u)
+
+/// @brief Map the file read-only, shared with other processes (`cu_array_map` flag).
+#define CU_ARRAY_MAP_READONLY (1u)
+/// @brief Map the file copy-on-write, changes stay private and are never written back (`cu_array_map` flag).
+#define CU_ARRAY_MAP_COPY_ON_WRITE (2u)
+/// @brief Check the checksum of the items after mapping, reads the whole file (`cu_array_map` flag).
+#define CU_ARRAY_MAP_VERIFY (4u)
+
+/// @brief Magic bytes at the start of files written by `cu_array_save`.
+#define CU_ARRAY_FILE_MAGIC "CUARRAY"
+/// @brief Version of the file format.
+#define CU_ARRAY_FILE_VERSION (1u)
+/// @brief Offset of the items in the file, so they are aligned to 64 bytes in the mapping.
+#define CU_ARRAY_FILE_DATA_OFFSET (64u)
+
+/// @brief Header of the files written by `cu_array_save`, followed by the raw items at `CU_ARRAY_FILE_DATA_OFFSET`.
+/// @note All fields are in native byte order, files are not portable between architectures.
+typedef struct cu_array_file_header_s
+{
+    char magic[8];
+    uint32_t version;
+    /// Offset (and alignment) of the items, `CU_ARRAY_FILE_DATA_OFFSET`.
+    uint32_t data_offset;
+    uint64_t item_size;
+    uint64_t length;
+    /// 64-bit FNV-1a hash of the items.
+    uint64_t checksum;
+} cu_array_file_header_t;
+
+#ifndef CU_ALLOCATOR_DEFINED
+#define CU_ALLOCATOR_DEFINED
+/// @brief Allocator interface, shared by all `cu_*` headers.
+/// @note The sizes passed to `realloc` and `free` are the sizes of the original allocation,
+///       so simple allocators (e.g. arenas) don't have to track them.
+typedef struct cu_allocator_s
+{
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} cu_allocator_t;
+#endif // CU_ALLOCATOR_DEFINED
+
+/// @brief Runtime growth policy of an array, see `cu_array_set_growth`.
+/// ```C
+/// // 1.5x up to 1M items, then 256K items at a time, never more than 64M items.
+/// static const cu_array_growth_t growth = {16, 3, 2, 1u << 20, 1u << 18, 1u << 26};
+/// ```
+typedef struct cu_array_growth_s
+{
+    /// Capacity of the first allocation, `0` means `CU_ARRAY_DEFAULT_SIZE`.
+    size_t initial_capacity;
+    /// Capacity is multiplied by `factor_num / factor_den` (e.g. `3 / 2` for 1.5x).
+    size_t factor_num;
+    size_t factor_den;
+    /// From this capacity on, grow by `linear_increment` items instead, `0` disables it.
+    size_t linear_threshold;
+    size_t linear_increment;
+    /// Hard limit for the capacity (also for `cu_array_reserve`), `0` means no limit.
+    size_t max_capacity;
+} cu_array_growth_t;
+
+#ifdef CU_ARRAY_STATS
+/// @brief The storage was reallocated at the same or a larger capacity (`cu_array_stats_hook_t` event).
+#define CU_ARRAY_STATS_GROW (0u)
+/// @brief The storage was reallocated at a smaller capacity (`cu_array_stats_hook_t` event).
+#define CU_ARRAY_STATS_SHRINK (1u)
+/// @brief `cu_array_reserve` was called (`cu_array_stats_hook_t` event).
+#define CU_ARRAY_STATS_RESERVE (2u)
+/// @brief Items were shifted by an insert or a removal (`cu_array_stats_hook_t` event).
+#define CU_ARRAY_STATS_MOVE (3u)
+/// @brief The array is about to be deinitialized, last chance to read `stats` (`cu_array_stats_hook_t` event).
+#define CU_ARRAY_STATS_DEINIT (4u)
+
+/// @brief Counters of an array, updated with `CU_ARRAY_STATS`. All sizes are in bytes.
+typedef struct cu_array_stats_s
+{
+    /// Reallocations of the storage at the same or a larger capacity, including the first allocation.
+    size_t grows;
+    size_t shrinks;
+    size_t reserves;
+    /// Bytes copied by reallocations that moved the storage.
+    size_t copied_bytes;
+    /// Inserts and removals that shifted items, and the bytes they shifted.
+    size_t moves;
+    size_t moved_bytes;
+    size_t peak_length;
+    size_t peak_capacity;
+} cu_array_stats_t;
+#endif // CU_ARRAY_STATS
+
 typedef struct cu_array_s
 {
     CU_UNIT *data;
     size_t item_size;
     size_t length;
     size_t capacity;
+    /// `NULL` means `cu_malloc`, `cu_realloc` and `cu_free`.
+    const cu_allocator_t *allocator;
+    /// `NULL` means the compile-time `CU_GROWTH_RATE_SPEED`/`CU_GROWTH_RATE_SPACE`.
+    const cu_array_growth_t *growth;
+    /// Storage flags, e.g. `CU_ARRAY_EXTERNAL_STORAGE`.
+    unsigned int flags;
+    /// Alignment of the storage in bytes, `0` for whatever the allocator returns.
+    size_t alignment;
+#ifdef CU_ARRAY_STATS
+    cu_array_stats_t stats;
+#endif // CU_ARRAY_STATS
 } cu_array_t;
 
+/// @brief Unchecked cursor over the items of an array, see `cu_array_iter`.
+typedef struct cu_array_iter_s
+{
+    CU_UNIT *ptr;
+    CU_UNIT *end;
+    /// Distance between two items, `item_size`.
+    size_t stride;
+} cu_array_iter_t;
+
+/// @brief Non-owning slice of the items of an array (or of any buffer), see `cu_array_view` and `cu_array_slice`.
+typedef struct cu_array_view_s
+{
+    CU_UNIT *data;
+    size_t length;
+    size_t item_size;
+    /// `CU_ARRAY_READONLY` if the items must not be written (e.g. a view of a `CU_ARRAY_MAP_READONLY` array).
+    unsigned int flags;
+} cu_array_view_t;
+
+#ifdef CU_ARRAY_STATS
+/// @brief Called after every counted event, e.g. to export `arr->stats` to a metrics system.
+/// @param arr The array, its fields and `stats` are already updated.
+/// @param event `CU_ARRAY_STATS_GROW`, `CU_ARRAY_STATS_SHRINK`, ...
+/// @param bytes Bytes copied or shifted by the event, `0` for the others.
+/// @param ctx Context given to `cu_array_set_stats_hook`.
+typedef void (*cu_array_stats_hook_t)(cu_array_t *arr, unsigned int event, size_t bytes, void *ctx);
+#endif // CU_ARRAY_STATS
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -104,12 +369,116 @@ extern "C"
 
     // Declarations
 
-    /// @brief Initializes a dynamic array with capacity `CU_ARRAY_DEFAULT_SIZE`.
+    /// @brief Initializes an empty dynamic array.
+    /// @note Doesn't allocate, the first insertion allocates `CU_ARRAY_DEFAULT_SIZE` items
+    ///       (or `initial_capacity` of the growth policy).
     /// @param arr Pointer to the array.
-    /// @param item_size Size of each item in `CU_UNIT`.
+    /// @param item_size Size of each item in bytes, a multiple of `sizeof(CU_UNIT)`.
     /// @return `0` on success, `1` on error.
     CU_API int cu_array_init(cu_array_t *arr, size_t item_size);
 
+    /// @brief Same as `cu_array_init`, but all memory of the array comes from `allocator`.
+    /// @note The allocator is not copied, it must outlive the array.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of each item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param allocator Pointer to the allocator, `NULL` for the default `cu_malloc`/`cu_realloc`/`cu_free`.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_init_with_allocator(cu_array_t *arr, size_t item_size, const cu_allocator_t *allocator);
+
+    /// @brief Initializes a dynamic array on top of a caller-provided buffer of `capacity` items.
+    /// @note The buffer is used until the array outgrows it, then the items move to memory from `cu_malloc`.
+    ///       The buffer is never freed by the array. See `CU_SARRAY` for buffers embedded in a struct.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of each item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param buffer Pointer to the buffer, must be aligned for the items.
+    /// @param capacity Capacity of the buffer in items.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_init_with_buffer(cu_array_t *arr, size_t item_size, void *buffer, size_t capacity);
+
+    /// @brief Same as `cu_array_init`, but the storage is always aligned to `alignment` bytes, also after growing.
+    /// @note Aligned storage is over-allocated by `alignment - 1 + sizeof(void *)` bytes and grows by copying,
+    ///       since `realloc` keeps no alignment.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of each item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param alignment Power of two, e.g. `32` for AVX loads or `64` for a cache line.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_init_aligned(cu_array_t *arr, size_t item_size, size_t alignment);
+
+    /// @brief Same as `cu_array_init_aligned`, but `item_size` is rounded up to a multiple of `alignment`,
+    ///        so every item starts on its own boundary (e.g. one cache line per item against false sharing).
+    /// @note `arr->item_size` is the padded stride: items copied in (`append`, `insert`, ...) must be that large,
+    ///       or use `cu_array_emplace_n` and write the items in place.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of each item in bytes, before padding.
+    /// @param alignment Power of two.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_init_padded(cu_array_t *arr, size_t item_size, size_t alignment);
+
+#ifdef CU_ARRAY_MMAP
+    /// @brief Same as `cu_array_init`, but the storage is mapped directly with `mmap`, for very large arrays.
+    /// @note Pages are only committed when they are touched. With `mremap` (Linux) growth remaps the pages
+    ///       instead of copying them, so it doesn't copy the items or temporarily double the memory usage.
+    /// @note Only available if `CU_ARRAY_MMAP` is defined. Allocations are rounded up to whole pages.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of each item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param mmap_flags `0` or `CU_ARRAY_MMAP_HUGE_PAGES`.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_init_mmap(cu_array_t *arr, size_t item_size, unsigned int mmap_flags);
+
+    /// @brief Returns the allocator used by `cu_array_init_mmap`, e.g. to use it for other containers.
+    /// @param mmap_flags `0` or `CU_ARRAY_MMAP_HUGE_PAGES`.
+    /// @return Pointer to a static allocator.
+    CU_API const cu_allocator_t *cu_array_mmap_allocator(unsigned int mmap_flags);
+
+    /// @brief Writes the array to `path` (header + raw items), so it can be mapped later with `cu_array_map`.
+    /// @note Only available if `CU_ARRAY_MMAP` is defined. The file is overwritten if it exists.
+    /// @param arr Pointer to the array.
+    /// @param path Path of the file.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_save(cu_array_t *arr, const char *path);
+
+    /// @brief Initializes an array from a file written by `cu_array_save`, without copying or parsing the items.
+    /// @note The items are mapped straight from the file, so they are usable immediately.
+    ///       The first growth (and with `CU_ARRAY_MAP_READONLY` the first modification) moves them to memory from `cu_malloc`.
+    /// @note Only available if `CU_ARRAY_MMAP` is defined. The array must be zeroed, like for `cu_array_init`.
+    /// @param arr Pointer to the array.
+    /// @param path Path of the file.
+    /// @param flags `CU_ARRAY_MAP_READONLY` or `CU_ARRAY_MAP_COPY_ON_WRITE`, optionally `| CU_ARRAY_MAP_VERIFY`.
+    /// @return `0` on success, `1` on error (I/O error, invalid header or checksum mismatch).
+    CU_API int cu_array_map(cu_array_t *arr, const char *path, unsigned int flags);
+#endif // CU_ARRAY_MMAP
+
+#ifdef CU_ARRAY_IO
+    /// @brief Writes the raw items of the array to `fd`, without a header.
+    /// @note Only available if `CU_ARRAY_IO` is defined. Same as `cu_array_writev_fd` with a single array.
+    /// @param arr Pointer to the array.
+    /// @param fd File descriptor opened for writing (file, pipe or socket), in blocking mode.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_write_fd(cu_array_t *arr, int fd);
+
+    /// @brief Writes the raw items of `count` arrays to `fd`, one after the other.
+    /// @note The arrays are gathered into `writev` calls of up to `CU_ARRAY_IO_BATCH_SIZE` bytes, so many small arrays
+    ///       take a single system call. Partial writes and `EINTR` are retried.
+    /// @note Only available if `CU_ARRAY_IO` is defined.
+    /// @param arrs Pointers to the arrays.
+    /// @param count Number of arrays.
+    /// @param fd File descriptor opened for writing (file, pipe or socket), in blocking mode.
+    /// @return `0` on success, `1` on error (the data may be partially written then).
+    CU_API int cu_array_writev_fd(cu_array_t **arrs, size_t count, int fd);
+
+    /// @brief Replaces the items of the array with the next window of up to `max_items` items read from `fd`.
+    /// @note Fills the whole window unless the end of the stream is reached, `arr->length == 0` means the end.
+    ///       The storage is reserved once and reused by the next calls, so a stream of any size is processed
+    ///       in constant memory: `while (cu_array_read_chunk(&arr, fd, 4096) == 0 && arr.length > 0) { ... }`.
+    /// @note Only available if `CU_ARRAY_IO` is defined.
+    /// @param arr Pointer to the array.
+    /// @param fd File descriptor opened for reading, in blocking mode.
+    /// @param max_items Size of the window, `0` for the current capacity (e.g. of a `CU_SARRAY`).
+    /// @return `0` on success, `1` on error (I/O error, or the stream ended in the middle of an item,
+    ///         the complete items are in the array then).
+    CU_API int cu_array_read_chunk(cu_array_t *arr, int fd, size_t max_items);
+#endif // CU_ARRAY_IO
+
     /// @brief Deinitializes a dynamic array, free the underlying data and set everything to zero.
     /// @param arr Pointer to the array.
     /// @return `0` on success, `1` on error.
@@ -122,6 +491,36 @@ extern "C"
     /// @return Pointer to item on success, `NULL` on error.
     CU_API CU_UNIT *cu_array_at(cu_array_t *arr, size_t pos);
 
+    /// @brief Returns a pointer to the first item, for loops that check the array once instead of every item.
+    /// @note Any modification of the array can move the items.
+    /// @param arr Pointer to the array.
+    /// @return Pointer to the first item, `NULL` on error or if nothing was allocated yet (then `cu_array_end` is `NULL` too).
+    CU_API CU_UNIT *cu_array_begin(cu_array_t *arr);
+
+    /// @brief Returns a pointer one past the last item, `item_size * length` bytes after `cu_array_begin(arr)`.
+    /// @param arr Pointer to the array.
+    /// @return Pointer past the last item, `NULL` on error or if nothing was allocated yet.
+    CU_API CU_UNIT *cu_array_end(cu_array_t *arr);
+
+    /// @brief Returns a cursor over the items, advanced with `cu_array_iter_next`.
+    /// ```C
+    /// cu_array_iter_t it = cu_array_iter(&arr);
+    /// for (CU_UNIT *item; (item = cu_array_iter_next(&it)) != NULL;) { ... }
+    /// ```
+    /// @note Any modification of the array can move the items and invalidate the cursor.
+    /// @param arr Pointer to the array.
+    /// @return Cursor on the first item, an empty cursor on error.
+    CU_API cu_array_iter_t cu_array_iter(cu_array_t *arr);
+
+    /// @brief Calls `fn` on consecutive runs of at most `chunk` items, in order.
+    /// @note Prefetches `CU_ARRAY_CHUNK_PREFETCH_DISTANCE` bytes ahead of each chunk before calling `fn` on it.
+    /// @param arr Pointer to the array.
+    /// @param chunk Maximum number of items per call, `> 0`.
+    /// @param fn Called with the first item of the chunk, the number of items and `ctx`.
+    /// @param ctx Passed to every call of `fn`.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_for_each_chunk(cu_array_t *arr, size_t chunk, void (*fn)(void *, size_t, void *), void *ctx);
+
     /// @brief Appends a single item to the end of the array.
     /// @param arr Pointer to the array.
     /// @param item Pointer to the item to append.
@@ -143,29 +542,108 @@ extern "C"
     /// @return `0` on success, `1` on error.
     CU_API int cu_array_insert(cu_array_t *arr, void *item, size_t pos);
 
+    /// @brief Inserts `num_items` items at position `pos`, with one reservation and one move of the tail.
+    /// @note `items` must not point into the array itself.
+    /// @param arr Pointer to the array.
+    /// @param items Pointer to the first item to insert.
+    /// @param num_items Number of items to insert.
+    /// @param pos Insertion index.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_insert_range(cu_array_t *arr, void *items, size_t num_items, size_t pos);
+
+    /// @brief Appends `num_items` uninitialized items and returns a pointer to the first one, to be filled in place.
+    /// @note The pointer is valid until the next operation that can grow the array.
+    /// @param arr Pointer to the array.
+    /// @param num_items Number of items to add, must not be `0`.
+    /// @return Pointer to the first new item on success, `NULL` on error.
+    CU_API CU_UNIT *cu_array_emplace_n(cu_array_t *arr, size_t num_items);
+
     /// @brief Reserves capacity for exactly `new_capacity` items.
     /// @note This does **NOT** add to the current capacity — it sets it to `new_capacity` if needed.
+    /// @note Read-only storage (`CU_ARRAY_READONLY`) is always copied out, so the items can be written afterwards.
     /// @param arr Pointer to the array.
     /// @param new_capacity New capacity value.
     /// @return `0` on success, `1` on allocation failure.
     CU_API int cu_array_reserve(cu_array_t *arr, size_t new_capacity);
 
+    /// @brief Sets the runtime growth policy of the array.
+    /// @note The policy is not copied, it must outlive the array.
+    /// @param arr Pointer to the array.
+    /// @param growth Pointer to the policy, `NULL` for the compile-time default.
+    /// @return `0` on success, `1` on error (invalid policy).
+    CU_API int cu_array_set_growth(cu_array_t *arr, const cu_array_growth_t *growth);
+
+    /// @brief Reduces the capacity to the length, giving the unused memory back to the allocator.
+    /// @note An empty array frees its storage entirely, the next insertion allocates again.
+    ///       External storage (e.g. `CU_SARRAY`) and file mappings are left as they are.
+    /// @param arr Pointer to the array.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_shrink_to_fit(cu_array_t *arr);
+
     /// @brief Removes the item at position `pos`.
     /// @param arr Pointer to the array.
     /// @param pos Index of the item to remove.
     /// @return `0` on success, `1` on error.
     CU_API int cu_array_remove_at(cu_array_t *arr, size_t pos);
 
+    /// @brief Removes `num_items` items starting at position `pos`, with one move of the tail.
+    /// @param arr Pointer to the array.
+    /// @param pos Index of the first item to remove.
+    /// @param num_items Number of items to remove.
+    /// @return `0` on success, `1` on error (e.g. the range is out of bounds).
+    CU_API int cu_array_remove_range(cu_array_t *arr, size_t pos, size_t num_items);
+
+    /// @brief Removes the item at position `pos` in `O(1)` by moving the last item into its place.
+    /// @note Doesn't keep the order of the items.
+    /// @param arr Pointer to the array.
+    /// @param pos Index of the item to remove.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_swap_remove(cu_array_t *arr, size_t pos);
+
+    /// @brief Keeps only the items for which `pred` returns non-zero, in a single pass.
+    /// @note Keeps the order of the remaining items, each of them is copied at most once.
+    /// @param arr Pointer to the array.
+    /// @param pred Predicate, called as `pred(item, ctx)` once per item in order.
+    /// @param ctx User context, passed to every `pred` call.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_retain(cu_array_t *arr, int (*pred)(void *, void *), void *ctx);
+
     /// @brief Clears the array (equivalent to setting `arr->length = 0`).
     /// @note Capacity stays the same.
     /// @param arr Pointer to the array.
     /// @return `0` on success, `1` on error.
     CU_API int cu_array_clear(cu_array_t *arr);
 
-    /// @brief Sorts the array in-place using quicksort.
-    /// @warning Not thread-safe: uses a static internal buffer of size `CU_ARRAY_MAX_ITEM_SIZE`.
-    /// @note To make it thread-safe, you can modify the internal sort function to use a user-provided swap buffer.
-    /// @note If your items are larger than 128 bytes, redefine `CU_ARRAY_MAX_ITEM_SIZE` before including this header.
+    /// @brief Moves the items of `src` into `dst` in `O(1)`, without copying them.
+    /// @note `dst` is deinitialized first if it was initialized, it must be zeroed (`= {0}`) otherwise.
+    ///       `src` stays initialized and empty, with the same item size, allocator, growth policy and alignment.
+    /// @note With external storage only the pointer moves, e.g. the inline items of a `CU_SARRAY` must outlive `dst`.
+    /// @param dst Pointer to the destination array.
+    /// @param src Pointer to the source array.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_move(cu_array_t *dst, cu_array_t *src);
+
+    /// @brief Exchanges the contents of two arrays in `O(1)`, without copying the items.
+    /// @note Everything is exchanged: items, allocator, growth policy, flags and alignment (and `stats`).
+    /// @param a Pointer to the first array.
+    /// @param b Pointer to the second array.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_swap(cu_array_t *a, cu_array_t *b);
+
+    /// @brief Hands the storage of the array over to the caller, the array stays initialized and empty.
+    /// @note The caller frees the buffer with `cu_free`, or with `allocator->free(ctx, ptr, item_size * *len)`
+    ///       for arrays with an allocator (their storage is shrunk to the length first).
+    ///       External storage and file mappings are copied to memory from the allocator first.
+    /// @note Fails for arrays from `cu_array_init_aligned`, their storage doesn't start at the allocated block.
+    /// @param arr Pointer to the array.
+    /// @param len Receives the number of items in the buffer, can be `NULL`.
+    /// @return Pointer to the items, `NULL` if the array was empty (`*len` is `0`) or on error.
+    CU_API void *cu_array_detach(cu_array_t *arr, size_t *len);
+
+    /// @brief Sorts the array in-place using introsort.
+    /// @note Quicksort with a median-of-three/ninther pivot, insertion sort for small partitions
+    ///       and heapsort when the recursion gets too deep, so the worst case is `O(n log n)`. Not stable.
+    /// @note Reentrant, there is no shared state. Items of any size can be sorted.
     /// @note For an example compare function, see `cu_compare_int`.
     /// @param arr Pointer to the array.
     /// @param compare Comparator function:
@@ -175,6 +653,179 @@ extern "C"
     /// @return `0` on success, `1` on error.
     CU_API int cu_array_qsort(cu_array_t *arr, int (*compare)(void *, void *));
 
+    /// @brief Same as `cu_array_qsort`, but the comparator receives a user context.
+    /// @note Thread-safe as long as different threads sort different arrays.
+    /// @param arr Pointer to the array.
+    /// @param compare Comparator function, called as `compare(a, b, ctx)`, same return values as for `cu_array_qsort`.
+    /// @param ctx User context, passed to every `compare` call.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_qsort_r(cu_array_t *arr, int (*compare)(void *, void *, void *), void *ctx);
+
+#ifdef CU_ARRAY_THREADS
+    /// @brief Sorts the array in-place using up to `nthreads` threads.
+    /// @note Each partition step hands one side to a new thread until `nthreads` threads are busy,
+    ///       then every thread finishes its part with the sequential introsort.
+    ///       Arrays shorter than `CU_ARRAY_PSORT_THRESHOLD` are sorted on the calling thread.
+    /// @note Only available if `CU_ARRAY_THREADS` is defined. The comparator must be thread-safe.
+    /// @param arr Pointer to the array.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @param nthreads Maximum number of threads, including the calling thread.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_psort(cu_array_t *arr, int (*compare)(void *, void *), size_t nthreads);
+#endif // CU_ARRAY_THREADS
+
+    /// @brief Sorts the array by an integer or floating point key using an LSD radix sort.
+    /// @note Stable, `O(n * key_width)`, and doesn't call a comparator. Bytes of the key that are the same
+    ///       for every item are skipped. Needs one scratch buffer of the same size as the array, from the array's allocator.
+    /// @note Floats are ordered as `-NaN < -inf < ... < -0.0 < 0.0 < ... < inf < NaN`.
+    /// @param arr Pointer to the array.
+    /// @param key_offset Offset of the key inside an item (e.g. `offsetof(struct foo, key)`), `0` for plain arrays of numbers.
+    /// @param key_width Size of the key: `1`, `2`, `4` or `8`. Must be `4` or `8` for `CU_RADIX_FLOAT`.
+    /// @param flags One of `CU_RADIX_UNSIGNED`, `CU_RADIX_SIGNED`, `CU_RADIX_FLOAT`, optionally `| CU_RADIX_DESCENDING`.
+    /// @return `0` on success, `1` on error (invalid key or allocation failure).
+    CU_API int cu_array_radix_sort(cu_array_t *arr, size_t key_offset, size_t key_width, unsigned int flags);
+
+    /// @brief Sorts the array in-place, keeping equal items in their original order.
+    /// @note Natural merge sort (timsort without galloping): existing ascending and strictly descending runs are kept,
+    ///       short ones are extended with binary insertion sort (see `CU_ARRAY_STABLE_SORT_MIN_RUN`), then they are
+    ///       merged in a balanced order. `O(n)` comparisons for sorted or reversed input, `O(n log n)` otherwise.
+    /// @note Needs one scratch buffer of half the size of the array, from the array's allocator (none for sorted input).
+    /// @param arr Pointer to the array.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return `0` on success, `1` on error (e.g. allocation failure).
+    CU_API int cu_array_stable_sort(cu_array_t *arr, int (*compare)(void *, void *));
+
+    /// @brief Same as `cu_array_stable_sort`, but the comparator receives a user context.
+    /// @param arr Pointer to the array.
+    /// @param compare Comparator function, called as `compare(a, b, ctx)`.
+    /// @param ctx User context, passed to every `compare` call.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_stable_sort_r(cu_array_t *arr, int (*compare)(void *, void *, void *), void *ctx);
+
+    /// @brief Merges `k` sorted arrays into `dst` in a single pass.
+    /// @note The output is appended to `dst` after a single reserve of the total size. A loser tree picks
+    ///       every item with `log2(k)` comparisons. Stable: equal items keep the order of `srcs`, then their own order.
+    /// @param dst Pointer to the destination array, not one of `srcs`. Must have the item size of the sources.
+    /// @param srcs Pointers to the `k` source arrays, each sorted with `compare`. They are not modified.
+    /// @param k Number of sources.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return `0` on success, `1` on error (`dst` is unchanged then).
+    CU_API int cu_array_merge_k(cu_array_t *dst, cu_array_t **srcs, size_t k, int (*compare)(void *, void *));
+
+    /// @brief Returns the index of the first item that is not less than `key` in a sorted array.
+    /// @note `O(log n)` comparisons, the loop has no data dependent branches besides the comparator.
+    /// @param arr Pointer to an array sorted with the same comparator.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return Index in `[0, arr->length]`, `arr->length` if every item is less than `key`, `0` on error.
+    CU_API size_t cu_array_lower_bound(cu_array_t *arr, void *key, int (*compare)(void *, void *));
+
+    /// @brief Returns the index of the first item that is greater than `key` in a sorted array.
+    /// @param arr Pointer to an array sorted with the same comparator.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return Index in `[0, arr->length]`, `arr->length` if no item is greater than `key`, `0` on error.
+    CU_API size_t cu_array_upper_bound(cu_array_t *arr, void *key, int (*compare)(void *, void *));
+
+    /// @brief Finds an item equal to `key` in a sorted array.
+    /// @note If there are several equal items, returns the first one.
+    /// @param arr Pointer to an array sorted with the same comparator.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return Pointer to the item, `NULL` if not found or on error.
+    CU_API CU_UNIT *cu_array_bsearch(cu_array_t *arr, void *key, int (*compare)(void *, void *));
+
+    /// @brief Inserts a copy of `item` into a sorted array, keeping it sorted.
+    /// @note The item goes after the items equal to it, so repeated inserts are stable.
+    /// @param arr Pointer to an array sorted with the same comparator.
+    /// @param item Pointer to the item to insert.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_insert_sorted(cu_array_t *arr, void *item, int (*compare)(void *, void *));
+
+    /// @brief Rearranges a sorted array into the Eytzinger (breadth-first) layout for faster lookups.
+    /// @note The item at index `i` has its children at `2i + 1` and `2i + 2`, so the first levels of the
+    ///       search tree share a few cache lines and the next levels can be prefetched.
+    /// @note Needs one scratch buffer of the same size as the array, from the array's allocator.
+    ///       The array is not sorted afterwards, so only use the `cu_array_eytzinger_*` searches on it.
+    /// @param arr Pointer to a sorted array.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_eytzinger_build(cu_array_t *arr);
+
+    /// @brief Returns the index of the smallest item that is not less than `key` in an Eytzinger array.
+    /// @note Branchless descent, prefetching the items four levels below the current one.
+    /// @param arr Pointer to an array built with `cu_array_eytzinger_build`.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, the same as the array was sorted with.
+    /// @return Index of the item, `arr->length` if every item is less than `key` or on error.
+    CU_API size_t cu_array_eytzinger_lower_bound(cu_array_t *arr, void *key, int (*compare)(void *, void *));
+
+    /// @brief Finds an item equal to `key` in an Eytzinger array.
+    /// @param arr Pointer to an array built with `cu_array_eytzinger_build`.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, the same as the array was sorted with.
+    /// @return Pointer to the item, `NULL` if not found or on error.
+    CU_API CU_UNIT *cu_array_eytzinger_search(cu_array_t *arr, void *key, int (*compare)(void *, void *));
+
+    /// @brief Returns a view of all the items of the array.
+    /// @note The view doesn't own the items, any growth of the array can move them and invalidate it.
+    /// @param arr Pointer to the array.
+    /// @return View of the items, an empty view on error.
+    CU_API cu_array_view_t cu_array_view(cu_array_t *arr);
+
+    /// @brief Returns a view of `len` items of the array starting at `pos`, without copying them.
+    /// @param arr Pointer to the array.
+    /// @param pos Index of the first item.
+    /// @param len Number of items.
+    /// @param out Receives the view.
+    /// @return `0` on success, `1` on error (e.g. the range is out of bounds).
+    CU_API int cu_array_slice(cu_array_t *arr, size_t pos, size_t len, cu_array_view_t *out);
+
+    /// @brief Returns a view of `len` items of `view` starting at `pos`.
+    /// @param view The view to slice.
+    /// @param pos Index of the first item.
+    /// @param len Number of items.
+    /// @param out Receives the view.
+    /// @return `0` on success, `1` on error (e.g. the range is out of bounds).
+    CU_API int cu_array_view_slice(cu_array_view_t view, size_t pos, size_t len, cu_array_view_t *out);
+
+    /// @brief Returns a pointer to the item at position `pos` of the view.
+    /// @param view The view.
+    /// @param pos Index of the item.
+    /// @return Pointer to the item, `NULL` if out of bounds.
+    CU_API CU_UNIT *cu_array_view_at(cu_array_view_t view, size_t pos);
+
+    /// @brief Initializes a non-owning array over the items of a view, so every `cu_array_*` function
+    ///        (e.g. the `cu_array_simd_*` kernels) can work on a slice.
+    /// @note Same as `cu_array_init_with_buffer` with the length set: in-place changes (e.g. sorting) write
+    ///       through to the viewed items, the first growth copies them to memory from the allocator.
+    ///       Read-only views (`CU_ARRAY_READONLY` in `view.flags`) are copied out before the first in-place change.
+    /// @param arr Pointer to a zeroed array.
+    /// @param view The view.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_from_view(cu_array_t *arr, cu_array_view_t view);
+
+    /// @brief Sorts the items of a view in-place, same as `cu_array_qsort`.
+    /// @note Writes through the view, use `cu_array_from_view` and `cu_array_qsort` to sort a copy of a read-only view.
+    /// @param view The view.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return `0` on success, `1` on error (e.g. the view is read-only).
+    CU_API int cu_array_view_qsort(cu_array_view_t view, int (*compare)(void *, void *));
+
+    /// @brief Returns the index of the first item that is not less than `key` in a sorted view, same as `cu_array_lower_bound`.
+    /// @param view A view sorted with the same comparator.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return Index in `[0, view.length]`, `0` on error.
+    CU_API size_t cu_array_view_lower_bound(cu_array_view_t view, void *key, int (*compare)(void *, void *));
+
+    /// @brief Finds an item equal to `key` in a sorted view, same as `cu_array_bsearch`.
+    /// @param view A view sorted with the same comparator.
+    /// @param key Pointer to the key, compared as `compare(key, item)`.
+    /// @param compare Comparator function, same as for `cu_array_qsort`.
+    /// @return Pointer to the item, `NULL` if not found or on error.
+    CU_API CU_UNIT *cu_array_view_bsearch(cu_array_view_t view, void *key, int (*compare)(void *, void *));
+
     /// @brief Example comparator for sorting arrays of `int`.
     /// @param a Pointer to the first `int`.
     /// @param b Pointer to the second `int`.
@@ -185,13 +836,323 @@ extern "C"
     CU_API int _cu_array_debug_print(cu_array_t *arr);
 #endif // CU_DEBUG
 
+#ifdef CU_ARRAY_STATS
+    /// @brief Sets the hook called on every counted event of every array, `NULL` to remove it.
+    /// @note Not synchronized, set it before the arrays are used by other threads.
+    /// @param hook Hook function.
+    /// @param ctx Passed to every call of `hook`.
+    CU_API void cu_array_set_stats_hook(cu_array_stats_hook_t hook, void *ctx);
+
+    /// @brief Updates `arr->stats` and calls the hook. Not meant to be called directly.
+    CU_API void __cu_array_stats_event(cu_array_t *arr, unsigned int event, size_t bytes);
+#endif // CU_ARRAY_STATS
+
+    /// @brief Makes room for `additional` more items (growing according to the growth policy) and makes the storage writable.
+    /// @note Not meant to be called directly, it is the slow path of the typed `append`, `insert` and friends.
+    /// @param arr Pointer to the array.
+    /// @param additional Number of items that will be added.
+    /// @return `0` on success, `1` on error.
+    CU_API int __cu_array_prepare(cu_array_t *arr, size_t additional);
+
 #ifdef __cplusplus
 }
 #endif
 
+// Item sizes and offsets are in bytes, whatever the width of `CU_UNIT`, so every `CU_UNIT *` moves through these.
+#define __CU_ARRAY_OFFSET(ptr, bytes) ((CU_UNIT *)(void *)((unsigned char *)(ptr) + (bytes)))
+#define __CU_ARRAY_OFFSET_BACK(ptr, bytes) ((CU_UNIT *)(void *)((unsigned char *)(ptr) - (bytes)))
+#define __CU_ARRAY_DISTANCE(from, to) ((size_t)((const unsigned char *)(to) - (const unsigned char *)(from)))
+
+/// @brief Returns the item under the cursor and moves to the next one.
+/// @param it Cursor from `cu_array_iter`.
+/// @return Pointer to the item, `NULL` once all items were returned.
+static inline CU_UNIT *cu_array_iter_next(cu_array_iter_t *it)
+{
+    if (it->ptr == it->end)
+    {
+        return NULL;
+    }
+    CU_UNIT *item = it->ptr;
+    it->ptr = __CU_ARRAY_OFFSET(it->ptr, it->stride);
+    return item;
+}
+
+/// @brief Loops over the items of `arr` as `T *it`, checking the array once instead of every item.
+/// ```C
+/// CU_ARRAY_FOREACH(int, x, &arr)
+/// {
+///     sum += *x;
+/// }
+/// ```
+/// @note `sizeof(T)` must be the `item_size` of the array, `arr` is evaluated twice.
+/// @param T Item type.
+/// @param it Name of the loop variable.
+/// @param arr Pointer to the array (`cu_array_t *`).
+#define CU_ARRAY_FOREACH(T, it, arr) \
+    for (T *it = (T *)cu_array_begin(arr), *__cu_end_##it = (T *)cu_array_end(arr); it != __cu_end_##it; it++)
+
+#ifdef CU_ARRAY_STATS
+#define __CU_ARRAY_STATS_EVENT(arr, event, bytes) __cu_array_stats_event((arr), (event), (bytes))
+#define __CU_ARRAY_STATS_LENGTH(arr)                                                                        \
+    ((arr)->stats.peak_length < (arr)->length ? (void)((arr)->stats.peak_length = (arr)->length) : (void)0)
+#else
+#define __CU_ARRAY_STATS_EVENT(arr, event, bytes) ((void)0)
+#define __CU_ARRAY_STATS_LENGTH(arr) ((void)0)
+#endif // CU_ARRAY_STATS
+
+// Small arrays
+
+/// @brief Declares an array with inline storage for the first `N` items of type `T`.
+/// ```C
+/// typedef CU_SARRAY(int, 8) small_ints_t;
+/// ...
+/// small_ints_t s;
+/// CU_SARRAY_INIT(&s);
+/// int x = 42;
+/// cu_array_append(&s.base, &x); // no allocation until the 9th item
+/// cu_array_deinit(&s.base);
+/// ```
+/// All `cu_array_*` functions work on `.base`, the items move to the heap once it outgrows `N`.
+/// @warning Don't copy or move the struct while the items are inline, `.base.data` points into it.
+/// @param T Item type.
+/// @param N Number of inline items.
+#define CU_SARRAY(T, N)    \
+    struct                 \
+    {                      \
+        cu_array_t base;   \
+        T storage[N];      \
+    }
+
+/// @brief Initializes a `CU_SARRAY` to use its inline storage.
+/// @param sarr Pointer to the small array.
+/// @return `0` on success, `1` on error.
+#define CU_SARRAY_INIT(sarr)                                                                \
+    ((sarr)->base = (cu_array_t){0},                                                        \
+     cu_array_init_with_buffer(&(sarr)->base, sizeof((sarr)->storage[0]), (sarr)->storage, \
+                               sizeof((sarr)->storage) / sizeof((sarr)->storage[0])))
+
+// Typed arrays
+
+/// @brief Generates a typed dynamic array `cu_array_T_t` on top of `cu_array_t`.
+/// ```C
+/// CU_ARRAY_DEFINE(int)
+/// ...
+/// cu_array_int_t arr = {0};
+/// cu_array_int_init(&arr);
+/// cu_array_int_append(&arr, 42);
+/// int x = *cu_array_int_at(&arr, 0);
+/// cu_array_int_deinit(&arr);
+/// ```
+/// The item size is `sizeof(T)`, so the hot functions (`at`, `append`, `extend`, `insert`, `remove_at`)
+/// are `static inline` and copy items by assignment instead of `cu_memcpy`.
+/// The underlying `cu_array_t` is available as `arr.base`, so the generic functions (e.g. `cu_array_qsort()`) still work.
+/// @note `T` must be a single identifier, use a `typedef` for types like `unsigned int` or `struct foo`.
+/// @note The typed functions don't check if `arr` is `NULL`, it must point to an array initialized with `cu_array_T_init()`.
+/// @param T Item type.
+#define CU_ARRAY_DEFINE(T)                                                                  \
+    typedef struct cu_array_##T##_s                                                         \
+    {                                                                                       \
+        cu_array_t base;                                                                    \
+    } cu_array_##T##_t;                                                                     \
+                                                                                            \
+    static inline int cu_array_##T##_init(cu_array_##T##_t *arr)                            \
+    {                                                                                       \
+        return cu_array_init(&arr->base, sizeof(T));                                        \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_deinit(cu_array_##T##_t *arr)                          \
+    {                                                                                       \
+        return cu_array_deinit(&arr->base);                                                 \
+    }                                                                                       \
+                                                                                            \
+    static inline T *cu_array_##T##_data(cu_array_##T##_t *arr)                             \
+    {                                                                                       \
+        return (T *)arr->base.data;                                                         \
+    }                                                                                       \
+                                                                                            \
+    static inline T *cu_array_##T##_at(cu_array_##T##_t *arr, size_t pos)                   \
+    {                                                                                       \
+        if (pos >= arr->base.length)                                                        \
+        {                                                                                   \
+            return NULL;                                                                    \
+        }                                                                                   \
+        return (T *)arr->base.data + pos;                                                   \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_reserve(cu_array_##T##_t *arr, size_t new_capacity)    \
+    {                                                                                       \
+        return cu_array_reserve(&arr->base, new_capacity);                                  \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_append(cu_array_##T##_t *arr, T item)                  \
+    {                                                                                       \
+        if ((arr->base.length >= arr->base.capacity || (arr->base.flags & CU_ARRAY_READONLY)) && \
+            __cu_array_prepare(&arr->base, 1) != 0)                                         \
+        {                                                                                   \
+            return 1;                                                                       \
+        }                                                                                   \
+        ((T *)arr->base.data)[arr->base.length] = item;                                     \
+        arr->base.length += 1;                                                              \
+        __CU_ARRAY_STATS_LENGTH(&arr->base);                                                \
+        return 0;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_extend(cu_array_##T##_t *arr, const T *items,          \
+                                            size_t num_items)                               \
+    {                                                                                       \
+        if (items == NULL || __cu_array_prepare(&arr->base, num_items) != 0)                \
+        {                                                                                   \
+            return 1;                                                                       \
+        }                                                                                   \
+        T *dst = (T *)arr->base.data + arr->base.length;                                    \
+        for (size_t i = 0; i < num_items; i++)                                              \
+        {                                                                                   \
+            dst[i] = items[i];                                                              \
+        }                                                                                   \
+        arr->base.length += num_items;                                                      \
+        __CU_ARRAY_STATS_LENGTH(&arr->base);                                                \
+        return 0;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_insert(cu_array_##T##_t *arr, T item, size_t pos)      \
+    {                                                                                       \
+        if (pos > arr->base.length)                                                         \
+        {                                                                                   \
+            return 1;                                                                       \
+        }                                                                                   \
+        if ((arr->base.length >= arr->base.capacity || (arr->base.flags & CU_ARRAY_READONLY)) && \
+            __cu_array_prepare(&arr->base, 1) != 0)                                         \
+        {                                                                                   \
+            return 1;                                                                       \
+        }                                                                                   \
+        T *data = (T *)arr->base.data;                                                      \
+        for (size_t i = arr->base.length; i > pos; i--)                                     \
+        {                                                                                   \
+            data[i] = data[i - 1];                                                          \
+        }                                                                                   \
+        data[pos] = item;                                                                   \
+        arr->base.length += 1;                                                              \
+        __CU_ARRAY_STATS_LENGTH(&arr->base);                                                \
+        if (pos + 1u != arr->base.length)                                                   \
+        {                                                                                   \
+            __CU_ARRAY_STATS_EVENT(&arr->base, CU_ARRAY_STATS_MOVE,                         \
+                                   sizeof(T) * (arr->base.length - 1u - pos));              \
+        }                                                                                   \
+        return 0;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_remove_at(cu_array_##T##_t *arr, size_t pos)           \
+    {                                                                                       \
+        if (pos >= arr->base.length ||                                                      \
+            ((arr->base.flags & CU_ARRAY_READONLY) && __cu_array_prepare(&arr->base, 0) != 0)) \
+        {                                                                                   \
+            return 1;                                                                       \
+        }                                                                                   \
+        T *data = (T *)arr->base.data;                                                      \
+        for (size_t i = pos + 1; i < arr->base.length; i++)                                 \
+        {                                                                                   \
+            data[i - 1] = data[i];                                                          \
+        }                                                                                   \
+        arr->base.length -= 1;                                                              \
+        if (pos != arr->base.length)                                                        \
+        {                                                                                   \
+            __CU_ARRAY_STATS_EVENT(&arr->base, CU_ARRAY_STATS_MOVE,                         \
+                                   sizeof(T) * (arr->base.length - pos));                   \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+/// @brief Generates branchless binary searches for a typed array whose items are ordered by `<`.
+/// ```C
+/// CU_ARRAY_DEFINE(int)
+/// CU_ARRAY_DEFINE_ORDERED(int)
+/// ...
+/// cu_array_int_insert_sorted(&arr, 42);
+/// size_t pos = cu_array_int_lower_bound(&arr, 42);
+/// ```
+/// The comparison is inlined and the search loop compiles to conditional moves, the number
+/// of iterations only depends on the length, so there are no mispredicted branches.
+/// @note Must come after `CU_ARRAY_DEFINE(T)`. `T` must be a number or pointer type (e.g. no NaN for floats).
+/// @param T Item type.
+#define CU_ARRAY_DEFINE_ORDERED(T)                                                          \
+    static inline size_t cu_array_##T##_lower_bound(cu_array_##T##_t *arr, T key)           \
+    {                                                                                       \
+        const T *base = (const T *)arr->base.data;                                          \
+        size_t len = arr->base.length;                                                      \
+        if (len == 0u)                                                                      \
+        {                                                                                   \
+            return 0;                                                                       \
+        }                                                                                   \
+        const T *first = base;                                                              \
+        while (len > 1u)                                                                    \
+        {                                                                                   \
+            size_t half = len / 2u;                                                         \
+            base = (base[half - 1u] < key) ? base + half : base;                            \
+            len -= half;                                                                    \
+        }                                                                                   \
+        return (size_t)(base - first) + (size_t)(*base < key);                              \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t cu_array_##T##_upper_bound(cu_array_##T##_t *arr, T key)           \
+    {                                                                                       \
+        const T *base = (const T *)arr->base.data;                                          \
+        size_t len = arr->base.length;                                                      \
+        if (len == 0u)                                                                      \
+        {                                                                                   \
+            return 0;                                                                       \
+        }                                                                                   \
+        const T *first = base;                                                              \
+        while (len > 1u)                                                                    \
+        {                                                                                   \
+            size_t half = len / 2u;                                                         \
+            base = (key < base[half - 1u]) ? base : base + half;                            \
+            len -= half;                                                                    \
+        }                                                                                   \
+        return (size_t)(base - first) + (size_t)!(key < *base);                             \
+    }                                                                                       \
+                                                                                            \
+    static inline T *cu_array_##T##_bsearch(cu_array_##T##_t *arr, T key)                   \
+    {                                                                                       \
+        size_t pos = cu_array_##T##_lower_bound(arr, key);                                  \
+        T *data = (T *)arr->base.data;                                                      \
+        if (pos == arr->base.length || key < data[pos])                                     \
+        {                                                                                   \
+            return NULL;                                                                    \
+        }                                                                                   \
+        return data + pos;                                                                  \
+    }                                                                                       \
+                                                                                            \
+    static inline int cu_array_##T##_insert_sorted(cu_array_##T##_t *arr, T item)           \
+    {                                                                                       \
+        return cu_array_##T##_insert(arr, item, cu_array_##T##_upper_bound(arr, item));     \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t cu_array_##T##_eytzinger_lower_bound(cu_array_##T##_t *arr, T key) \
+    {                                                                                       \
+        const T *data = (const T *)arr->base.data;                                          \
+        size_t len = arr->base.length;                                                      \
+        size_t k = 1;                                                                       \
+        while (k <= len)                                                                    \
+        {                                                                                   \
+            if (16u * k <= len)                                                             \
+            {                                                                               \
+                CU_ARRAY_PREFETCH(data + 16u * k - 1u);                                     \
+            }                                                                               \
+            k = 2u * k + (size_t)(data[k - 1u] < key);                                      \
+        }                                                                                   \
+        while (k & 1u)                                                                      \
+        {                                                                                   \
+            k >>= 1;                                                                        \
+        }                                                                                   \
+        k >>= 1;                                                                            \
+        return k == 0u ? len : k - 1u;                                                      \
+    }
+
 #endif // CU_ARRAY_H
 
-#ifdef CU_ARRAY_IMPL
+// Other headers (e.g. `cu_array_simd.h`) include this one, the definitions must only be emitted once.
+#if defined(CU_ARRAY_IMPL) && !defined(CU_ARRAY_IMPL_INCLUDED)
+#define CU_ARRAY_IMPL_INCLUDED
 
 #ifndef cu_malloc
 #define cu_malloc malloc
@@ -211,9 +1172,27 @@ extern "C"
 #ifndef CU_ARRAY_DEFAULT_SIZE
 #define CU_ARRAY_DEFAULT_SIZE (32u)
 #endif // CU_ARRAY_DEFAULT_SIZE
-#ifndef CU_ARRAY_MAX_ITEM_SIZE
-#define CU_ARRAY_MAX_ITEM_SIZE (128u)
-#endif // CU_ARRAY_MAX_ITEM_SIZE
+#ifndef CU_ARRAY_SWAP_CHUNK_SIZE
+#define CU_ARRAY_SWAP_CHUNK_SIZE (64u)
+#endif // CU_ARRAY_SWAP_CHUNK_SIZE
+#ifndef CU_ARRAY_SORT_INSERTION_THRESHOLD
+#define CU_ARRAY_SORT_INSERTION_THRESHOLD (16u)
+#endif // CU_ARRAY_SORT_INSERTION_THRESHOLD
+#ifndef CU_ARRAY_SORT_NINTHER_THRESHOLD
+#define CU_ARRAY_SORT_NINTHER_THRESHOLD (128u)
+#endif // CU_ARRAY_SORT_NINTHER_THRESHOLD
+#ifndef CU_ARRAY_STABLE_SORT_MIN_RUN
+#define CU_ARRAY_STABLE_SORT_MIN_RUN (32u)
+#endif // CU_ARRAY_STABLE_SORT_MIN_RUN
+#ifndef CU_ARRAY_PSORT_THRESHOLD
+#define CU_ARRAY_PSORT_THRESHOLD (65536u)
+#endif // CU_ARRAY_PSORT_THRESHOLD
+#ifndef CU_ARRAY_IO_BATCH_SIZE
+#define CU_ARRAY_IO_BATCH_SIZE ((size_t)1u << 30)
+#endif // CU_ARRAY_IO_BATCH_SIZE
+#ifndef CU_ARRAY_HUGE_PAGE_SIZE
+#define CU_ARRAY_HUGE_PAGE_SIZE (2u * 1024u * 1024u)
+#endif // CU_ARRAY_HUGE_PAGE_SIZE
 
 // Definitions
 
@@ -253,246 +1232,2394 @@ CU_API size_t __next_power_of_two(size_t v)
 }
 #endif
 
-CU_API void __cu_array_qsort_internal(CU_UNIT *data, size_t item_size, size_t len, int (*compare)(void *, void *))
+// Copies of a constant number of bytes, which compilers turn into plain word loads and stores
+// (a single 16-byte move with SSE), also without libc.
+#if defined(__GNUC__) || defined(__clang__)
+#define __CU_ARRAY_COPY_FIXED(dst, src, n) __builtin_memcpy((dst), (src), (n))
+#else
+#define __CU_ARRAY_COPY_FIXED(dst, src, n) cu_memcpy((dst), (src), (n))
+#endif // defined(__GNUC__) || defined(__clang__)
+
+#define __CU_ARRAY_SWAP_FIXED(a, b, n)        \
+    do                                        \
+    {                                         \
+        unsigned char __tmp[n];               \
+        __CU_ARRAY_COPY_FIXED(__tmp, (a), n); \
+        __CU_ARRAY_COPY_FIXED((a), (b), n);   \
+        __CU_ARRAY_COPY_FIXED((b), __tmp, n); \
+    } while (0)
+
+/// Copies a single item, 4, 8 and 16-byte items (the common word sized ones) without a `cu_memcpy` call.
+/// Only for items inside array storage or scratch buffers, items from the caller (which may be smaller
+/// than any of the fixed sizes as far as the compiler knows) go through `cu_memcpy`.
+CU_API void __cu_array_copy_item(void *dst, const void *src, size_t item_size)
 {
-    static CU_UNIT swap_buffer[CU_ARRAY_MAX_ITEM_SIZE];
-    if (len < 2u)
+    switch (item_size)
     {
-        return;
+    case 4u:
+        __CU_ARRAY_COPY_FIXED(dst, src, 4u);
+        break;
+    case 8u:
+        __CU_ARRAY_COPY_FIXED(dst, src, 8u);
+        break;
+    case 16u:
+        __CU_ARRAY_COPY_FIXED(dst, src, 16u);
+        break;
+    default:
+        cu_memcpy(dst, src, item_size);
+        break;
     }
-    void *pivot = (void *)(data + item_size * (size_t)(len / 2));
+}
 
-    size_t i, j;
-    for (i = 0, j = len - 1;; i++, j--)
+CU_API void __cu_array_swap(CU_UNIT *a, CU_UNIT *b, size_t item_size)
+{
+    switch (item_size)
     {
+    case 4u:
+        __CU_ARRAY_SWAP_FIXED(a, b, 4u);
+        return;
+    case 8u:
+        __CU_ARRAY_SWAP_FIXED(a, b, 8u);
+        return;
+    case 16u:
+        __CU_ARRAY_SWAP_FIXED(a, b, 16u);
+        return;
+    default:
+        break;
+    }
 
-        while (compare(data + item_size * i, pivot) < 0)
-        {
-            i++;
-        }
-        while (compare(pivot, data + item_size * j) < 0)
-        {
-            j--;
-        }
-        if (i >= j)
+    // Word-at-a-time if both items and the item size are word aligned.
+    if ((((size_t)(void *)a | (size_t)(void *)b | item_size) % sizeof(size_t)) == 0u)
+    {
+        size_t *wa = (size_t *)(void *)a;
+        size_t *wb = (size_t *)(void *)b;
+        for (size_t i = 0; i < item_size / sizeof(size_t); i++)
         {
-            break;
+            size_t tmp = wa[i];
+            wa[i] = wb[i];
+            wb[i] = tmp;
         }
-        cu_memcpy(swap_buffer, data + item_size * i, item_size);
-        cu_memcpy(data + item_size * i, data + item_size * j, item_size);
-        cu_memcpy(data + item_size * j, swap_buffer, item_size);
+        return;
     }
 
-    __cu_array_qsort_internal(data, item_size, i, compare);
-    __cu_array_qsort_internal(data + item_size * i, item_size, len - i, compare);
+    // Otherwise in chunks through a small stack buffer, so there is no limit on the item size.
+    unsigned char chunk[CU_ARRAY_SWAP_CHUNK_SIZE];
+    while (item_size > 0u)
+    {
+        size_t n = item_size < CU_ARRAY_SWAP_CHUNK_SIZE ? item_size : CU_ARRAY_SWAP_CHUNK_SIZE;
+        cu_memcpy(chunk, a, n);
+        cu_memcpy(a, b, n);
+        cu_memcpy(b, chunk, n);
+        a = __CU_ARRAY_OFFSET(a, n);
+        b = __CU_ARRAY_OFFSET(b, n);
+        item_size -= n;
+    }
 }
 
-CU_API int _cu_array_debug_print(cu_array_t *arr)
+CU_API void __cu_array_insertion_sort(CU_UNIT *data, size_t item_size, size_t len, int (*compare)(void *, void *, void *), void *ctx)
 {
-    if (arr == NULL)
+    for (size_t i = 1; i < len; i++)
     {
-        return 1;
+        for (size_t j = i; j > 0 && compare(__CU_ARRAY_OFFSET(data, item_size * (j - 1)), __CU_ARRAY_OFFSET(data, item_size * j), ctx) > 0; j--)
+        {
+            __cu_array_swap(__CU_ARRAY_OFFSET(data, item_size * (j - 1)), __CU_ARRAY_OFFSET(data, item_size * j), item_size);
+        }
     }
-    printf("{\n"
-           "\tdata:      %p\n"
-           "\titem_size: %zu\n"
-           "\tlength:    %zu\n"
-           "\tcapacity:  %zu\n"
-           "}\n",
-           arr->data, arr->item_size, arr->length, arr->capacity);
-    return 0;
 }
 
-// "Public" function definitions
-
-CU_API int __cu_array_grow(cu_array_t *arr)
+CU_API void __cu_array_sift_down(CU_UNIT *data, size_t item_size, size_t root, size_t len, int (*compare)(void *, void *, void *), void *ctx)
 {
-    if (arr == NULL || arr->data == NULL || arr->capacity == 0u)
+    for (;;)
     {
-        return 1;
+        size_t child = 2u * root + 1u;
+        if (child >= len)
+        {
+            return;
+        }
+        if (child + 1u < len && compare(__CU_ARRAY_OFFSET(data, item_size * child), __CU_ARRAY_OFFSET(data, item_size * (child + 1u)), ctx) < 0)
+        {
+            child++;
+        }
+        if (compare(__CU_ARRAY_OFFSET(data, item_size * root), __CU_ARRAY_OFFSET(data, item_size * child), ctx) >= 0)
+        {
+            return;
+        }
+        __cu_array_swap(__CU_ARRAY_OFFSET(data, item_size * root), __CU_ARRAY_OFFSET(data, item_size * child), item_size);
+        root = child;
     }
+}
 
-#ifdef CU_GROWTH_RATE_SPEED
-    size_t new_capacity = __next_power_of_two(arr->capacity);
-    if (new_capacity == arr->capacity)
+CU_API void __cu_array_heapsort(CU_UNIT *data, size_t item_size, size_t len, int (*compare)(void *, void *, void *), void *ctx)
+{
+    if (len < 2u)
     {
-        new_capacity = __next_power_of_two(arr->capacity + 1);
+        return;
     }
-#endif
-#ifdef CU_GROWTH_RATE_SPACE
-    size_t new_capacity = arr->capacity * 2u;
-#endif
-    if (new_capacity <= arr->length)
+    for (size_t i = len / 2u; i > 0; i--)
     {
-        return 1;
+        __cu_array_sift_down(data, item_size, i - 1u, len, compare, ctx);
     }
-
-    CU_UNIT *tmp = (CU_UNIT *)cu_realloc(arr->data, arr->item_size * new_capacity);
-    if (tmp == NULL)
+    for (size_t end = len - 1u; end > 0; end--)
     {
-        return 1;
+        __cu_array_swap(data, __CU_ARRAY_OFFSET(data, item_size * end), item_size);
+        __cu_array_sift_down(data, item_size, 0, end, compare, ctx);
     }
-
-    arr->data = tmp;
-    arr->capacity = new_capacity;
-    return 0;
 }
 
-CU_API int cu_array_init(cu_array_t *arr, size_t item_size)
+/// Returns the index of the median of the items at `a`, `b` and `c`.
+CU_API size_t __cu_array_median_of_three(CU_UNIT *data, size_t item_size, size_t a, size_t b, size_t c,
+                                         int (*compare)(void *, void *, void *), void *ctx)
 {
-    if (arr == NULL || arr->data != NULL || arr->capacity != 0u)
+    int ab = compare(__CU_ARRAY_OFFSET(data, item_size * a), __CU_ARRAY_OFFSET(data, item_size * b), ctx) < 0;
+    int bc = compare(__CU_ARRAY_OFFSET(data, item_size * b), __CU_ARRAY_OFFSET(data, item_size * c), ctx) < 0;
+    if (ab == bc)
     {
-        return 1;
+        return b;
     }
+    int ac = compare(__CU_ARRAY_OFFSET(data, item_size * a), __CU_ARRAY_OFFSET(data, item_size * c), ctx) < 0;
+    return (ab == ac) ? c : a;
+}
 
-    *arr = (cu_array_t){0};
-    arr->item_size = item_size;
-    arr->data = (CU_UNIT *)cu_malloc(arr->item_size * CU_ARRAY_DEFAULT_SIZE);
-    if (arr->data == NULL)
+/// Partitions `data` around a median-of-three (ninther for large inputs) pivot.
+/// Returns the final index of the pivot: items before it are `<=`, items after it are `>=`.
+/// `len` must be at least 3.
+CU_API size_t __cu_array_partition(CU_UNIT *data, size_t item_size, size_t len, int (*compare)(void *, void *, void *), void *ctx)
+{
+    size_t mid = len / 2u;
+    size_t pivot_index;
+    if (len >= CU_ARRAY_SORT_NINTHER_THRESHOLD)
     {
-        return 1;
+        size_t step = len / 8u;
+        size_t lo = __cu_array_median_of_three(data, item_size, 0, step, 2u * step, compare, ctx);
+        size_t md = __cu_array_median_of_three(data, item_size, mid - step, mid, mid + step, compare, ctx);
+        size_t hi = __cu_array_median_of_three(data, item_size, len - 1u - 2u * step, len - 1u - step, len - 1u, compare, ctx);
+        pivot_index = __cu_array_median_of_three(data, item_size, lo, md, hi, compare, ctx);
+    }
+    else
+    {
+        pivot_index = __cu_array_median_of_three(data, item_size, 0, mid, len - 1u, compare, ctx);
     }
 
-    arr->capacity = CU_ARRAY_DEFAULT_SIZE;
-    return 0;
-}
+    // Keep the pivot at the front, so it doesn't move while partitioning.
+    __cu_array_swap(data, __CU_ARRAY_OFFSET(data, item_size * pivot_index), item_size);
+    CU_UNIT *pivot = data;
 
-CU_API int cu_array_deinit(cu_array_t *arr)
-{
-    if (arr == NULL || arr->data == NULL || arr->capacity == 0u)
+    // Stopping on equal items keeps the partitions balanced when there are many duplicates.
+    // The bounds checks keep us inside the array even with an inconsistent comparator.
+    size_t i = 0, j = len;
+    for (;;)
     {
-        return 1;
+        do
+        {
+            i++;
+        } while (i < len && compare(__CU_ARRAY_OFFSET(data, item_size * i), pivot, ctx) < 0);
+        do
+        {
+            j--;
+        } while (j > 0 && compare(pivot, __CU_ARRAY_OFFSET(data, item_size * j), ctx) < 0);
+        if (i >= j)
+        {
+            break;
+        }
+        __cu_array_swap(__CU_ARRAY_OFFSET(data, item_size * i), __CU_ARRAY_OFFSET(data, item_size * j), item_size);
     }
 
-    cu_free(arr->data);
-    *arr = (cu_array_t){0};
-    return 0;
+    __cu_array_swap(data, __CU_ARRAY_OFFSET(data, item_size * j), item_size);
+    return j;
 }
 
-CU_API CU_UNIT *cu_array_at(cu_array_t *arr, size_t pos)
+/// Returns `2 * floor(log2(len))`, the recursion depth after which introsort switches to heapsort.
+CU_API size_t __cu_array_sort_depth_limit(size_t len)
 {
-    if (arr == NULL || arr->data == NULL ||
-        arr->capacity == 0u || pos >= arr->length)
+    size_t depth_limit = 0;
+    for (size_t n = len; n > 1u; n >>= 1)
     {
-        return NULL;
+        depth_limit += 2u;
     }
-
-    return (arr->data + arr->item_size * pos);
+    return depth_limit;
 }
 
-CU_API int cu_array_append(cu_array_t *arr, void *item)
+CU_API void __cu_array_introsort(CU_UNIT *data, size_t item_size, size_t len, size_t depth_limit,
+                                 int (*compare)(void *, void *, void *), void *ctx)
 {
-    if (item == NULL || arr == NULL || arr->data == NULL || arr->capacity == 0u)
-    {
-        return 1;
-    }
-    if (arr->length >= arr->capacity)
+    while (len > CU_ARRAY_SORT_INSERTION_THRESHOLD)
     {
-        int res = __cu_array_grow(arr);
-        if (res != 0)
+        if (depth_limit == 0u)
         {
-            return res;
+            __cu_array_heapsort(data, item_size, len, compare, ctx);
+            return;
         }
-    }
-    cu_memcpy(((arr->data) + (arr->item_size * arr->length)), item, arr->item_size);
-    arr->length += 1;
-    return 0;
-}
+        depth_limit--;
 
-CU_API int cu_array_extend(cu_array_t *arr, void *items, size_t num_items)
-{
-    if (items == NULL || arr == NULL || arr->data == NULL || arr->capacity == 0u)
+        size_t p = __cu_array_partition(data, item_size, len, compare, ctx);
+        size_t left = p;
+        size_t right = len - p - 1u;
+
+        // Recurse into the smaller side and loop on the larger one, so the stack depth stays O(log n).
+        if (left < right)
+        {
+            __cu_array_introsort(data, item_size, left, depth_limit, compare, ctx);
+            data = __CU_ARRAY_OFFSET(data, item_size * (p + 1u));
+            len = right;
+        }
+        else
+        {
+            __cu_array_introsort(__CU_ARRAY_OFFSET(data, item_size * (p + 1u)), item_size, right, depth_limit, compare, ctx);
+            len = left;
+        }
+    }
+    __cu_array_insertion_sort(data, item_size, len, compare, ctx);
+}
+
+/// Adapts a context-free comparator to the engine, which always passes a context.
+typedef struct __cu_array_compare_wrapper_s
+{
+    int (*compare)(void *, void *);
+} __cu_array_compare_wrapper_t;
+
+CU_API int __cu_array_compare_wrapped(void *a, void *b, void *ctx)
+{
+    return ((__cu_array_compare_wrapper_t *)ctx)->compare(a, b);
+}
+
+CU_API void __cu_array_qsort_internal(CU_UNIT *data, size_t item_size, size_t len, int (*compare)(void *, void *, void *), void *ctx)
+{
+    if (len < 2u)
+    {
+        return;
+    }
+    __cu_array_introsort(data, item_size, len, __cu_array_sort_depth_limit(len), compare, ctx);
+}
+
+// Stable sort
+
+/// Pending runs of the merge sort, the lengths shrink at least as fast as the Fibonacci numbers
+/// from the bottom to the top, so 96 entries are enough for any `size_t` length.
+typedef struct __cu_array_merge_state_s
+{
+    CU_UNIT *data;
+    size_t item_size;
+    /// Room for half of the items, also used as the temporary of the insertion sort.
+    CU_UNIT *scratch;
+    int (*compare)(void *, void *, void *);
+    void *ctx;
+    size_t run_start[96];
+    size_t run_length[96];
+    size_t height;
+} __cu_array_merge_state_t;
+
+/// Minimum run length, between `CU_ARRAY_STABLE_SORT_MIN_RUN` and twice that, picked so that
+/// `len / min_run` is a power of two or slightly less and the merges stay balanced.
+CU_API size_t __cu_array_min_run(size_t len)
+{
+    size_t r = 0;
+    while (len >= 2u * CU_ARRAY_STABLE_SORT_MIN_RUN)
+    {
+        r |= len & 1u;
+        len >>= 1u;
+    }
+    return len + r;
+}
+
+/// Returns the length of the run at the start of `data`, reversing it if it is strictly descending.
+CU_API size_t __cu_array_count_run(CU_UNIT *data, size_t item_size, size_t len, int (*compare)(void *, void *, void *), void *ctx)
+{
+    if (len < 2u)
+    {
+        return len;
+    }
+    size_t n = 2;
+    if (compare(__CU_ARRAY_OFFSET(data, item_size), data, ctx) < 0)
+    {
+        while (n < len && compare(__CU_ARRAY_OFFSET(data, item_size * n), __CU_ARRAY_OFFSET(data, item_size * (n - 1u)), ctx) < 0)
+        {
+            n++;
+        }
+        // Strictly descending, so reversing it doesn't reorder equal items.
+        for (size_t i = 0, j = n - 1u; i < j; i++, j--)
+        {
+            __cu_array_swap(__CU_ARRAY_OFFSET(data, item_size * i), __CU_ARRAY_OFFSET(data, item_size * j), item_size);
+        }
+    }
+    else
+    {
+        while (n < len && compare(__CU_ARRAY_OFFSET(data, item_size * n), __CU_ARRAY_OFFSET(data, item_size * (n - 1u)), ctx) >= 0)
+        {
+            n++;
+        }
+    }
+    return n;
+}
+
+/// Inserts the items `[sorted, len)` into the sorted prefix, after the items equal to them.
+CU_API void __cu_array_binary_insertion_sort(CU_UNIT *data, size_t item_size, size_t sorted, size_t len, CU_UNIT *tmp,
+                                             int (*compare)(void *, void *, void *), void *ctx)
+{
+    for (size_t i = sorted; i < len; i++)
+    {
+        CU_UNIT *item = __CU_ARRAY_OFFSET(data, item_size * i);
+        size_t lo = 0;
+        size_t hi = i;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2u;
+            if (compare(item, __CU_ARRAY_OFFSET(data, item_size * mid), ctx) < 0)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1u;
+            }
+        }
+        if (lo == i)
+        {
+            continue;
+        }
+        __cu_array_copy_item(tmp, item, item_size);
+        cu_memmove(__CU_ARRAY_OFFSET(data, item_size * (lo + 1u)), __CU_ARRAY_OFFSET(data, item_size * lo), item_size * (i - lo));
+        __cu_array_copy_item(__CU_ARRAY_OFFSET(data, item_size * lo), tmp, item_size);
+    }
+}
+
+/// Merges the adjacent sorted runs `[data, data + la)` and `[data + la, data + la + lb)` (in items),
+/// copying the shorter one to the scratch buffer.
+CU_API void __cu_array_merge_runs(__cu_array_merge_state_t *s, CU_UNIT *data, size_t la, size_t lb)
+{
+    size_t item_size = s->item_size;
+    CU_UNIT *b = __CU_ARRAY_OFFSET(data, item_size * la);
+    if (s->compare(__CU_ARRAY_OFFSET_BACK(b, item_size), b, s->ctx) <= 0)
+    {
+        return;
+    }
+
+    // The left items not greater than the first right item, and the right items not less than
+    // the last left item, are already in place.
+    size_t lo = 0;
+    size_t hi = la;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (s->compare(b, __CU_ARRAY_OFFSET(data, item_size * mid), s->ctx) < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1u;
+        }
+    }
+    data = __CU_ARRAY_OFFSET(data, item_size * lo);
+    la -= lo;
+    CU_UNIT *last = __CU_ARRAY_OFFSET_BACK(b, item_size);
+    lo = 0;
+    hi = lb;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (s->compare(__CU_ARRAY_OFFSET(b, item_size * mid), last, s->ctx) < 0)
+        {
+            lo = mid + 1u;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    lb = lo;
+
+    if (la <= lb)
+    {
+        // Forward, from a copy of the left run. On ties the left item goes first.
+        cu_memcpy(s->scratch, data, item_size * la);
+        CU_UNIT *pa = s->scratch;
+        CU_UNIT *ea = __CU_ARRAY_OFFSET(s->scratch, item_size * la);
+        CU_UNIT *pb = b;
+        CU_UNIT *eb = __CU_ARRAY_OFFSET(b, item_size * lb);
+        CU_UNIT *out = data;
+        while (pa < ea && pb < eb)
+        {
+            if (s->compare(pb, pa, s->ctx) < 0)
+            {
+                __cu_array_copy_item(out, pb, item_size);
+                pb = __CU_ARRAY_OFFSET(pb, item_size);
+            }
+            else
+            {
+                __cu_array_copy_item(out, pa, item_size);
+                pa = __CU_ARRAY_OFFSET(pa, item_size);
+            }
+            out = __CU_ARRAY_OFFSET(out, item_size);
+        }
+        cu_memcpy(out, pa, __CU_ARRAY_DISTANCE(pa, ea));
+    }
+    else
+    {
+        // Backward, from a copy of the right run. On ties the right item goes last.
+        cu_memcpy(s->scratch, b, item_size * lb);
+        CU_UNIT *pa = b;
+        CU_UNIT *pb = __CU_ARRAY_OFFSET(s->scratch, item_size * lb);
+        CU_UNIT *out = __CU_ARRAY_OFFSET(b, item_size * lb);
+        while (pa > data && pb > s->scratch)
+        {
+            out = __CU_ARRAY_OFFSET_BACK(out, item_size);
+            if (s->compare(__CU_ARRAY_OFFSET_BACK(pb, item_size), __CU_ARRAY_OFFSET_BACK(pa, item_size), s->ctx) < 0)
+            {
+                pa = __CU_ARRAY_OFFSET_BACK(pa, item_size);
+                __cu_array_copy_item(out, pa, item_size);
+            }
+            else
+            {
+                pb = __CU_ARRAY_OFFSET_BACK(pb, item_size);
+                __cu_array_copy_item(out, pb, item_size);
+            }
+        }
+        cu_memcpy(data, s->scratch, __CU_ARRAY_DISTANCE(s->scratch, pb));
+    }
+}
+
+CU_API void __cu_array_merge_at(__cu_array_merge_state_t *s, size_t i)
+{
+    __cu_array_merge_runs(s, __CU_ARRAY_OFFSET(s->data, s->item_size * s->run_start[i]), s->run_length[i], s->run_length[i + 1u]);
+    s->run_length[i] += s->run_length[i + 1u];
+    if (i + 3u == s->height)
+    {
+        s->run_start[i + 1u] = s->run_start[i + 2u];
+        s->run_length[i + 1u] = s->run_length[i + 2u];
+    }
+    s->height--;
+}
+
+/// Merges the runs on top of the stack until their lengths follow the invariants of timsort
+/// (with the check of the fourth run from the top that keeps them valid all the way down).
+CU_API void __cu_array_merge_collapse(__cu_array_merge_state_t *s)
+{
+    size_t *len = s->run_length;
+    while (s->height > 1u)
+    {
+        size_t n = s->height - 2u;
+        if ((n > 0u && len[n - 1u] <= len[n] + len[n + 1u]) || (n > 1u && len[n - 2u] <= len[n - 1u] + len[n]))
+        {
+            if (len[n - 1u] < len[n + 1u])
+            {
+                n--;
+            }
+        }
+        else if (len[n] > len[n + 1u])
+        {
+            return;
+        }
+        __cu_array_merge_at(s, n);
+    }
+}
+
+/// Natural merge sort: existing runs are kept (descending ones reversed), short ones are extended
+/// with binary insertion sort to the minimum run length, then merged in a balanced order.
+/// `scratch` must hold `len / 2` items, at least one.
+CU_API void __cu_array_stable_sort_internal(CU_UNIT *data, size_t item_size, size_t len, CU_UNIT *scratch, int (*compare)(void *, void *, void *), void *ctx)
+{
+    __cu_array_merge_state_t s;
+    s.data = data;
+    s.item_size = item_size;
+    s.scratch = scratch;
+    s.compare = compare;
+    s.ctx = ctx;
+    s.height = 0;
+
+    size_t min_run = __cu_array_min_run(len);
+    size_t pos = 0;
+    while (pos < len)
+    {
+        CU_UNIT *run = __CU_ARRAY_OFFSET(data, item_size * pos);
+        size_t remaining = len - pos;
+        size_t n = __cu_array_count_run(run, item_size, remaining, compare, ctx);
+        if (n < min_run)
+        {
+            size_t forced = remaining < min_run ? remaining : min_run;
+            __cu_array_binary_insertion_sort(run, item_size, n, forced, scratch, compare, ctx);
+            n = forced;
+        }
+        s.run_start[s.height] = pos;
+        s.run_length[s.height] = n;
+        s.height++;
+        pos += n;
+        __cu_array_merge_collapse(&s);
+    }
+
+    while (s.height > 1u)
+    {
+        size_t n = s.height - 2u;
+        if (n > 0u && s.run_length[n - 1u] < s.run_length[n + 1u])
+        {
+            n--;
+        }
+        __cu_array_merge_at(&s, n);
+    }
+}
+
+#ifdef CU_ARRAY_THREADS
+typedef struct __cu_array_psort_task_s
+{
+    CU_UNIT *data;
+    size_t item_size;
+    size_t len;
+    size_t depth_limit;
+    size_t nthreads;
+    int (*compare)(void *, void *, void *);
+    void *ctx;
+} __cu_array_psort_task_t;
+
+CU_API void __cu_array_psort_internal(__cu_array_psort_task_t *task);
+
+CU_API void *__cu_array_psort_worker(void *arg)
+{
+    __cu_array_psort_internal((__cu_array_psort_task_t *)arg);
+    return NULL;
+}
+
+CU_API void __cu_array_psort_internal(__cu_array_psort_task_t *task)
+{
+    if (task->nthreads < 2u || task->len < CU_ARRAY_PSORT_THRESHOLD || task->depth_limit == 0u)
+    {
+        __cu_array_introsort(task->data, task->item_size, task->len, task->depth_limit, task->compare, task->ctx);
+        return;
+    }
+
+    size_t p = __cu_array_partition(task->data, task->item_size, task->len, task->compare, task->ctx);
+    __cu_array_psort_task_t left = *task;
+    __cu_array_psort_task_t right = *task;
+    left.len = p;
+    left.depth_limit -= 1u;
+    left.nthreads = task->nthreads - task->nthreads / 2u;
+    right.data = __CU_ARRAY_OFFSET(task->data, task->item_size * (p + 1u));
+    right.len = task->len - p - 1u;
+    right.depth_limit -= 1u;
+    right.nthreads = task->nthreads / 2u;
+
+    // If no thread can be started, this thread sorts both sides.
+    pthread_t thread;
+    int spawned = pthread_create(&thread, NULL, __cu_array_psort_worker, &right) == 0;
+    if (!spawned)
+    {
+        __cu_array_psort_internal(&right);
+    }
+    __cu_array_psort_internal(&left);
+    if (spawned)
+    {
+        pthread_join(thread, NULL);
+    }
+}
+#endif // CU_ARRAY_THREADS
+
+/// Loads the key of `item` and maps it to an unsigned integer with the same order.
+CU_API uint64_t __cu_array_radix_key(const CU_UNIT *item, size_t key_width, unsigned int flags)
+{
+    uint64_t key;
+    switch (key_width)
+    {
+    case 1u:
+    {
+        uint8_t k;
+        cu_memcpy(&k, item, 1u);
+        key = k;
+        break;
+    }
+    case 2u:
+    {
+        uint16_t k;
+        cu_memcpy(&k, item, 2u);
+        key = k;
+        break;
+    }
+    case 4u:
+    {
+        uint32_t k;
+        cu_memcpy(&k, item, 4u);
+        key = k;
+        break;
+    }
+    default:
+    {
+        uint64_t k;
+        cu_memcpy(&k, item, 8u);
+        key = k;
+        break;
+    }
+    }
+
+    uint64_t sign = (uint64_t)1u << (key_width * 8u - 1u);
+    uint64_t mask = sign | (sign - 1u);
+    if (flags & CU_RADIX_FLOAT)
+    {
+        // Negative floats: flip everything, positive floats: flip the sign bit.
+        key = (key & sign) ? ~key : (key | sign);
+    }
+    else if (flags & CU_RADIX_SIGNED)
+    {
+        key ^= sign;
+    }
+    if (flags & CU_RADIX_DESCENDING)
+    {
+        key = ~key;
+    }
+    return key & mask;
+}
+
+// Aligned storage: the block from the allocator is `size + __CU_ARRAY_ALIGN_PAD(arr)` bytes,
+// and the pointer to it is stored right before the aligned storage.
+#define __CU_ARRAY_ALIGN_PAD(arr) ((arr)->alignment - 1u + sizeof(void *))
+
+CU_API void *__cu_array_alloc(cu_array_t *arr, size_t size)
+{
+    if (arr->alignment != 0u)
+    {
+        if (size > SIZE_MAX - __CU_ARRAY_ALIGN_PAD(arr))
+        {
+            return NULL;
+        }
+        size_t block_size = size + __CU_ARRAY_ALIGN_PAD(arr);
+        unsigned char *block = (unsigned char *)(arr->allocator == NULL ? cu_malloc(block_size)
+                                                                        : arr->allocator->alloc(arr->allocator->ctx, block_size));
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        uintptr_t start = (uintptr_t)(block + sizeof(void *));
+        size_t skip = (size_t)(((uintptr_t)0 - start) & (arr->alignment - 1u));
+        unsigned char *aligned = block + sizeof(void *) + skip;
+        cu_memcpy(aligned - sizeof(void *), &block, sizeof(void *));
+        return aligned;
+    }
+    if (arr->allocator == NULL)
+    {
+        return cu_malloc(size);
+    }
+    return arr->allocator->alloc(arr->allocator->ctx, size);
+}
+
+CU_API void __cu_array_free(cu_array_t *arr, void *ptr, size_t size)
+{
+    if (arr->alignment != 0u)
+    {
+        void *block;
+        cu_memcpy(&block, (unsigned char *)ptr - sizeof(void *), sizeof(void *));
+        ptr = block;
+        size += __CU_ARRAY_ALIGN_PAD(arr);
+    }
+    if (arr->allocator == NULL)
+    {
+        cu_free(ptr);
+        return;
+    }
+    arr->allocator->free(arr->allocator->ctx, ptr, size);
+}
+
+CU_API void *__cu_array_realloc(cu_array_t *arr, void *ptr, size_t old_size, size_t new_size)
+{
+    if (arr->alignment != 0u)
+    {
+        // The offset of the aligned storage in the block changes when it moves, so always copy.
+        void *tmp = __cu_array_alloc(arr, new_size);
+        if (tmp == NULL)
+        {
+            return NULL;
+        }
+        cu_memcpy(tmp, ptr, old_size < new_size ? old_size : new_size);
+        __cu_array_free(arr, ptr, old_size);
+        return tmp;
+    }
+    if (arr->allocator == NULL)
+    {
+        return cu_realloc(ptr, new_size);
+    }
+    return arr->allocator->realloc(arr->allocator->ctx, ptr, old_size, new_size);
+}
+
+#ifdef CU_ARRAY_MMAP
+/// The huge page allocator points its context here, the regular one has a `NULL` context.
+static unsigned int __cu_array_mmap_huge_pages = CU_ARRAY_MMAP_HUGE_PAGES;
+
+/// Rounds `size` up to whole pages, `0` if that doesn't fit in a `size_t`.
+CU_API size_t __cu_array_mmap_round(void *ctx, size_t size)
+{
+    size_t granularity = ctx != NULL ? (size_t)CU_ARRAY_HUGE_PAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+    if (size == 0u)
+    {
+        size = 1u;
+    }
+    if (size > SIZE_MAX - granularity + 1u)
+    {
+        return 0;
+    }
+    return (size + granularity - 1u) / granularity * granularity;
+}
+
+CU_API void __cu_array_mmap_advise(void *ctx, void *ptr, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    if (ctx != NULL)
+    {
+        // Best effort, fails if transparent huge pages are disabled.
+        (void)madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#else
+    (void)ctx;
+    (void)ptr;
+    (void)size;
+#endif // MADV_HUGEPAGE
+}
+
+CU_API void *__cu_array_mmap_alloc(void *ctx, size_t size)
+{
+    size = __cu_array_mmap_round(ctx, size);
+    size_t extra = ctx != NULL ? (size_t)CU_ARRAY_HUGE_PAGE_SIZE : 0u;
+    if (size == 0u || size > SIZE_MAX - extra)
+    {
+        return NULL;
+    }
+    unsigned char *ptr = (unsigned char *)mmap(NULL, size + extra, PROT_READ | PROT_WRITE,
+                                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *)ptr == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if (extra != 0u)
+    {
+        // Huge pages need a huge page aligned range, so map a bit more and trim both ends.
+        size_t head = (CU_ARRAY_HUGE_PAGE_SIZE - (size_t)(void *)ptr % CU_ARRAY_HUGE_PAGE_SIZE) % CU_ARRAY_HUGE_PAGE_SIZE;
+        if (head != 0u)
+        {
+            munmap(ptr, head);
+        }
+        if (extra - head != 0u)
+        {
+            munmap(ptr + head + size, extra - head);
+        }
+        ptr += head;
+    }
+    __cu_array_mmap_advise(ctx, ptr, size);
+    return ptr;
+}
+
+CU_API void __cu_array_mmap_free(void *ctx, void *ptr, size_t size)
+{
+    if (ptr != NULL)
+    {
+        munmap(ptr, __cu_array_mmap_round(ctx, size));
+    }
+}
+
+CU_API void *__cu_array_mmap_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+    if (ptr == NULL)
+    {
+        return __cu_array_mmap_alloc(ctx, new_size);
+    }
+    size_t old_mapped = __cu_array_mmap_round(ctx, old_size);
+    size_t new_mapped = __cu_array_mmap_round(ctx, new_size);
+    if (new_mapped == 0u)
+    {
+        return NULL;
+    }
+    if (old_mapped == new_mapped)
+    {
+        return ptr;
+    }
+
+    void *tmp = NULL;
+#ifdef MREMAP_MAYMOVE
+    // Moves the page table entries, the items themselves are never copied. Huge page mappings only resize
+    // in place here, MREMAP_MAYMOVE could move them to an address that isn't huge page aligned.
+    tmp = mremap(ptr, old_mapped, new_mapped, ctx != NULL ? 0 : MREMAP_MAYMOVE);
+    if (tmp != MAP_FAILED)
+    {
+        __cu_array_mmap_advise(ctx, tmp, new_mapped);
+        return tmp;
+    }
+    if (ctx == NULL)
+    {
+        return NULL;
+    }
+#ifdef MREMAP_FIXED
+    // Otherwise they move onto an aligned range reserved up front, which MREMAP_FIXED replaces.
+    tmp = __cu_array_mmap_alloc(ctx, new_size);
+    if (tmp == NULL)
+    {
+        return NULL;
+    }
+    if (mremap(ptr, old_mapped, new_mapped, MREMAP_MAYMOVE | MREMAP_FIXED, tmp) == MAP_FAILED)
+    {
+        munmap(tmp, new_mapped);
+        return NULL;
+    }
+    __cu_array_mmap_advise(ctx, tmp, new_mapped);
+    return tmp;
+#endif // MREMAP_FIXED
+#endif // MREMAP_MAYMOVE
+    tmp = __cu_array_mmap_alloc(ctx, new_size);
+    if (tmp == NULL)
+    {
+        return NULL;
+    }
+    cu_memcpy(tmp, ptr, old_mapped < new_mapped ? old_mapped : new_mapped);
+    munmap(ptr, old_mapped);
+    return tmp;
+}
+
+static const cu_allocator_t __cu_array_mmap_allocators[2] = {
+    {__cu_array_mmap_alloc, __cu_array_mmap_realloc, __cu_array_mmap_free, NULL},
+    {__cu_array_mmap_alloc, __cu_array_mmap_realloc, __cu_array_mmap_free, &__cu_array_mmap_huge_pages},
+};
+
+/// Unmaps the file mapping of an array from `cu_array_map`, the header is mapped right before the items.
+CU_API void __cu_array_unmap(cu_array_t *arr)
+{
+    munmap(__CU_ARRAY_OFFSET_BACK(arr->data, CU_ARRAY_FILE_DATA_OFFSET), CU_ARRAY_FILE_DATA_OFFSET + arr->item_size * arr->capacity);
+}
+
+CU_API uint64_t __cu_array_checksum(const unsigned char *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+CU_API int __cu_array_write_all(int fd, const unsigned char *data, size_t size)
+{
+    while (size > 0u)
+    {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return 1;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+#endif // CU_ARRAY_MMAP
+
+#ifdef CU_DEBUG
+CU_API int _cu_array_debug_print(cu_array_t *arr)
+{
+    if (arr == NULL)
+    {
+        return 1;
+    }
+    printf("{\n"
+           "\tdata:      %p\n"
+           "\titem_size: %zu\n"
+           "\tlength:    %zu\n"
+           "\tcapacity:  %zu\n"
+           "\tallocator: %p\n"
+           "\tflags:     %u\n"
+           "}\n",
+           arr->data, arr->item_size, arr->length, arr->capacity, (const void *)arr->allocator, arr->flags);
+    return 0;
+}
+#endif // CU_DEBUG
+
+#ifdef CU_ARRAY_STATS
+static cu_array_stats_hook_t __cu_array_stats_hook = NULL;
+static void *__cu_array_stats_hook_ctx = NULL;
+
+CU_API void cu_array_set_stats_hook(cu_array_stats_hook_t hook, void *ctx)
+{
+    __cu_array_stats_hook = hook;
+    __cu_array_stats_hook_ctx = ctx;
+}
+
+CU_API void __cu_array_stats_event(cu_array_t *arr, unsigned int event, size_t bytes)
+{
+    cu_array_stats_t *stats = &arr->stats;
+    switch (event)
+    {
+    case CU_ARRAY_STATS_GROW:
+        stats->grows += 1;
+        stats->copied_bytes += bytes;
+        break;
+    case CU_ARRAY_STATS_SHRINK:
+        stats->shrinks += 1;
+        stats->copied_bytes += bytes;
+        break;
+    case CU_ARRAY_STATS_RESERVE:
+        stats->reserves += 1;
+        break;
+    case CU_ARRAY_STATS_MOVE:
+        stats->moves += 1;
+        stats->moved_bytes += bytes;
+        break;
+    default:
+        break;
+    }
+    if (stats->peak_capacity < arr->capacity)
+    {
+        stats->peak_capacity = arr->capacity;
+    }
+    if (__cu_array_stats_hook != NULL)
+    {
+        __cu_array_stats_hook(arr, event, bytes, __cu_array_stats_hook_ctx);
+    }
+}
+#endif // CU_ARRAY_STATS
+
+#ifdef CU_ARRAY_STATS
+/// Whether reallocations move the pages of the storage (`mremap`) instead of copying the items.
+CU_API int __cu_array_remaps(cu_array_t *arr)
+{
+#if defined(CU_ARRAY_MMAP) && defined(MREMAP_MAYMOVE)
+#ifdef MREMAP_FIXED
+    return arr->allocator == &__cu_array_mmap_allocators[0] || arr->allocator == &__cu_array_mmap_allocators[1];
+#else
+    // Huge page storage is copied when it can't grow in place.
+    return arr->allocator == &__cu_array_mmap_allocators[0];
+#endif // MREMAP_FIXED
+#else
+    (void)arr;
+    return 0;
+#endif // defined(CU_ARRAY_MMAP) && defined(MREMAP_MAYMOVE)
+}
+#endif // CU_ARRAY_STATS
+
+// "Public" function definitions
+
+/// Changes the capacity of the storage, moving external storage to the allocator.
+CU_API int __cu_array_resize_storage(cu_array_t *arr, size_t new_capacity)
+{
+    if (new_capacity > SIZE_MAX / arr->item_size)
+    {
+        return 1;
+    }
+    if (arr->growth != NULL && arr->growth->max_capacity != 0u && new_capacity > arr->growth->max_capacity)
+    {
+        return 1;
+    }
+
+    CU_UNIT *tmp;
+#ifdef CU_ARRAY_STATS
+    size_t old_capacity = arr->capacity;
+    size_t copied = 0;
+#endif // CU_ARRAY_STATS
+    if (arr->data == NULL)
+    {
+        tmp = (CU_UNIT *)__cu_array_alloc(arr, arr->item_size * new_capacity);
+        if (tmp == NULL)
+        {
+            return 1;
+        }
+    }
+    else if (arr->flags & (CU_ARRAY_EXTERNAL_STORAGE | CU_ARRAY_MAPPED))
+    {
+        tmp = (CU_UNIT *)__cu_array_alloc(arr, arr->item_size * new_capacity);
+        if (tmp == NULL)
+        {
+            return 1;
+        }
+        cu_memcpy(tmp, arr->data, arr->item_size * arr->length);
+#ifdef CU_ARRAY_STATS
+        copied = arr->item_size * arr->length;
+#endif // CU_ARRAY_STATS
+#ifdef CU_ARRAY_MMAP
+        if (arr->flags & CU_ARRAY_MAPPED)
+        {
+            __cu_array_unmap(arr);
+        }
+#endif // CU_ARRAY_MMAP
+        arr->flags &= ~(CU_ARRAY_EXTERNAL_STORAGE | CU_ARRAY_MAPPED | CU_ARRAY_READONLY);
+    }
+    else
+    {
+#ifdef CU_ARRAY_STATS
+        uintptr_t old_data = (uintptr_t)arr->data;
+#endif // CU_ARRAY_STATS
+        tmp = (CU_UNIT *)__cu_array_realloc(arr, arr->data, arr->item_size * arr->capacity,
+                                           arr->item_size * new_capacity);
+        if (tmp == NULL)
+        {
+            return 1;
+        }
+#ifdef CU_ARRAY_STATS
+        // The allocator copied the items only if the block moved, and not even then with `mremap`.
+        copied = (uintptr_t)tmp != old_data && !__cu_array_remaps(arr) ? arr->item_size * arr->length : 0u;
+#endif // CU_ARRAY_STATS
+    }
+
+    arr->data = tmp;
+    arr->capacity = new_capacity;
+    __CU_ARRAY_STATS_EVENT(arr, new_capacity < old_capacity ? CU_ARRAY_STATS_SHRINK : CU_ARRAY_STATS_GROW, copied);
+    return 0;
+}
+
+/// Returns the capacity after the next growth, or the current capacity if it can't grow anymore.
+CU_API size_t __cu_array_next_capacity(cu_array_t *arr)
+{
+    const cu_array_growth_t *growth = arr->growth;
+    if (growth == NULL)
+    {
+        if (arr->capacity == 0u)
+        {
+            return CU_ARRAY_DEFAULT_SIZE;
+        }
+#ifdef CU_GROWTH_RATE_SPEED
+        size_t new_capacity = __next_power_of_two(arr->capacity);
+        if (new_capacity == arr->capacity)
+        {
+            new_capacity = __next_power_of_two(arr->capacity + 1);
+        }
+#endif
+#ifdef CU_GROWTH_RATE_SPACE
+        size_t new_capacity = arr->capacity > SIZE_MAX / 2u ? arr->capacity : arr->capacity * 2u;
+#endif
+        return new_capacity;
+    }
+
+    size_t new_capacity;
+    if (arr->capacity == 0u)
+    {
+        new_capacity = growth->initial_capacity != 0u ? growth->initial_capacity : CU_ARRAY_DEFAULT_SIZE;
+    }
+    else if (growth->linear_threshold != 0u && arr->capacity >= growth->linear_threshold)
+    {
+        new_capacity = arr->capacity > SIZE_MAX - growth->linear_increment
+                           ? SIZE_MAX
+                           : arr->capacity + growth->linear_increment;
+    }
+    else
+    {
+        new_capacity = arr->capacity > SIZE_MAX / growth->factor_num
+                           ? SIZE_MAX
+                           : arr->capacity * growth->factor_num / growth->factor_den;
+        // Small capacities with factors close to 1 would otherwise get stuck.
+        if (new_capacity <= arr->capacity && arr->capacity < SIZE_MAX)
+        {
+            new_capacity = arr->capacity + 1u;
+        }
+    }
+
+    if (growth->max_capacity != 0u && new_capacity > growth->max_capacity)
+    {
+        new_capacity = growth->max_capacity;
+    }
+    return new_capacity;
+}
+
+CU_API int __cu_array_prepare(cu_array_t *arr, size_t additional)
+{
+    if (arr == NULL || arr->item_size == 0u || additional > SIZE_MAX - arr->length)
+    {
+        return 1;
+    }
+
+    size_t needed = arr->length + additional;
+    if (arr->capacity >= needed)
+    {
+        if (!(arr->flags & CU_ARRAY_READONLY))
+        {
+            return 0;
+        }
+        // Read-only storage is copied out on the first modification.
+        return __cu_array_resize_storage(arr, arr->capacity);
+    }
+
+    size_t new_capacity = __cu_array_next_capacity(arr);
+    if (new_capacity < needed)
+    {
+        new_capacity = needed;
+    }
+    return __cu_array_resize_storage(arr, new_capacity);
+}
+
+CU_API int cu_array_init(cu_array_t *arr, size_t item_size)
+{
+    return cu_array_init_with_allocator(arr, item_size, NULL);
+}
+
+CU_API int cu_array_init_with_allocator(cu_array_t *arr, size_t item_size, const cu_allocator_t *allocator)
+{
+    if (arr == NULL || arr->data != NULL || arr->capacity != 0u || item_size == 0u || item_size % sizeof(CU_UNIT) != 0u)
+    {
+        return 1;
+    }
+    if (allocator != NULL && (allocator->alloc == NULL || allocator->realloc == NULL || allocator->free == NULL))
+    {
+        return 1;
+    }
+
+    *arr = (cu_array_t){0};
+    arr->item_size = item_size;
+    arr->allocator = allocator;
+    return 0;
+}
+
+CU_API int cu_array_init_aligned(cu_array_t *arr, size_t item_size, size_t alignment)
+{
+    if (alignment == 0u || (alignment & (alignment - 1u)) != 0u || alignment > SIZE_MAX / 2u)
+    {
+        return 1;
+    }
+    if (cu_array_init(arr, item_size) != 0)
+    {
+        return 1;
+    }
+    // The pointer to the block is stored right before the storage, it needs that much alignment (and so do the units).
+    size_t min_alignment = sizeof(void *) < sizeof(CU_UNIT) ? sizeof(CU_UNIT) : sizeof(void *);
+    arr->alignment = alignment < min_alignment ? min_alignment : alignment;
+    return 0;
+}
+
+CU_API int cu_array_init_padded(cu_array_t *arr, size_t item_size, size_t alignment)
+{
+    if (alignment == 0u || (alignment & (alignment - 1u)) != 0u || item_size > SIZE_MAX - (alignment - 1u))
+    {
+        return 1;
+    }
+    return cu_array_init_aligned(arr, (item_size + alignment - 1u) & ~(alignment - 1u), alignment);
+}
+
+CU_API int cu_array_init_with_buffer(cu_array_t *arr, size_t item_size, void *buffer, size_t capacity)
+{
+    if (arr == NULL || arr->data != NULL || arr->capacity != 0u || item_size == 0u || item_size % sizeof(CU_UNIT) != 0u ||
+        buffer == NULL || capacity == 0u)
+    {
+        return 1;
+    }
+
+    *arr = (cu_array_t){0};
+    arr->item_size = item_size;
+    arr->data = (CU_UNIT *)buffer;
+    arr->capacity = capacity;
+    arr->flags = CU_ARRAY_EXTERNAL_STORAGE;
+    return 0;
+}
+
+#ifdef CU_ARRAY_MMAP
+CU_API const cu_allocator_t *cu_array_mmap_allocator(unsigned int mmap_flags)
+{
+    return &__cu_array_mmap_allocators[(mmap_flags & CU_ARRAY_MMAP_HUGE_PAGES) ? 1 : 0];
+}
+
+CU_API int cu_array_init_mmap(cu_array_t *arr, size_t item_size, unsigned int mmap_flags)
+{
+    return cu_array_init_with_allocator(arr, item_size, cu_array_mmap_allocator(mmap_flags));
+}
+
+CU_API int cu_array_save(cu_array_t *arr, const char *path)
+{
+    if (arr == NULL || arr->item_size == 0u || path == NULL)
+    {
+        return 1;
+    }
+
+    size_t size = arr->item_size * arr->length;
+    unsigned char header[CU_ARRAY_FILE_DATA_OFFSET] = {0};
+    cu_array_file_header_t file_header = {0};
+    cu_memcpy(file_header.magic, CU_ARRAY_FILE_MAGIC, sizeof(CU_ARRAY_FILE_MAGIC));
+    file_header.version = CU_ARRAY_FILE_VERSION;
+    file_header.data_offset = CU_ARRAY_FILE_DATA_OFFSET;
+    file_header.item_size = arr->item_size;
+    file_header.length = arr->length;
+    file_header.checksum = __cu_array_checksum((const unsigned char *)arr->data, size);
+    cu_memcpy(header, &file_header, sizeof(file_header));
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return 1;
+    }
+    int res = __cu_array_write_all(fd, header, sizeof(header));
+    if (res == 0 && size > 0u)
+    {
+        res = __cu_array_write_all(fd, (const unsigned char *)arr->data, size);
+    }
+    if (close(fd) != 0)
+    {
+        res = 1;
+    }
+    return res;
+}
+
+CU_API int cu_array_map(cu_array_t *arr, const char *path, unsigned int flags)
+{
+    if (arr == NULL || arr->data != NULL || arr->capacity != 0u || path == NULL ||
+        ((flags & CU_ARRAY_MAP_READONLY) != 0u) == ((flags & CU_ARRAY_MAP_COPY_ON_WRITE) != 0u))
+    {
+        return 1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return 1;
+    }
+    struct stat st;
+    cu_array_file_header_t header;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < CU_ARRAY_FILE_DATA_OFFSET ||
+        read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header))
+    {
+        close(fd);
+        return 1;
+    }
+    int magic_ok = 1;
+    for (size_t i = 0; i < sizeof(CU_ARRAY_FILE_MAGIC); i++)
+    {
+        magic_ok &= header.magic[i] == CU_ARRAY_FILE_MAGIC[i];
+    }
+    if (!magic_ok ||
+        header.version != CU_ARRAY_FILE_VERSION || header.data_offset != CU_ARRAY_FILE_DATA_OFFSET ||
+        header.item_size == 0u || header.item_size % sizeof(CU_UNIT) != 0u ||
+        header.length > (SIZE_MAX - CU_ARRAY_FILE_DATA_OFFSET) / header.item_size ||
+        (uint64_t)st.st_size < CU_ARRAY_FILE_DATA_OFFSET + header.item_size * header.length)
+    {
+        close(fd);
+        return 1;
+    }
+
+    size_t map_size = CU_ARRAY_FILE_DATA_OFFSET + (size_t)(header.item_size * header.length);
+    int readonly = (flags & CU_ARRAY_MAP_READONLY) != 0u;
+    void *map = mmap(NULL, map_size, readonly ? PROT_READ : (PROT_READ | PROT_WRITE),
+                     readonly ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return 1;
+    }
+
+    CU_UNIT *data = __CU_ARRAY_OFFSET(map, CU_ARRAY_FILE_DATA_OFFSET);
+    if ((flags & CU_ARRAY_MAP_VERIFY) &&
+        __cu_array_checksum((const unsigned char *)data, map_size - CU_ARRAY_FILE_DATA_OFFSET) != header.checksum)
+    {
+        munmap(map, map_size);
+        return 1;
+    }
+
+    *arr = (cu_array_t){0};
+    arr->data = data;
+    arr->item_size = (size_t)header.item_size;
+    arr->length = (size_t)header.length;
+    arr->capacity = (size_t)header.length;
+    arr->flags = CU_ARRAY_MAPPED | (readonly ? CU_ARRAY_READONLY : 0u);
+    return 0;
+}
+#endif // CU_ARRAY_MMAP
+
+#ifdef CU_ARRAY_IO
+/// Number of `iovec`s per `writev` call, POSIX only guarantees 16.
+#if defined(IOV_MAX) && IOV_MAX < 64
+#define __CU_ARRAY_IOV_COUNT IOV_MAX
+#else
+#define __CU_ARRAY_IOV_COUNT 64
+#endif // defined(IOV_MAX) && IOV_MAX < 64
+
+/// Writes all of `iov`, retrying partial writes, the entries are consumed.
+CU_API int __cu_array_writev_all(int fd, struct iovec *iov, int count)
+{
+    while (count > 0)
+    {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return 1;
+        }
+        size_t left = (size_t)written;
+        while (count > 0 && left >= iov->iov_len)
+        {
+            left -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = (unsigned char *)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+    return 0;
+}
+
+CU_API int cu_array_write_fd(cu_array_t *arr, int fd)
+{
+    return cu_array_writev_fd(&arr, 1, fd);
+}
+
+CU_API int cu_array_writev_fd(cu_array_t **arrs, size_t count, int fd)
+{
+    if (arrs == NULL && count != 0u)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (arrs[i] == NULL || arrs[i]->item_size == 0u)
+        {
+            return 1;
+        }
+    }
+
+    struct iovec iov[__CU_ARRAY_IOV_COUNT];
+    size_t next = 0;
+    size_t offset = 0;
+    for (;;)
+    {
+        // Gather the next batch, large arrays are split over several batches.
+        int n = 0;
+        size_t budget = CU_ARRAY_IO_BATCH_SIZE;
+        while (n < __CU_ARRAY_IOV_COUNT && next < count && budget > 0u)
+        {
+            cu_array_t *arr = arrs[next];
+            size_t size = arr->item_size * arr->length;
+            if (offset == size)
+            {
+                next++;
+                offset = 0;
+                continue;
+            }
+            size_t part = size - offset < budget ? size - offset : budget;
+            iov[n].iov_base = __CU_ARRAY_OFFSET(arr->data, offset);
+            iov[n].iov_len = part;
+            n++;
+            offset += part;
+            budget -= part;
+        }
+        if (n == 0)
+        {
+            return 0;
+        }
+        if (__cu_array_writev_all(fd, iov, n) != 0)
+        {
+            return 1;
+        }
+    }
+}
+
+CU_API int cu_array_read_chunk(cu_array_t *arr, int fd, size_t max_items)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if (max_items == 0u)
+    {
+        max_items = arr->capacity;
+    }
+    if (max_items == 0u || max_items > SIZE_MAX / arr->item_size)
+    {
+        return 1;
+    }
+    arr->length = 0;
+    // Allocates on the first call (or makes read-only storage writable), later chunks reuse the storage.
+    if ((max_items > arr->capacity || (arr->flags & CU_ARRAY_READONLY)) && cu_array_reserve(arr, max_items) != 0)
+    {
+        return 1;
+    }
+
+    size_t want = arr->item_size * max_items;
+    size_t got = 0;
+    int res = 0;
+    while (got < want)
+    {
+        size_t size = want - got < CU_ARRAY_IO_BATCH_SIZE ? want - got : CU_ARRAY_IO_BATCH_SIZE;
+        ssize_t n = read(fd, __CU_ARRAY_OFFSET(arr->data, got), size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            res = 1;
+            break;
+        }
+        if (n == 0)
+        {
+            // A partial item at the end of the stream is dropped.
+            res = got % arr->item_size != 0u;
+            break;
+        }
+        got += (size_t)n;
+    }
+    arr->length = got / arr->item_size;
+    __CU_ARRAY_STATS_LENGTH(arr);
+    return res;
+}
+#endif // CU_ARRAY_IO
+
+CU_API int cu_array_deinit(cu_array_t *arr)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    __CU_ARRAY_STATS_EVENT(arr, CU_ARRAY_STATS_DEINIT, 0);
+
+#ifdef CU_ARRAY_MMAP
+    if (arr->flags & CU_ARRAY_MAPPED)
+    {
+        __cu_array_unmap(arr);
+        *arr = (cu_array_t){0};
+        return 0;
+    }
+#endif // CU_ARRAY_MMAP
+    if (arr->data != NULL && !(arr->flags & CU_ARRAY_EXTERNAL_STORAGE))
+    {
+        __cu_array_free(arr, arr->data, arr->item_size * arr->capacity);
+    }
+    *arr = (cu_array_t){0};
+    return 0;
+}
+
+CU_API CU_UNIT *cu_array_at(cu_array_t *arr, size_t pos)
+{
+    if (arr == NULL || arr->data == NULL || pos >= arr->length)
+    {
+        return NULL;
+    }
+
+    return __CU_ARRAY_OFFSET(arr->data, arr->item_size * pos);
+}
+
+CU_API CU_UNIT *cu_array_begin(cu_array_t *arr)
+{
+    if (arr == NULL)
+    {
+        return NULL;
+    }
+    return arr->data;
+}
+
+CU_API CU_UNIT *cu_array_end(cu_array_t *arr)
+{
+    if (arr == NULL || arr->data == NULL)
+    {
+        return NULL;
+    }
+    return __CU_ARRAY_OFFSET(arr->data, arr->item_size * arr->length);
+}
+
+CU_API cu_array_iter_t cu_array_iter(cu_array_t *arr)
+{
+    cu_array_iter_t it = {NULL, NULL, 0};
+    if (arr == NULL || arr->data == NULL)
+    {
+        return it;
+    }
+    it.ptr = arr->data;
+    it.end = __CU_ARRAY_OFFSET(arr->data, arr->item_size * arr->length);
+    it.stride = arr->item_size;
+    return it;
+}
+
+CU_API int cu_array_for_each_chunk(cu_array_t *arr, size_t chunk, void (*fn)(void *, size_t, void *), void *ctx)
+{
+    if (arr == NULL || arr->item_size == 0u || chunk == 0u || fn == NULL)
+    {
+        return 1;
+    }
+
+    for (size_t pos = 0; pos < arr->length; pos += chunk)
+    {
+        size_t count = arr->length - pos < chunk ? arr->length - pos : chunk;
+#if CU_ARRAY_CHUNK_PREFETCH_DISTANCE > 0
+        // One hint per cache line of the bytes `CU_ARRAY_CHUNK_PREFETCH_DISTANCE` ahead of this chunk.
+        size_t total = arr->item_size * arr->length;
+        size_t from = arr->item_size * pos + CU_ARRAY_CHUNK_PREFETCH_DISTANCE;
+        size_t to = from + arr->item_size * count;
+        for (size_t offset = from; offset < to && offset < total; offset += 64u)
+        {
+            CU_ARRAY_PREFETCH(__CU_ARRAY_OFFSET(arr->data, offset));
+        }
+#endif // CU_ARRAY_CHUNK_PREFETCH_DISTANCE > 0
+        fn(__CU_ARRAY_OFFSET(arr->data, arr->item_size * pos), count, ctx);
+    }
+    return 0;
+}
+
+CU_API int cu_array_append(cu_array_t *arr, void *item)
+{
+    if (item == NULL || arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if (arr->length >= arr->capacity || (arr->flags & CU_ARRAY_READONLY))
+    {
+        int res = __cu_array_prepare(arr, 1);
+        if (res != 0)
+        {
+            return res;
+        }
+    }
+    cu_memcpy(__CU_ARRAY_OFFSET(arr->data, arr->item_size * arr->length), item, arr->item_size);
+    arr->length += 1;
+    __CU_ARRAY_STATS_LENGTH(arr);
+    return 0;
+}
+
+CU_API int cu_array_extend(cu_array_t *arr, void *items, size_t num_items)
+{
+    if (items == NULL || arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if (num_items == 0u)
+    {
+        return 0;
+    }
+    if (num_items > SIZE_MAX - arr->length)
+    {
+        return 1;
+    }
+    // Same as `cu_array_reserve`, without counting a reserve with `CU_ARRAY_STATS`.
+    size_t needed = arr->length + num_items;
+    if ((needed > arr->capacity || (arr->flags & CU_ARRAY_READONLY)) &&
+        __cu_array_resize_storage(arr, needed > arr->capacity ? needed : arr->capacity) != 0)
+    {
+        return 1;
+    }
+    cu_memcpy(__CU_ARRAY_OFFSET(arr->data, arr->item_size * arr->length), items, num_items * arr->item_size);
+    arr->length += num_items;
+    __CU_ARRAY_STATS_LENGTH(arr);
+    return 0;
+}
+
+CU_API int cu_array_insert(cu_array_t *arr, void *item, size_t pos)
+{
+    return cu_array_insert_range(arr, item, 1, pos);
+}
+
+CU_API int cu_array_insert_range(cu_array_t *arr, void *items, size_t num_items, size_t pos)
+{
+    if (items == NULL || arr == NULL || arr->item_size == 0u || pos > arr->length)
+    {
+        return 1;
+    }
+    if (num_items == 0u)
+    {
+        return 0;
+    }
+    if (arr->capacity - arr->length < num_items || (arr->flags & CU_ARRAY_READONLY))
+    {
+        int res = __cu_array_prepare(arr, num_items);
+        if (res != 0)
+        {
+            return res;
+        }
+    }
+
+    CU_UNIT *at = __CU_ARRAY_OFFSET(arr->data, arr->item_size * pos);
+    cu_memmove(__CU_ARRAY_OFFSET(at, arr->item_size * num_items), at, (arr->length - pos) * arr->item_size);
+    cu_memcpy(at, items, arr->item_size * num_items);
+    if (pos != arr->length)
+    {
+        __CU_ARRAY_STATS_EVENT(arr, CU_ARRAY_STATS_MOVE, (arr->length - pos) * arr->item_size);
+    }
+    arr->length += num_items;
+    __CU_ARRAY_STATS_LENGTH(arr);
+    return 0;
+}
+
+CU_API CU_UNIT *cu_array_emplace_n(cu_array_t *arr, size_t num_items)
+{
+    if (arr == NULL || arr->item_size == 0u || num_items == 0u)
+    {
+        return NULL;
+    }
+    if (arr->capacity - arr->length < num_items || (arr->flags & CU_ARRAY_READONLY))
+    {
+        if (__cu_array_prepare(arr, num_items) != 0)
+        {
+            return NULL;
+        }
+    }
+
+    CU_UNIT *first = __CU_ARRAY_OFFSET(arr->data, arr->item_size * arr->length);
+    arr->length += num_items;
+    __CU_ARRAY_STATS_LENGTH(arr);
+    return first;
+}
+
+CU_API int cu_array_reserve(cu_array_t *arr, size_t new_capacity)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    __CU_ARRAY_STATS_EVENT(arr, CU_ARRAY_STATS_RESERVE, 0);
+    if (arr->flags & CU_ARRAY_READONLY)
+    {
+        // The items are about to be written, copy them out of the read-only storage.
+        return __cu_array_resize_storage(arr, arr->capacity > new_capacity ? arr->capacity : new_capacity);
+    }
+    if (arr->capacity >= new_capacity)
+    {
+        return 0;
+    }
+
+    return __cu_array_resize_storage(arr, new_capacity);
+}
+
+CU_API int cu_array_set_growth(cu_array_t *arr, const cu_array_growth_t *growth)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if (growth != NULL && (growth->factor_num == 0u || growth->factor_den == 0u ||
+                           growth->factor_num < growth->factor_den ||
+                           (growth->linear_threshold != 0u && growth->linear_increment == 0u)))
+    {
+        return 1;
+    }
+    arr->growth = growth;
+    return 0;
+}
+
+CU_API int cu_array_shrink_to_fit(cu_array_t *arr)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if (arr->data == NULL || (arr->flags & (CU_ARRAY_EXTERNAL_STORAGE | CU_ARRAY_MAPPED)) ||
+        arr->length == arr->capacity)
+    {
+        return 0;
+    }
+    if (arr->length == 0u)
+    {
+        __cu_array_free(arr, arr->data, arr->item_size * arr->capacity);
+        arr->data = NULL;
+        arr->capacity = 0;
+        return 0;
+    }
+    return __cu_array_resize_storage(arr, arr->length);
+}
+
+CU_API int cu_array_remove_at(cu_array_t *arr, size_t pos)
+{
+    return cu_array_remove_range(arr, pos, 1);
+}
+
+CU_API int cu_array_remove_range(cu_array_t *arr, size_t pos, size_t num_items)
+{
+    if (arr == NULL || arr->item_size == 0u || pos > arr->length || num_items > arr->length - pos)
+    {
+        return 1;
+    }
+    if (num_items == 0u)
+    {
+        return 0;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    CU_UNIT *at = __CU_ARRAY_OFFSET(arr->data, arr->item_size * pos);
+    cu_memmove(at, __CU_ARRAY_OFFSET(at, arr->item_size * num_items), (arr->length - pos - num_items) * arr->item_size);
+    if (pos + num_items != arr->length)
+    {
+        __CU_ARRAY_STATS_EVENT(arr, CU_ARRAY_STATS_MOVE, (arr->length - pos - num_items) * arr->item_size);
+    }
+    arr->length -= num_items;
+    return 0;
+}
+
+CU_API int cu_array_swap_remove(cu_array_t *arr, size_t pos)
+{
+    if (arr == NULL || arr->item_size == 0u || pos >= arr->length)
+    {
+        return 1;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    size_t last = arr->length - 1u;
+    if (pos != last)
+    {
+        __cu_array_copy_item(__CU_ARRAY_OFFSET(arr->data, arr->item_size * pos), __CU_ARRAY_OFFSET(arr->data, arr->item_size * last), arr->item_size);
+    }
+    arr->length -= 1;
+    return 0;
+}
+
+CU_API int cu_array_retain(cu_array_t *arr, int (*pred)(void *, void *), void *ctx)
+{
+    if (arr == NULL || arr->item_size == 0u || pred == NULL)
+    {
+        return 1;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < arr->length; i++)
+    {
+        CU_UNIT *item = __CU_ARRAY_OFFSET(arr->data, arr->item_size * i);
+        if (!pred(item, ctx))
+        {
+            continue;
+        }
+        // kept < i, so the two items never overlap.
+        if (kept != i)
+        {
+            __cu_array_copy_item(__CU_ARRAY_OFFSET(arr->data, arr->item_size * kept), item, arr->item_size);
+        }
+        kept++;
+    }
+    arr->length = kept;
+    return 0;
+}
+
+CU_API int cu_array_clear(cu_array_t *arr)
+{
+    if (arr == NULL)
+    {
+        return 1;
+    }
+    arr->length = 0;
+    return 0;
+}
+
+/// Forgets the storage of `arr` without freeing it, keeping its configuration.
+CU_API void __cu_array_release(cu_array_t *arr)
+{
+    arr->data = NULL;
+    arr->length = 0;
+    arr->capacity = 0;
+    arr->flags = 0;
+}
+
+CU_API int cu_array_move(cu_array_t *dst, cu_array_t *src)
+{
+    if (dst == NULL || src == NULL || src->item_size == 0u)
+    {
+        return 1;
+    }
+    if (dst == src)
+    {
+        return 0;
+    }
+    if (dst->item_size != 0u && cu_array_deinit(dst) != 0)
+    {
+        return 1;
+    }
+
+    *dst = *src;
+    __cu_array_release(src);
+#ifdef CU_ARRAY_STATS
+    src->stats = (cu_array_stats_t){0};
+#endif // CU_ARRAY_STATS
+    return 0;
+}
+
+CU_API int cu_array_swap(cu_array_t *a, cu_array_t *b)
+{
+    if (a == NULL || b == NULL)
+    {
+        return 1;
+    }
+    cu_array_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+    return 0;
+}
+
+CU_API void *cu_array_detach(cu_array_t *arr, size_t *len)
+{
+    if (len != NULL)
+    {
+        *len = 0;
+    }
+    if (arr == NULL || arr->item_size == 0u || arr->alignment != 0u)
+    {
+        return NULL;
+    }
+    if (arr->length == 0u)
+    {
+#ifdef CU_ARRAY_MMAP
+        if (arr->flags & CU_ARRAY_MAPPED)
+        {
+            __cu_array_unmap(arr);
+        }
+#endif // CU_ARRAY_MMAP
+        if (arr->data != NULL && !(arr->flags & (CU_ARRAY_EXTERNAL_STORAGE | CU_ARRAY_MAPPED)))
+        {
+            __cu_array_free(arr, arr->data, arr->item_size * arr->capacity);
+        }
+        __cu_array_release(arr);
+        return NULL;
+    }
+    // Allocator-backed storage is shrunk so the caller can free it knowing only the length.
+    if ((arr->flags & (CU_ARRAY_EXTERNAL_STORAGE | CU_ARRAY_MAPPED)) ||
+        (arr->allocator != NULL && arr->capacity != arr->length))
+    {
+        if (__cu_array_resize_storage(arr, arr->length) != 0)
+        {
+            return NULL;
+        }
+    }
+
+    void *data = arr->data;
+    if (len != NULL)
+    {
+        *len = arr->length;
+    }
+    __cu_array_release(arr);
+    return data;
+}
+
+CU_API int cu_array_qsort(cu_array_t *arr, int (*compare)(void *, void *))
+{
+    if (arr == NULL || arr->item_size == 0u)
     {
         return 1;
     }
-    int res = cu_array_reserve(arr, arr->length + num_items);
-    if (res != 0)
+    if (compare == NULL)
     {
         return 1;
     }
-    cu_memcpy(arr->data + arr->item_size * arr->length, items, num_items * arr->item_size);
-    arr->length += num_items;
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+    __cu_array_compare_wrapper_t wrapper = {compare};
+    __cu_array_qsort_internal(arr->data, arr->item_size, arr->length, __cu_array_compare_wrapped, &wrapper);
     return 0;
 }
 
-CU_API int cu_array_insert(cu_array_t *arr, void *item, size_t pos)
+CU_API int cu_array_qsort_r(cu_array_t *arr, int (*compare)(void *, void *, void *), void *ctx)
 {
-    if (item == NULL || arr == NULL || arr->data == NULL || arr->capacity == 0u || pos > arr->length)
+    if (arr == NULL || arr->item_size == 0u || compare == NULL)
     {
         return 1;
     }
-    if (arr->length >= arr->capacity)
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
     {
-        int res = __cu_array_grow(arr);
-        if (res != 0)
+        return 1;
+    }
+    __cu_array_qsort_internal(arr->data, arr->item_size, arr->length, compare, ctx);
+    return 0;
+}
+
+#ifdef CU_ARRAY_THREADS
+CU_API int cu_array_psort(cu_array_t *arr, int (*compare)(void *, void *), size_t nthreads)
+{
+    if (arr == NULL || arr->item_size == 0u || compare == NULL)
+    {
+        return 1;
+    }
+    if (arr->length < 2u)
+    {
+        return 0;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    // Shared read-only by all threads, lives until the last one is joined.
+    __cu_array_compare_wrapper_t wrapper = {compare};
+    __cu_array_psort_task_t task = {0};
+    task.data = arr->data;
+    task.item_size = arr->item_size;
+    task.len = arr->length;
+    task.nthreads = nthreads;
+    task.compare = __cu_array_compare_wrapped;
+    task.ctx = &wrapper;
+    task.depth_limit = __cu_array_sort_depth_limit(arr->length);
+    __cu_array_psort_internal(&task);
+    return 0;
+}
+#endif // CU_ARRAY_THREADS
+
+CU_API int cu_array_radix_sort(cu_array_t *arr, size_t key_offset, size_t key_width, unsigned int flags)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if ((key_width != 1u && key_width != 2u && key_width != 4u && key_width != 8u) ||
+        ((flags & CU_RADIX_FLOAT) && key_width < 4u) ||
+        key_offset > arr->item_size || key_width > arr->item_size - key_offset)
+    {
+        return 1;
+    }
+    if (arr->length < 2u)
+    {
+        return 0;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    // One histogram per digit, all filled in a single pass.
+    size_t counts[8][256] = {{0}};
+    for (size_t i = 0; i < arr->length; i++)
+    {
+        uint64_t key = __cu_array_radix_key(__CU_ARRAY_OFFSET(arr->data, arr->item_size * i + key_offset), key_width, flags);
+        for (size_t d = 0; d < key_width; d++)
         {
-            return res;
+            counts[d][(key >> (8u * d)) & 0xFFu] += 1u;
         }
     }
 
-    cu_memmove(cu_array_at(arr, pos + 1), cu_array_at(arr, pos), (arr->length - pos) * arr->item_size);
-    cu_memcpy((void *)cu_array_at(arr, pos), item, arr->item_size);
-    arr->length += 1;
+    CU_UNIT *scratch = (CU_UNIT *)__cu_array_alloc(arr, arr->item_size * arr->length);
+    if (scratch == NULL)
+    {
+        return 1;
+    }
+
+    uint64_t first_key = __cu_array_radix_key(__CU_ARRAY_OFFSET(arr->data, key_offset), key_width, flags);
+    CU_UNIT *src = arr->data;
+    CU_UNIT *dst = scratch;
+    for (size_t d = 0; d < key_width; d++)
+    {
+        size_t *count = counts[d];
+        if (count[(first_key >> (8u * d)) & 0xFFu] == arr->length)
+        {
+            // Every item has the same byte here, the pass wouldn't change the order.
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t b = 0; b < 256u; b++)
+        {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+
+        for (size_t i = 0; i < arr->length; i++)
+        {
+            CU_UNIT *item = __CU_ARRAY_OFFSET(src, arr->item_size * i);
+            uint64_t key = __cu_array_radix_key(__CU_ARRAY_OFFSET(item, key_offset), key_width, flags);
+            size_t b = (size_t)((key >> (8u * d)) & 0xFFu);
+            __cu_array_copy_item(__CU_ARRAY_OFFSET(dst, arr->item_size * count[b]), item, arr->item_size);
+            count[b] += 1u;
+        }
+
+        CU_UNIT *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != arr->data)
+    {
+        cu_memcpy(arr->data, src, arr->item_size * arr->length);
+    }
+    __cu_array_free(arr, scratch, arr->item_size * arr->length);
     return 0;
 }
 
-CU_API int cu_array_reserve(cu_array_t *arr, size_t new_capacity)
+CU_API int __cu_array_stable_sort(cu_array_t *arr, int (*compare)(void *, void *, void *), void *ctx)
 {
-    if (arr == NULL || arr->data == NULL || arr->capacity == 0u)
+    if (arr->length < 2u)
+    {
+        return 0;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
     {
         return 1;
     }
-    if (arr->capacity >= new_capacity)
+    // Already sorted (or strictly descending, now reversed): no scratch needed.
+    if (__cu_array_count_run(arr->data, arr->item_size, arr->length, compare, ctx) == arr->length)
     {
         return 0;
     }
 
-    CU_UNIT *tmp = (CU_UNIT *)cu_realloc(arr->data, arr->item_size * new_capacity);
-    if (tmp == NULL)
+    size_t scratch_size = arr->item_size * (arr->length / 2u);
+    CU_UNIT *scratch = (CU_UNIT *)__cu_array_alloc(arr, scratch_size);
+    if (scratch == NULL)
     {
         return 1;
     }
+    __cu_array_stable_sort_internal(arr->data, arr->item_size, arr->length, scratch, compare, ctx);
+    __cu_array_free(arr, scratch, scratch_size);
+    return 0;
+}
 
-    arr->data = tmp;
-    arr->capacity = new_capacity;
+CU_API int cu_array_stable_sort(cu_array_t *arr, int (*compare)(void *, void *))
+{
+    if (arr == NULL || arr->item_size == 0u || compare == NULL)
+    {
+        return 1;
+    }
+    __cu_array_compare_wrapper_t wrapper = {compare};
+    return __cu_array_stable_sort(arr, __cu_array_compare_wrapped, &wrapper);
+}
+
+CU_API int cu_array_stable_sort_r(cu_array_t *arr, int (*compare)(void *, void *, void *), void *ctx)
+{
+    if (arr == NULL || arr->item_size == 0u || compare == NULL)
+    {
+        return 1;
+    }
+    return __cu_array_stable_sort(arr, compare, ctx);
+}
+
+/// Loser tree over the heads of the sources of `cu_array_merge_k`.
+typedef struct __cu_array_merge_k_s
+{
+    size_t k;
+    /// Next item and end of every source.
+    CU_UNIT **head;
+    CU_UNIT **end;
+    /// `tree[0]` is the source with the smallest head, the other nodes hold the losers of their matches.
+    /// The leaves (the sources) are the implicit nodes `k` to `2k - 1`.
+    size_t *tree;
+    int (*compare)(void *, void *);
+} __cu_array_merge_k_t;
+
+/// Whether the head of source `a` goes before the head of source `b`. Exhausted sources always lose,
+/// ties go to the lower source so the merge is stable.
+CU_API int __cu_array_merge_k_beats(__cu_array_merge_k_t *m, size_t a, size_t b)
+{
+    if (m->head[a] == m->end[a] || m->head[b] == m->end[b])
+    {
+        return m->head[b] == m->end[b] && (m->head[a] != m->end[a] || a < b);
+    }
+    int c = m->compare(m->head[a], m->head[b]);
+    return c < 0 || (c == 0 && a < b);
+}
+
+/// Plays the matches below `node` and returns the winner.
+CU_API size_t __cu_array_merge_k_build(__cu_array_merge_k_t *m, size_t node)
+{
+    if (node >= m->k)
+    {
+        return node - m->k;
+    }
+    size_t a = __cu_array_merge_k_build(m, 2u * node);
+    size_t b = __cu_array_merge_k_build(m, 2u * node + 1u);
+    if (__cu_array_merge_k_beats(m, a, b))
+    {
+        m->tree[node] = b;
+        return a;
+    }
+    m->tree[node] = a;
+    return b;
+}
+
+CU_API int cu_array_merge_k(cu_array_t *dst, cu_array_t **srcs, size_t k, int (*compare)(void *, void *))
+{
+    if (dst == NULL || dst->item_size == 0u || compare == NULL || (srcs == NULL && k != 0u))
+    {
+        return 1;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < k; i++)
+    {
+        cu_array_t *src = srcs[i];
+        if (src == NULL || src == dst || src->item_size != dst->item_size || src->length > SIZE_MAX - total)
+        {
+            return 1;
+        }
+        total += src->length;
+    }
+    if (total == 0u)
+    {
+        return 0;
+    }
+    size_t node_size = 2u * sizeof(CU_UNIT *) + sizeof(size_t);
+    if (k > SIZE_MAX / node_size || dst->length > SIZE_MAX - total ||
+        cu_array_reserve(dst, dst->length + total) != 0)
+    {
+        return 1;
+    }
+
+    __cu_array_merge_k_t m;
+    m.k = k;
+    m.compare = compare;
+    m.head = (CU_UNIT **)__cu_array_alloc(dst, k * node_size);
+    if (m.head == NULL)
+    {
+        return 1;
+    }
+    m.end = m.head + k;
+    m.tree = (size_t *)(m.end + k);
+    size_t item_size = dst->item_size;
+    for (size_t i = 0; i < k; i++)
+    {
+        m.head[i] = srcs[i]->data;
+        m.end[i] = srcs[i]->length != 0u ? __CU_ARRAY_OFFSET(srcs[i]->data, item_size * srcs[i]->length) : srcs[i]->data;
+    }
+    m.tree[0] = __cu_array_merge_k_build(&m, 1);
+
+    // Each item costs one replay from its leaf to the root, `log2(k)` comparisons.
+    CU_UNIT *out = __CU_ARRAY_OFFSET(dst->data, item_size * dst->length);
+    for (size_t n = 0; n < total; n++)
+    {
+        size_t winner = m.tree[0];
+        __cu_array_copy_item(out, m.head[winner], item_size);
+        out = __CU_ARRAY_OFFSET(out, item_size);
+        m.head[winner] = __CU_ARRAY_OFFSET(m.head[winner], item_size);
+        for (size_t node = (winner + k) / 2u; node > 0u; node /= 2u)
+        {
+            if (__cu_array_merge_k_beats(&m, m.tree[node], winner))
+            {
+                size_t tmp = m.tree[node];
+                m.tree[node] = winner;
+                winner = tmp;
+            }
+        }
+        m.tree[0] = winner;
+    }
+    dst->length += total;
+    __CU_ARRAY_STATS_LENGTH(dst);
+
+    __cu_array_free(dst, m.head, k * node_size);
     return 0;
 }
 
-CU_API int cu_array_remove_at(cu_array_t *arr, size_t pos)
+CU_API size_t __cu_array_search(cu_array_t *arr, void *key, int (*compare)(void *, void *), int upper)
+{
+    if (arr == NULL || arr->item_size == 0u || key == NULL || compare == NULL || arr->length == 0u)
+    {
+        return 0;
+    }
+
+    // Halve the range a fixed number of times instead of stopping on a match,
+    // the only branch left is the comparator itself.
+    size_t item_size = arr->item_size;
+    size_t lo = 0;
+    size_t len = arr->length;
+    while (len > 1u)
+    {
+        size_t half = len / 2u;
+        int c = compare(key, __CU_ARRAY_OFFSET(arr->data, item_size * (lo + half - 1u)));
+        lo += (upper ? c >= 0 : c > 0) ? half : 0u;
+        len -= half;
+    }
+    int c = compare(key, __CU_ARRAY_OFFSET(arr->data, item_size * lo));
+    return lo + (size_t)(upper ? c >= 0 : c > 0);
+}
+
+CU_API size_t cu_array_lower_bound(cu_array_t *arr, void *key, int (*compare)(void *, void *))
+{
+    return __cu_array_search(arr, key, compare, 0);
+}
+
+CU_API size_t cu_array_upper_bound(cu_array_t *arr, void *key, int (*compare)(void *, void *))
+{
+    return __cu_array_search(arr, key, compare, 1);
+}
+
+CU_API CU_UNIT *cu_array_bsearch(cu_array_t *arr, void *key, int (*compare)(void *, void *))
+{
+    size_t pos = __cu_array_search(arr, key, compare, 0);
+    if (arr == NULL || pos >= arr->length)
+    {
+        return NULL;
+    }
+    CU_UNIT *item = __CU_ARRAY_OFFSET(arr->data, arr->item_size * pos);
+    return compare(key, item) == 0 ? item : NULL;
+}
+
+CU_API int cu_array_insert_sorted(cu_array_t *arr, void *item, int (*compare)(void *, void *))
 {
-    if (arr == NULL || arr->data == NULL || arr->capacity == 0u || pos >= arr->length)
+    if (arr == NULL || arr->item_size == 0u || item == NULL || compare == NULL)
     {
         return 1;
     }
+    return cu_array_insert(arr, item, __cu_array_search(arr, item, compare, 1));
+}
 
-    cu_memmove(cu_array_at(arr, pos), cu_array_at(arr, pos + 1), (arr->length - pos) * arr->item_size);
-    arr->length -= 1;
+CU_API void __cu_array_eytzinger_fill(cu_array_t *arr, const CU_UNIT *sorted, size_t *next, size_t k)
+{
+    // In-order walk of the implicit tree (1-based `k`), the depth is at most log2(length).
+    if (k > arr->length)
+    {
+        return;
+    }
+    __cu_array_eytzinger_fill(arr, sorted, next, 2u * k);
+    __cu_array_copy_item(__CU_ARRAY_OFFSET(arr->data, arr->item_size * (k - 1u)), __CU_ARRAY_OFFSET(sorted, arr->item_size * *next), arr->item_size);
+    *next += 1u;
+    __cu_array_eytzinger_fill(arr, sorted, next, 2u * k + 1u);
+}
+
+CU_API int cu_array_eytzinger_build(cu_array_t *arr)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+    if (arr->length < 2u)
+    {
+        return 0;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    CU_UNIT *sorted = (CU_UNIT *)__cu_array_alloc(arr, arr->item_size * arr->length);
+    if (sorted == NULL)
+    {
+        return 1;
+    }
+    cu_memcpy(sorted, arr->data, arr->item_size * arr->length);
+    size_t next = 0;
+    __cu_array_eytzinger_fill(arr, sorted, &next, 1u);
+    __cu_array_free(arr, sorted, arr->item_size * arr->length);
     return 0;
 }
 
-CU_API int cu_array_clear(cu_array_t *arr)
+CU_API size_t cu_array_eytzinger_lower_bound(cu_array_t *arr, void *key, int (*compare)(void *, void *))
 {
-    if (arr == NULL)
+    if (arr == NULL || arr->item_size == 0u || key == NULL || compare == NULL)
+    {
+        return arr == NULL ? 0 : arr->length;
+    }
+
+    size_t item_size = arr->item_size;
+    size_t len = arr->length;
+    size_t k = 1;
+    while (k <= len)
+    {
+        // The 16 descendants four levels down are contiguous, for small items that's one cache line.
+        if (16u * k <= len)
+        {
+            CU_ARRAY_PREFETCH(__CU_ARRAY_OFFSET(arr->data, item_size * (16u * k - 1u)));
+        }
+        k = 2u * k + (size_t)(compare(key, __CU_ARRAY_OFFSET(arr->data, item_size * (k - 1u))) > 0);
+    }
+    // Undo the right turns made after the last left turn, that node is the answer.
+    while (k & 1u)
+    {
+        k >>= 1;
+    }
+    k >>= 1;
+    return k == 0u ? len : k - 1u;
+}
+
+CU_API CU_UNIT *cu_array_eytzinger_search(cu_array_t *arr, void *key, int (*compare)(void *, void *))
+{
+    size_t pos = cu_array_eytzinger_lower_bound(arr, key, compare);
+    if (arr == NULL || pos >= arr->length)
+    {
+        return NULL;
+    }
+    CU_UNIT *item = __CU_ARRAY_OFFSET(arr->data, arr->item_size * pos);
+    return compare(key, item) == 0 ? item : NULL;
+}
+
+CU_API cu_array_view_t cu_array_view(cu_array_t *arr)
+{
+    cu_array_view_t view = {0};
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return view;
+    }
+    view.data = arr->data;
+    view.length = arr->length;
+    view.item_size = arr->item_size;
+    view.flags = arr->flags & CU_ARRAY_READONLY;
+    return view;
+}
+
+CU_API int cu_array_slice(cu_array_t *arr, size_t pos, size_t len, cu_array_view_t *out)
+{
+    if (arr == NULL || arr->item_size == 0u)
     {
         return 1;
     }
-    arr->length = 0;
+    return cu_array_view_slice(cu_array_view(arr), pos, len, out);
+}
+
+CU_API int cu_array_view_slice(cu_array_view_t view, size_t pos, size_t len, cu_array_view_t *out)
+{
+    if (out == NULL || view.item_size == 0u || pos > view.length || len > view.length - pos)
+    {
+        return 1;
+    }
+    out->data = len != 0u ? __CU_ARRAY_OFFSET(view.data, view.item_size * pos) : NULL;
+    out->length = len;
+    out->item_size = view.item_size;
+    out->flags = view.flags & CU_ARRAY_READONLY;
     return 0;
 }
 
-CU_API int cu_array_qsort(cu_array_t *arr, int (*compare)(void *, void *))
+CU_API CU_UNIT *cu_array_view_at(cu_array_view_t view, size_t pos)
+{
+    if (view.data == NULL || pos >= view.length)
+    {
+        return NULL;
+    }
+    return __CU_ARRAY_OFFSET(view.data, view.item_size * pos);
+}
+
+CU_API int cu_array_from_view(cu_array_t *arr, cu_array_view_t view)
+{
+    if (arr == NULL || view.item_size == 0u || (view.data == NULL && view.length != 0u))
+    {
+        return 1;
+    }
+    if (view.length == 0u)
+    {
+        return cu_array_init(arr, view.item_size);
+    }
+    if (cu_array_init_with_buffer(arr, view.item_size, view.data, view.length) != 0)
+    {
+        return 1;
+    }
+    arr->length = view.length;
+    arr->flags |= view.flags & CU_ARRAY_READONLY;
+    return 0;
+}
+
+CU_API int cu_array_view_qsort(cu_array_view_t view, int (*compare)(void *, void *))
 {
-    if (arr == NULL || arr->data == NULL || arr->capacity == 0u)
+    if (view.item_size == 0u || compare == NULL || (view.data == NULL && view.length != 0u) || (view.flags & CU_ARRAY_READONLY))
     {
         return 1;
     }
-    __cu_array_qsort_internal(arr->data, arr->item_size, arr->length, compare);
+    __cu_array_compare_wrapper_t wrapper = {compare};
+    __cu_array_qsort_internal(view.data, view.item_size, view.length, __cu_array_compare_wrapped, &wrapper);
     return 0;
 }
 
+CU_API size_t cu_array_view_lower_bound(cu_array_view_t view, void *key, int (*compare)(void *, void *))
+{
+    cu_array_t arr = {0};
+    if (cu_array_from_view(&arr, view) != 0)
+    {
+        return 0;
+    }
+    return cu_array_lower_bound(&arr, key, compare);
+}
+
+CU_API CU_UNIT *cu_array_view_bsearch(cu_array_view_t view, void *key, int (*compare)(void *, void *))
+{
+    cu_array_t arr = {0};
+    if (cu_array_from_view(&arr, view) != 0)
+    {
+        return NULL;
+    }
+    return cu_array_bsearch(&arr, key, compare);
+}
+
 CU_API int cu_compare_int(void *a, void *b)
 {
-    return (*(int *)a - *(int *)b);
+    // Not `a - b`, that overflows for keys far apart.
+    int x = *(int *)a;
+    int y = *(int *)b;
+    return (x > y) - (x < y);
 }
 
-#endif //  CU_ARRAY_IMPL
\ No newline at end of file
+#endif // defined(CU_ARRAY_IMPL) && !defined(CU_ARRAY_IMPL_INCLUDED)
\ No newline at end of file
@@ -0,0 +1,983 @@
+/// @file cu_array_simd.h
+/// @brief Vectorized search and reduction kernels for `cu_array_t`s of numbers.
+///
+/// The kernels work directly on `arr->data`, the lane width is `arr->item_size` and the
+/// element type is picked with `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED` or `CU_SIMD_FLOAT`:
+/// ```C
+/// cu_array_t arr = {0};
+/// cu_array_init(&arr, sizeof(int32_t));
+/// ...
+/// int32_t needle = 42;
+/// size_t pos = cu_array_simd_find(&arr, &needle, CU_SIMD_SIGNED);
+/// int64_t total = 0;
+/// cu_array_simd_sum(&arr, &total, CU_SIMD_SIGNED);
+/// ```
+///
+/// To run a kernel on a slice, wrap a `cu_array_view_t` without copying it:
+/// ```C
+/// cu_array_view_t view;
+/// cu_array_slice(&arr, 100, 50, &view);
+/// cu_array_t slice = {0};
+/// cu_array_from_view(&slice, view);
+/// size_t count = cu_array_simd_count_eq(&slice, &needle, CU_SIMD_SIGNED);
+/// ```
+///
+/// The backend is picked at compile time: AVX2 if `__AVX2__` is defined (e.g. `-mavx2` or `-march=native`),
+/// else SSE2 on x86, else NEON on ARM, else (or with `CU_ARRAY_SIMD_SCALAR`) plain C loops.
+/// 8, 16 and 32-bit `find`/`count_eq`/`eq_mask` and 32-bit `min`/`max`/`sum` are vectorized, the other widths
+/// use the scalar loops, which compilers can still auto-vectorize.
+///
+/// `cu_array_simd_eq_mask()` stores the comparison results in a `cu_bitset_t` (one bit per item) instead of
+/// reducing them, so selections can be combined with `cu_bitset_and()` & co. and applied with `cu_bitset_retain()`.
+/// The translation unit with `CU_ARRAY_SIMD_IMPL` also needs the `cu_bitset.h` functions (`CU_BITSET_IMPL`).
+///
+/// To include function implementations, define:
+///     #define CU_ARRAY_SIMD_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_array_simd_find()`
+/// - `cu_array_simd_count_eq()`
+/// - `cu_array_simd_eq_mask()`
+/// - `cu_array_simd_min()`
+/// - `cu_array_simd_max()`
+/// - `cu_array_simd_sum()`
+/// - `cu_array_simd_backend()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_ARRAY_SIMD_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+/// @def CU_ARRAY_SIMD_SCALAR
+/// @brief Disables the SIMD backends, every kernel uses the plain C loops.
+
+#ifndef CU_ARRAY_SIMD_H
+#define CU_ARRAY_SIMD_H
+
+#include "cu_array.h"
+#include "cu_bitset.h"
+
+/// @brief Items are unsigned integers of `item_size` `1`, `2`, `4` or `8` bytes.
+#define CU_SIMD_UNSIGNED (0u)
+/// @brief Items are two's complement signed integers of `item_size` `1`, `2`, `4` or `8` bytes.
+#define CU_SIMD_SIGNED (1u)
+/// @brief Items are `float` (`item_size` `4`) or `double` (`item_size` `8`).
+#define CU_SIMD_FLOAT (2u)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Finds the first item equal to `*value`.
+    /// @note Integers are compared bitwise, floats with `==` (so `-0.0 == 0.0` and `NaN` is never found).
+    /// @param arr Pointer to the array.
+    /// @param value Pointer to a value of the item type.
+    /// @param type One of `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED`, `CU_SIMD_FLOAT`.
+    /// @return Index of the item, `arr->length` if not found or on error.
+    CU_API size_t cu_array_simd_find(cu_array_t *arr, const void *value, unsigned int type);
+
+    /// @brief Counts the items equal to `*value`, compared the same way as in `cu_array_simd_find`.
+    /// @param arr Pointer to the array.
+    /// @param value Pointer to a value of the item type.
+    /// @param type One of `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED`, `CU_SIMD_FLOAT`.
+    /// @return Number of equal items, `0` on error.
+    CU_API size_t cu_array_simd_count_eq(cu_array_t *arr, const void *value, unsigned int type);
+
+    /// @brief Replaces the bits of `out` with one bit per item, set where the item equals `*value`.
+    /// @note Compared the same way as in `cu_array_simd_find`. The vector kernels build a whole 64-bit word
+    ///       from a few compare + movemask steps, so no per-item branch or store is needed.
+    /// @param arr Pointer to the array.
+    /// @param value Pointer to a value of the item type.
+    /// @param type One of `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED`, `CU_SIMD_FLOAT`.
+    /// @param out Pointer to an initialized bitset, resized to `arr->length` bits.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_simd_eq_mask(cu_array_t *arr, const void *value, unsigned int type, cu_bitset_t *out);
+
+    /// @brief Finds the smallest item.
+    /// @note The result is unspecified if a float array contains `NaN`.
+    /// @param arr Pointer to a non-empty array.
+    /// @param out Pointer to a value of the item type, receives the smallest item.
+    /// @param type One of `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED`, `CU_SIMD_FLOAT`.
+    /// @return `0` on success, `1` on error (e.g. empty array).
+    CU_API int cu_array_simd_min(cu_array_t *arr, void *out, unsigned int type);
+
+    /// @brief Finds the largest item.
+    /// @note The result is unspecified if a float array contains `NaN`.
+    /// @param arr Pointer to a non-empty array.
+    /// @param out Pointer to a value of the item type, receives the largest item.
+    /// @param type One of `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED`, `CU_SIMD_FLOAT`.
+    /// @return `0` on success, `1` on error (e.g. empty array).
+    CU_API int cu_array_simd_max(cu_array_t *arr, void *out, unsigned int type);
+
+    /// @brief Adds up every item.
+    /// @note Integers are added modulo 2^64. Floats are added in `double` precision, but in a different
+    ///       order than a plain loop, so the result can differ from it in the last bits.
+    /// @param arr Pointer to the array.
+    /// @param out Pointer to an `uint64_t` (`CU_SIMD_UNSIGNED`), `int64_t` (`CU_SIMD_SIGNED`) or `double` (`CU_SIMD_FLOAT`).
+    /// @param type One of `CU_SIMD_UNSIGNED`, `CU_SIMD_SIGNED`, `CU_SIMD_FLOAT`.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_array_simd_sum(cu_array_t *arr, void *out, unsigned int type);
+
+    /// @brief Returns the name of the compiled-in backend: `"avx2"`, `"sse2"`, `"neon"` or `"scalar"`.
+    CU_API const char *cu_array_simd_backend(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_ARRAY_SIMD_H
+
+#ifdef CU_ARRAY_SIMD_IMPL
+
+#if !defined(CU_ARRAY_SIMD_SCALAR)
+#if defined(__AVX2__)
+#define __CU_ARRAY_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define __CU_ARRAY_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define __CU_ARRAY_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif // !defined(CU_ARRAY_SIMD_SCALAR)
+
+// Definitions
+
+// Helper functions, not "public"
+
+enum
+{
+    __CU_SIMD_INVALID,
+    __CU_SIMD_U8,
+    __CU_SIMD_I8,
+    __CU_SIMD_U16,
+    __CU_SIMD_I16,
+    __CU_SIMD_U32,
+    __CU_SIMD_I32,
+    __CU_SIMD_U64,
+    __CU_SIMD_I64,
+    __CU_SIMD_F32,
+    __CU_SIMD_F64
+};
+
+CU_API int __cu_array_simd_kind(const cu_array_t *arr, unsigned int type)
+{
+    if (arr == NULL || arr->item_size == 0u || (arr->length != 0u && arr->data == NULL) || type > CU_SIMD_FLOAT)
+    {
+        return __CU_SIMD_INVALID;
+    }
+    int is_signed = type == CU_SIMD_SIGNED;
+    switch (arr->item_size)
+    {
+    case 1u:
+        return type == CU_SIMD_FLOAT ? __CU_SIMD_INVALID : (is_signed ? __CU_SIMD_I8 : __CU_SIMD_U8);
+    case 2u:
+        return type == CU_SIMD_FLOAT ? __CU_SIMD_INVALID : (is_signed ? __CU_SIMD_I16 : __CU_SIMD_U16);
+    case 4u:
+        return type == CU_SIMD_FLOAT ? (sizeof(float) == 4u ? __CU_SIMD_F32 : __CU_SIMD_INVALID)
+                                     : (is_signed ? __CU_SIMD_I32 : __CU_SIMD_U32);
+    case 8u:
+        return type == CU_SIMD_FLOAT ? (sizeof(double) == 8u ? __CU_SIMD_F64 : __CU_SIMD_INVALID)
+                                     : (is_signed ? __CU_SIMD_I64 : __CU_SIMD_U64);
+    default:
+        return __CU_SIMD_INVALID;
+    }
+}
+
+CU_API int64_t __cu_array_simd_to_signed(uint64_t x)
+{
+    // Two's complement reinterpretation, without relying on the implementation-defined conversion.
+    return x > (uint64_t)INT64_MAX ? -(int64_t)(~x) - 1 : (int64_t)x;
+}
+
+// Scalar kernels, they also finish the tails the vector kernels leave behind.
+// `start` is where to begin, `acc` the result so far.
+#define __CU_ARRAY_SIMD_SCALAR(S, T, SUM_T)                                                        \
+    CU_API size_t __cu_array_simd_find_##S(const T *data, size_t start, size_t len, T value)      \
+    {                                                                                              \
+        for (size_t i = start; i < len; i++)                                                       \
+        {                                                                                          \
+            if (data[i] == value)                                                                  \
+            {                                                                                      \
+                return i;                                                                          \
+            }                                                                                      \
+        }                                                                                          \
+        return len;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    CU_API size_t __cu_array_simd_count_##S(const T *data, size_t start, size_t len, T value)     \
+    {                                                                                              \
+        size_t count = 0;                                                                          \
+        for (size_t i = start; i < len; i++)                                                       \
+        {                                                                                          \
+            count += (size_t)(data[i] == value);                                                   \
+        }                                                                                          \
+        return count;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    CU_API void __cu_array_simd_mask_##S(const T *data, size_t start, size_t len, T value, uint64_t *words) \
+    {                                                                                              \
+        for (size_t i = start; i < len; i++)                                                       \
+        {                                                                                          \
+            words[i / 64u] |= (uint64_t)(data[i] == value) << (i % 64u);                           \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    CU_API T __cu_array_simd_min_##S(const T *data, size_t start, size_t len, T acc)              \
+    {                                                                                              \
+        for (size_t i = start; i < len; i++)                                                       \
+        {                                                                                          \
+            acc = data[i] < acc ? data[i] : acc;                                                   \
+        }                                                                                          \
+        return acc;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    CU_API T __cu_array_simd_max_##S(const T *data, size_t start, size_t len, T acc)              \
+    {                                                                                              \
+        for (size_t i = start; i < len; i++)                                                       \
+        {                                                                                          \
+            acc = data[i] > acc ? data[i] : acc;                                                   \
+        }                                                                                          \
+        return acc;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    CU_API SUM_T __cu_array_simd_sum_##S(const T *data, size_t start, size_t len, SUM_T acc)      \
+    {                                                                                              \
+        for (size_t i = start; i < len; i++)                                                       \
+        {                                                                                          \
+            acc += (SUM_T)data[i];                                                                 \
+        }                                                                                          \
+        return acc;                                                                                \
+    }
+
+// Signed items are summed as `uint64_t` too, converting a negative value to it sign-extends modulo 2^64.
+__CU_ARRAY_SIMD_SCALAR(u8, uint8_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(i8, int8_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(u16, uint16_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(i16, int16_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(u32, uint32_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(i32, int32_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(u64, uint64_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(i64, int64_t, uint64_t)
+__CU_ARRAY_SIMD_SCALAR(f32, float, double)
+__CU_ARRAY_SIMD_SCALAR(f64, double, double)
+
+// Vector kernels. Each one handles a prefix of whole vectors and returns its length,
+// the scalar kernels take it from there:
+// - `vfind` stops at the first vector with a match (or the last whole vector),
+// - `vcount` adds the matches to `*count`,
+// - `vmask` stores whole 64-item words of matches in `words` (the prefix is a multiple of 64),
+// - `vmin`/`vmax` store the result of the prefix in `*out` (only if the prefix isn't empty),
+// - `vsum` adds the prefix to `*acc`.
+
+#define __CU_ARRAY_SIMD_NONE(data, len, x) ((void)(data), (void)(len), (void)(x), (size_t)0)
+#define __CU_ARRAY_SIMD_NONE_COUNT(data, len, value, count) ((void)(data), (void)(len), (void)(value), (void)(count), (size_t)0)
+
+#if defined(__CU_ARRAY_SIMD_SSE2) || defined(__CU_ARRAY_SIMD_AVX2)
+
+#ifdef __CU_ARRAY_SIMD_AVX2
+#define __CU_SIMD_VEC __m256i
+#define __CU_SIMD_BYTES (32u)
+#define __CU_SIMD_LOAD(p) _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#define __CU_SIMD_STORE(p, v) _mm256_storeu_si256((__m256i *)(void *)(p), (v))
+#define __CU_SIMD_ZERO() _mm256_setzero_si256()
+#define __CU_SIMD_MOVEMASK(v) _mm256_movemask_epi8(v)
+#define __CU_SIMD_SET1_8(x) _mm256_set1_epi8((char)(x))
+#define __CU_SIMD_SET1_16(x) _mm256_set1_epi16((short)(x))
+#define __CU_SIMD_SET1_32(x) _mm256_set1_epi32((int)(x))
+#define __CU_SIMD_SET1_F32(x) _mm256_castps_si256(_mm256_set1_ps(x))
+#define __CU_SIMD_CMPEQ_8(a, b) _mm256_cmpeq_epi8((a), (b))
+#define __CU_SIMD_CMPEQ_16(a, b) _mm256_cmpeq_epi16((a), (b))
+#define __CU_SIMD_CMPEQ_32(a, b) _mm256_cmpeq_epi32((a), (b))
+#define __CU_SIMD_CMPEQ_F32(a, b) \
+    _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ))
+// One bit per 32-bit lane, and two 16-bit compares narrowed to bytes (packs works per 128-bit half).
+#define __CU_SIMD_MOVEMASK_32(v) _mm256_movemask_ps(_mm256_castsi256_ps(v))
+#define __CU_SIMD_PACK_16(a, b) _mm256_permute4x64_epi64(_mm256_packs_epi16((a), (b)), 0xD8)
+#define __CU_SIMD_SUB_8(a, b) _mm256_sub_epi8((a), (b))
+#define __CU_SIMD_SUB_16(a, b) _mm256_sub_epi16((a), (b))
+#define __CU_SIMD_SUB_32(a, b) _mm256_sub_epi32((a), (b))
+#define __CU_SIMD_MIN_I32(a, b) _mm256_min_epi32((a), (b))
+#define __CU_SIMD_MAX_I32(a, b) _mm256_max_epi32((a), (b))
+#define __CU_SIMD_MIN_U32(a, b) _mm256_min_epu32((a), (b))
+#define __CU_SIMD_MAX_U32(a, b) _mm256_max_epu32((a), (b))
+#define __CU_SIMD_MIN_F32(a, b) _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)))
+#define __CU_SIMD_MAX_F32(a, b) _mm256_castps_si256(_mm256_max_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)))
+#else
+#define __CU_SIMD_VEC __m128i
+#define __CU_SIMD_BYTES (16u)
+#define __CU_SIMD_LOAD(p) _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define __CU_SIMD_STORE(p, v) _mm_storeu_si128((__m128i *)(void *)(p), (v))
+#define __CU_SIMD_ZERO() _mm_setzero_si128()
+#define __CU_SIMD_MOVEMASK(v) _mm_movemask_epi8(v)
+#define __CU_SIMD_SET1_8(x) _mm_set1_epi8((char)(x))
+#define __CU_SIMD_SET1_16(x) _mm_set1_epi16((short)(x))
+#define __CU_SIMD_SET1_32(x) _mm_set1_epi32((int)(x))
+#define __CU_SIMD_SET1_F32(x) _mm_castps_si128(_mm_set1_ps(x))
+#define __CU_SIMD_CMPEQ_8(a, b) _mm_cmpeq_epi8((a), (b))
+#define __CU_SIMD_CMPEQ_16(a, b) _mm_cmpeq_epi16((a), (b))
+#define __CU_SIMD_CMPEQ_32(a, b) _mm_cmpeq_epi32((a), (b))
+#define __CU_SIMD_CMPEQ_F32(a, b) _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+#define __CU_SIMD_MOVEMASK_32(v) _mm_movemask_ps(_mm_castsi128_ps(v))
+#define __CU_SIMD_PACK_16(a, b) _mm_packs_epi16((a), (b))
+#define __CU_SIMD_SUB_8(a, b) _mm_sub_epi8((a), (b))
+#define __CU_SIMD_SUB_16(a, b) _mm_sub_epi16((a), (b))
+#define __CU_SIMD_SUB_32(a, b) _mm_sub_epi32((a), (b))
+#define __CU_SIMD_MIN_I32(a, b) __cu_array_simd_sse2_select_i32((a), (b), 0)
+#define __CU_SIMD_MAX_I32(a, b) __cu_array_simd_sse2_select_i32((a), (b), 1)
+#define __CU_SIMD_MIN_U32(a, b) __cu_array_simd_sse2_select_u32((a), (b), 0)
+#define __CU_SIMD_MAX_U32(a, b) __cu_array_simd_sse2_select_u32((a), (b), 1)
+#define __CU_SIMD_MIN_F32(a, b) _mm_castps_si128(_mm_min_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+#define __CU_SIMD_MAX_F32(a, b) _mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+
+// SSE2 has no 32-bit min/max, pick the lanes with a compare mask instead.
+CU_API __m128i __cu_array_simd_sse2_select_i32(__m128i a, __m128i b, int want_max)
+{
+    __m128i a_greater = _mm_cmpgt_epi32(a, b);
+    __m128i keep_a = want_max ? a_greater : _mm_xor_si128(a_greater, _mm_set1_epi32(-1));
+    return _mm_or_si128(_mm_and_si128(keep_a, a), _mm_andnot_si128(keep_a, b));
+}
+
+CU_API __m128i __cu_array_simd_sse2_select_u32(__m128i a, __m128i b, int want_max)
+{
+    // Flipping the sign bit maps unsigned order onto signed order.
+    __m128i bias = _mm_set1_epi32(INT32_MIN);
+    __m128i a_greater = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+    __m128i keep_a = want_max ? a_greater : _mm_xor_si128(a_greater, _mm_set1_epi32(-1));
+    return _mm_or_si128(_mm_and_si128(keep_a, a), _mm_andnot_si128(keep_a, b));
+}
+#endif // __CU_ARRAY_SIMD_AVX2
+
+#define __CU_ARRAY_SIMD_X86_EQ(S, T, SET1, CMPEQ, SUB, LANE_T)                                     \
+    CU_API size_t __cu_array_simd_vfind_##S(const T *data, size_t len, T value)                   \
+    {                                                                                              \
+        const size_t lanes = __CU_SIMD_BYTES / sizeof(T);                                          \
+        __CU_SIMD_VEC v = SET1(value);                                                             \
+        size_t i = 0;                                                                              \
+        for (; i + lanes <= len; i += lanes)                                                       \
+        {                                                                                          \
+            if (__CU_SIMD_MOVEMASK(CMPEQ(__CU_SIMD_LOAD(data + i), v)) != 0)                       \
+            {                                                                                      \
+                break;                                                                             \
+            }                                                                                      \
+        }                                                                                          \
+        return i;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    CU_API size_t __cu_array_simd_vcount_##S(const T *data, size_t len, T value, size_t *count)   \
+    {                                                                                              \
+        const size_t lanes = __CU_SIMD_BYTES / sizeof(T);                                          \
+        __CU_SIMD_VEC v = SET1(value);                                                             \
+        size_t i = 0;                                                                              \
+        while (i + lanes <= len)                                                                   \
+        {                                                                                          \
+            /* A match is -1, subtracting it counts up. 255 rounds at most, so 8-bit lanes can't overflow. */ \
+            __CU_SIMD_VEC acc = __CU_SIMD_ZERO();                                                  \
+            for (size_t round = 0; round < 255u && i + lanes <= len; round++, i += lanes)          \
+            {                                                                                      \
+                acc = SUB(acc, CMPEQ(__CU_SIMD_LOAD(data + i), v));                                \
+            }                                                                                      \
+            LANE_T counts[__CU_SIMD_BYTES / sizeof(LANE_T)];                                       \
+            __CU_SIMD_STORE(counts, acc);                                                          \
+            for (size_t l = 0; l < __CU_SIMD_BYTES / sizeof(LANE_T); l++)                          \
+            {                                                                                      \
+                *count += counts[l];                                                               \
+            }                                                                                      \
+        }                                                                                          \
+        return i;                                                                                  \
+    }
+
+// `MOVEMASK` gives one bit per lane, so a word takes 64 / lanes steps.
+#define __CU_ARRAY_SIMD_X86_MASK(S, T, SET1, CMPEQ, MOVEMASK)                                      \
+    CU_API size_t __cu_array_simd_vmask_##S(const T *data, size_t len, T value, uint64_t *words)  \
+    {                                                                                              \
+        const size_t lanes = __CU_SIMD_BYTES / sizeof(T);                                          \
+        __CU_SIMD_VEC v = SET1(value);                                                             \
+        size_t i = 0;                                                                              \
+        for (; i + 64u <= len; i += 64u)                                                           \
+        {                                                                                          \
+            uint64_t word = 0;                                                                     \
+            for (size_t j = 0; j < 64u; j += lanes)                                               \
+            {                                                                                      \
+                word |= (uint64_t)(uint32_t)MOVEMASK(CMPEQ(__CU_SIMD_LOAD(data + i + j), v)) << j;  \
+            }                                                                                      \
+            words[i / 64u] = word;                                                                 \
+        }                                                                                          \
+        return i;                                                                                  \
+    }
+
+#define __CU_ARRAY_SIMD_X86_MINMAX(NAME, S, T, OP)                                                 \
+    CU_API size_t __cu_array_simd_v##NAME##_##S(const T *data, size_t len, T *out)                \
+    {                                                                                              \
+        const size_t lanes = __CU_SIMD_BYTES / sizeof(T);                                          \
+        if (len < lanes)                                                                           \
+        {                                                                                          \
+            return 0;                                                                              \
+        }                                                                                          \
+        __CU_SIMD_VEC acc = __CU_SIMD_LOAD(data);                                                  \
+        size_t i = lanes;                                                                          \
+        for (; i + lanes <= len; i += lanes)                                                       \
+        {                                                                                          \
+            acc = OP(acc, __CU_SIMD_LOAD(data + i));                                               \
+        }                                                                                          \
+        T partial[__CU_SIMD_BYTES / sizeof(T)];                                                    \
+        __CU_SIMD_STORE(partial, acc);                                                             \
+        *out = __cu_array_simd_##NAME##_##S(partial, 1u, lanes, partial[0]);                       \
+        return i;                                                                                  \
+    }
+
+__CU_ARRAY_SIMD_X86_EQ(u8, uint8_t, __CU_SIMD_SET1_8, __CU_SIMD_CMPEQ_8, __CU_SIMD_SUB_8, uint8_t)
+__CU_ARRAY_SIMD_X86_EQ(u16, uint16_t, __CU_SIMD_SET1_16, __CU_SIMD_CMPEQ_16, __CU_SIMD_SUB_16, uint16_t)
+__CU_ARRAY_SIMD_X86_EQ(u32, uint32_t, __CU_SIMD_SET1_32, __CU_SIMD_CMPEQ_32, __CU_SIMD_SUB_32, uint32_t)
+__CU_ARRAY_SIMD_X86_EQ(f32, float, __CU_SIMD_SET1_F32, __CU_SIMD_CMPEQ_F32, __CU_SIMD_SUB_32, uint32_t)
+__CU_ARRAY_SIMD_X86_MASK(u8, uint8_t, __CU_SIMD_SET1_8, __CU_SIMD_CMPEQ_8, __CU_SIMD_MOVEMASK)
+__CU_ARRAY_SIMD_X86_MASK(u32, uint32_t, __CU_SIMD_SET1_32, __CU_SIMD_CMPEQ_32, __CU_SIMD_MOVEMASK_32)
+__CU_ARRAY_SIMD_X86_MASK(f32, float, __CU_SIMD_SET1_F32, __CU_SIMD_CMPEQ_F32, __CU_SIMD_MOVEMASK_32)
+__CU_ARRAY_SIMD_X86_MINMAX(min, i32, int32_t, __CU_SIMD_MIN_I32)
+__CU_ARRAY_SIMD_X86_MINMAX(max, i32, int32_t, __CU_SIMD_MAX_I32)
+__CU_ARRAY_SIMD_X86_MINMAX(min, u32, uint32_t, __CU_SIMD_MIN_U32)
+__CU_ARRAY_SIMD_X86_MINMAX(max, u32, uint32_t, __CU_SIMD_MAX_U32)
+__CU_ARRAY_SIMD_X86_MINMAX(min, f32, float, __CU_SIMD_MIN_F32)
+__CU_ARRAY_SIMD_X86_MINMAX(max, f32, float, __CU_SIMD_MAX_F32)
+
+CU_API size_t __cu_array_simd_vmask_u16(const uint16_t *data, size_t len, uint16_t value, uint64_t *words)
+{
+    // There is no 16-bit movemask, two compares are narrowed into one vector of bytes first.
+    const size_t lanes = __CU_SIMD_BYTES / sizeof(uint16_t);
+    __CU_SIMD_VEC v = __CU_SIMD_SET1_16(value);
+    size_t i = 0;
+    for (; i + 64u <= len; i += 64u)
+    {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64u; j += 2u * lanes)
+        {
+            __CU_SIMD_VEC lo = __CU_SIMD_CMPEQ_16(__CU_SIMD_LOAD(data + i + j), v);
+            __CU_SIMD_VEC hi = __CU_SIMD_CMPEQ_16(__CU_SIMD_LOAD(data + i + j + lanes), v);
+            word |= (uint64_t)(uint32_t)__CU_SIMD_MOVEMASK(__CU_SIMD_PACK_16(lo, hi)) << j;
+        }
+        words[i / 64u] = word;
+    }
+    return i;
+}
+
+#ifdef __CU_ARRAY_SIMD_AVX2
+CU_API size_t __cu_array_simd_vsum_i32(const int32_t *data, size_t len, uint64_t *acc)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8u <= len; i += 8u)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(const void *)(data + i));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    uint64_t partial[4];
+    _mm256_storeu_si256((__m256i *)(void *)partial, sum);
+    *acc += partial[0] + partial[1] + partial[2] + partial[3];
+    return i;
+}
+
+CU_API size_t __cu_array_simd_vsum_u32(const uint32_t *data, size_t len, uint64_t *acc)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8u <= len; i += 8u)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(const void *)(data + i));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(x)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    uint64_t partial[4];
+    _mm256_storeu_si256((__m256i *)(void *)partial, sum);
+    *acc += partial[0] + partial[1] + partial[2] + partial[3];
+    return i;
+}
+
+CU_API size_t __cu_array_simd_vsum_f32(const float *data, size_t len, double *acc)
+{
+    __m256d lo = _mm256_setzero_pd();
+    __m256d hi = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8u <= len; i += 8u)
+    {
+        __m256 x = _mm256_loadu_ps(data + i);
+        lo = _mm256_add_pd(lo, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+        hi = _mm256_add_pd(hi, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+    }
+    double partial[4];
+    _mm256_storeu_pd(partial, _mm256_add_pd(lo, hi));
+    *acc += (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    return i;
+}
+#else
+CU_API size_t __cu_array_simd_vsum_i32(const int32_t *data, size_t len, uint64_t *acc)
+{
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4u <= len; i += 4u)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(data + i));
+        __m128i sign = _mm_srai_epi32(x, 31);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(x, sign));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(x, sign));
+    }
+    uint64_t partial[2];
+    _mm_storeu_si128((__m128i *)(void *)partial, sum);
+    *acc += partial[0] + partial[1];
+    return i;
+}
+
+CU_API size_t __cu_array_simd_vsum_u32(const uint32_t *data, size_t len, uint64_t *acc)
+{
+    __m128i sum = _mm_setzero_si128();
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4u <= len; i += 4u)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(data + i));
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(x, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(x, zero));
+    }
+    uint64_t partial[2];
+    _mm_storeu_si128((__m128i *)(void *)partial, sum);
+    *acc += partial[0] + partial[1];
+    return i;
+}
+
+CU_API size_t __cu_array_simd_vsum_f32(const float *data, size_t len, double *acc)
+{
+    __m128d lo = _mm_setzero_pd();
+    __m128d hi = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4u <= len; i += 4u)
+    {
+        __m128 x = _mm_loadu_ps(data + i);
+        lo = _mm_add_pd(lo, _mm_cvtps_pd(x));
+        hi = _mm_add_pd(hi, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    double partial[2];
+    _mm_storeu_pd(partial, _mm_add_pd(lo, hi));
+    *acc += partial[0] + partial[1];
+    return i;
+}
+#endif // __CU_ARRAY_SIMD_AVX2
+
+#elif defined(__CU_ARRAY_SIMD_NEON)
+
+CU_API int __cu_array_simd_neon_any(uint64x2_t mask)
+{
+    return (vgetq_lane_u64(mask, 0) | vgetq_lane_u64(mask, 1)) != 0u;
+}
+
+#define __CU_ARRAY_SIMD_NEON_EQ(S, T, VEC_T, MASK_T, LOAD, DUP, CEQ, ZERO, SUB, STORE, TO_U64, LANE_T) \
+    CU_API size_t __cu_array_simd_vfind_##S(const T *data, size_t len, T value)                   \
+    {                                                                                              \
+        const size_t lanes = 16u / sizeof(T);                                                      \
+        VEC_T v = DUP(value);                                                                      \
+        size_t i = 0;                                                                              \
+        for (; i + lanes <= len; i += lanes)                                                       \
+        {                                                                                          \
+            if (__cu_array_simd_neon_any(TO_U64(CEQ(LOAD(data + i), v))))                          \
+            {                                                                                      \
+                break;                                                                             \
+            }                                                                                      \
+        }                                                                                          \
+        return i;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    CU_API size_t __cu_array_simd_vcount_##S(const T *data, size_t len, T value, size_t *count)   \
+    {                                                                                              \
+        const size_t lanes = 16u / sizeof(T);                                                      \
+        VEC_T v = DUP(value);                                                                      \
+        size_t i = 0;                                                                              \
+        while (i + lanes <= len)                                                                   \
+        {                                                                                          \
+            /* A match is all ones, subtracting it counts up. 255 rounds at most, so 8-bit lanes can't overflow. */ \
+            MASK_T acc = ZERO;                                                                     \
+            for (size_t round = 0; round < 255u && i + lanes <= len; round++, i += lanes)          \
+            {                                                                                      \
+                acc = SUB(acc, CEQ(LOAD(data + i), v));                                            \
+            }                                                                                      \
+            LANE_T counts[16u / sizeof(LANE_T)];                                                   \
+            STORE(counts, acc);                                                                    \
+            for (size_t l = 0; l < 16u / sizeof(LANE_T); l++)                                      \
+            {                                                                                      \
+                *count += counts[l];                                                               \
+            }                                                                                      \
+        }                                                                                          \
+        return i;                                                                                  \
+    }
+
+#define __CU_ARRAY_SIMD_NEON_MINMAX(NAME, S, T, VEC_T, LOAD, OP, STORE)                            \
+    CU_API size_t __cu_array_simd_v##NAME##_##S(const T *data, size_t len, T *out)                \
+    {                                                                                              \
+        const size_t lanes = 16u / sizeof(T);                                                      \
+        if (len < lanes)                                                                           \
+        {                                                                                          \
+            return 0;                                                                              \
+        }                                                                                          \
+        VEC_T acc = LOAD(data);                                                                    \
+        size_t i = lanes;                                                                          \
+        for (; i + lanes <= len; i += lanes)                                                       \
+        {                                                                                          \
+            acc = OP(acc, LOAD(data + i));                                                         \
+        }                                                                                          \
+        T partial[16u / sizeof(T)];                                                                \
+        STORE(partial, acc);                                                                       \
+        *out = __cu_array_simd_##NAME##_##S(partial, 1u, lanes, partial[0]);                       \
+        return i;                                                                                  \
+    }
+
+__CU_ARRAY_SIMD_NEON_EQ(u8, uint8_t, uint8x16_t, uint8x16_t, vld1q_u8, vdupq_n_u8, vceqq_u8, vdupq_n_u8(0), vsubq_u8, vst1q_u8,
+                        vreinterpretq_u64_u8, uint8_t)
+__CU_ARRAY_SIMD_NEON_EQ(u16, uint16_t, uint16x8_t, uint16x8_t, vld1q_u16, vdupq_n_u16, vceqq_u16, vdupq_n_u16(0), vsubq_u16, vst1q_u16,
+                        vreinterpretq_u64_u16, uint16_t)
+__CU_ARRAY_SIMD_NEON_EQ(u32, uint32_t, uint32x4_t, uint32x4_t, vld1q_u32, vdupq_n_u32, vceqq_u32, vdupq_n_u32(0), vsubq_u32, vst1q_u32,
+                        vreinterpretq_u64_u32, uint32_t)
+__CU_ARRAY_SIMD_NEON_EQ(f32, float, float32x4_t, uint32x4_t, vld1q_f32, vdupq_n_f32, vceqq_f32, vdupq_n_u32(0), vsubq_u32, vst1q_u32,
+                        vreinterpretq_u64_u32, uint32_t)
+// NEON has no movemask, the masks are built by the scalar loop.
+#define __cu_array_simd_vmask_u8 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_u16 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_u32 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_f32 __CU_ARRAY_SIMD_NONE_COUNT
+__CU_ARRAY_SIMD_NEON_MINMAX(min, i32, int32_t, int32x4_t, vld1q_s32, vminq_s32, vst1q_s32)
+__CU_ARRAY_SIMD_NEON_MINMAX(max, i32, int32_t, int32x4_t, vld1q_s32, vmaxq_s32, vst1q_s32)
+__CU_ARRAY_SIMD_NEON_MINMAX(min, u32, uint32_t, uint32x4_t, vld1q_u32, vminq_u32, vst1q_u32)
+__CU_ARRAY_SIMD_NEON_MINMAX(max, u32, uint32_t, uint32x4_t, vld1q_u32, vmaxq_u32, vst1q_u32)
+__CU_ARRAY_SIMD_NEON_MINMAX(min, f32, float, float32x4_t, vld1q_f32, vminq_f32, vst1q_f32)
+__CU_ARRAY_SIMD_NEON_MINMAX(max, f32, float, float32x4_t, vld1q_f32, vmaxq_f32, vst1q_f32)
+
+CU_API size_t __cu_array_simd_vsum_i32(const int32_t *data, size_t len, uint64_t *acc)
+{
+    // Pairwise widening adds, the 64-bit lanes wrap like the scalar sum.
+    int64x2_t sum = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4u <= len; i += 4u)
+    {
+        sum = vpadalq_s32(sum, vld1q_s32(data + i));
+    }
+    uint64x2_t usum = vreinterpretq_u64_s64(sum);
+    *acc += vgetq_lane_u64(usum, 0) + vgetq_lane_u64(usum, 1);
+    return i;
+}
+
+CU_API size_t __cu_array_simd_vsum_u32(const uint32_t *data, size_t len, uint64_t *acc)
+{
+    uint64x2_t sum = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 4u <= len; i += 4u)
+    {
+        sum = vpadalq_u32(sum, vld1q_u32(data + i));
+    }
+    *acc += vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+    return i;
+}
+
+#ifdef __aarch64__
+CU_API size_t __cu_array_simd_vsum_f32(const float *data, size_t len, double *acc)
+{
+    float64x2_t lo = vdupq_n_f64(0.0);
+    float64x2_t hi = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4u <= len; i += 4u)
+    {
+        float32x4_t x = vld1q_f32(data + i);
+        lo = vaddq_f64(lo, vcvt_f64_f32(vget_low_f32(x)));
+        hi = vaddq_f64(hi, vcvt_high_f64_f32(x));
+    }
+    float64x2_t sum = vaddq_f64(lo, hi);
+    *acc += vgetq_lane_f64(sum, 0) + vgetq_lane_f64(sum, 1);
+    return i;
+}
+#else
+// 32-bit ARM has no double lanes.
+#define __cu_array_simd_vsum_f32 __CU_ARRAY_SIMD_NONE
+#endif // __aarch64__
+
+#else
+
+#define __cu_array_simd_vfind_u8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vfind_u16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vfind_u32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vfind_f32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vcount_u8 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vcount_u16 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vcount_u32 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vcount_f32 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_u8 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_u16 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_u32 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_f32 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmin_i32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_i32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_u32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_u32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_f32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_f32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_i32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_u32 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_f32 __CU_ARRAY_SIMD_NONE
+
+#endif // defined(__CU_ARRAY_SIMD_SSE2) || defined(__CU_ARRAY_SIMD_AVX2)
+
+// Kinds without a vector kernel go straight to the scalar one.
+#define __cu_array_simd_vfind_u64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vfind_f64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vcount_u64 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vcount_f64 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_u64 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmask_f64 __CU_ARRAY_SIMD_NONE_COUNT
+#define __cu_array_simd_vmin_u8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_i8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_u16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_i16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_u64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_i64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmin_f64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_u8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_i8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_u16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_i16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_u64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_i64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vmax_f64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_u8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_i8 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_u16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_i16 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_u64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_i64 __CU_ARRAY_SIMD_NONE
+#define __cu_array_simd_vsum_f64 __CU_ARRAY_SIMD_NONE
+
+// One `case` per element type of the public functions.
+#define __CU_ARRAY_SIMD_FIND_CASE(KIND, S, T)                                                      \
+    case KIND:                                                                                     \
+    {                                                                                              \
+        const T *data = (const T *)(const void *)arr->data;                                        \
+        T v = *(const T *)value;                                                                   \
+        return __cu_array_simd_find_##S(data, __cu_array_simd_vfind_##S(data, len, v), len, v);   \
+    }
+
+#define __CU_ARRAY_SIMD_COUNT_CASE(KIND, S, T)                                                     \
+    case KIND:                                                                                     \
+    {                                                                                              \
+        const T *data = (const T *)(const void *)arr->data;                                        \
+        T v = *(const T *)value;                                                                   \
+        size_t count = 0;                                                                          \
+        size_t done = __cu_array_simd_vcount_##S(data, len, v, &count);                            \
+        return count + __cu_array_simd_count_##S(data, done, len, v);                              \
+    }
+
+#define __CU_ARRAY_SIMD_MASK_CASE(KIND, S, T)                                                      \
+    case KIND:                                                                                     \
+    {                                                                                              \
+        const T *data = (const T *)(const void *)arr->data;                                        \
+        T v = *(const T *)value;                                                                   \
+        size_t done = __cu_array_simd_vmask_##S(data, len, v, words);                              \
+        __cu_array_simd_mask_##S(data, done, len, v, words);                                       \
+        return 0;                                                                                  \
+    }
+
+#define __CU_ARRAY_SIMD_MINMAX_CASE(NAME, KIND, S, T)                                              \
+    case KIND:                                                                                     \
+    {                                                                                              \
+        const T *data = (const T *)(const void *)arr->data;                                        \
+        T acc = data[0];                                                                           \
+        size_t done = __cu_array_simd_v##NAME##_##S(data, len, &acc);                              \
+        *(T *)out = __cu_array_simd_##NAME##_##S(data, done, len, acc);                            \
+        return 0;                                                                                  \
+    }
+
+#define __CU_ARRAY_SIMD_SUM_CASE(KIND, S, T, SUM_T, RESULT_T, CONVERT)                             \
+    case KIND:                                                                                     \
+    {                                                                                              \
+        const T *data = (const T *)(const void *)arr->data;                                        \
+        SUM_T acc = 0;                                                                             \
+        size_t done = __cu_array_simd_vsum_##S(data, len, &acc);                                   \
+        *(RESULT_T *)out = CONVERT(__cu_array_simd_sum_##S(data, done, len, acc));                 \
+        return 0;                                                                                  \
+    }
+
+#define __CU_ARRAY_SIMD_SAME(x) (x)
+
+// "Public" function definitions
+
+CU_API size_t cu_array_simd_find(cu_array_t *arr, const void *value, unsigned int type)
+{
+    int kind = __cu_array_simd_kind(arr, type);
+    if (kind == __CU_SIMD_INVALID || value == NULL)
+    {
+        return arr == NULL ? 0 : arr->length;
+    }
+
+    size_t len = arr->length;
+    switch (kind)
+    {
+    // Equality doesn't depend on the sign.
+    case __CU_SIMD_I8:
+        __CU_ARRAY_SIMD_FIND_CASE(__CU_SIMD_U8, u8, uint8_t)
+    case __CU_SIMD_I16:
+        __CU_ARRAY_SIMD_FIND_CASE(__CU_SIMD_U16, u16, uint16_t)
+    case __CU_SIMD_I32:
+        __CU_ARRAY_SIMD_FIND_CASE(__CU_SIMD_U32, u32, uint32_t)
+    case __CU_SIMD_I64:
+        __CU_ARRAY_SIMD_FIND_CASE(__CU_SIMD_U64, u64, uint64_t)
+        __CU_ARRAY_SIMD_FIND_CASE(__CU_SIMD_F32, f32, float)
+        __CU_ARRAY_SIMD_FIND_CASE(__CU_SIMD_F64, f64, double)
+    default:
+        return len;
+    }
+}
+
+CU_API size_t cu_array_simd_count_eq(cu_array_t *arr, const void *value, unsigned int type)
+{
+    int kind = __cu_array_simd_kind(arr, type);
+    if (kind == __CU_SIMD_INVALID || value == NULL)
+    {
+        return 0;
+    }
+
+    size_t len = arr->length;
+    switch (kind)
+    {
+    case __CU_SIMD_I8:
+        __CU_ARRAY_SIMD_COUNT_CASE(__CU_SIMD_U8, u8, uint8_t)
+    case __CU_SIMD_I16:
+        __CU_ARRAY_SIMD_COUNT_CASE(__CU_SIMD_U16, u16, uint16_t)
+    case __CU_SIMD_I32:
+        __CU_ARRAY_SIMD_COUNT_CASE(__CU_SIMD_U32, u32, uint32_t)
+    case __CU_SIMD_I64:
+        __CU_ARRAY_SIMD_COUNT_CASE(__CU_SIMD_U64, u64, uint64_t)
+        __CU_ARRAY_SIMD_COUNT_CASE(__CU_SIMD_F32, f32, float)
+        __CU_ARRAY_SIMD_COUNT_CASE(__CU_SIMD_F64, f64, double)
+    default:
+        return 0;
+    }
+}
+
+CU_API int cu_array_simd_eq_mask(cu_array_t *arr, const void *value, unsigned int type, cu_bitset_t *out)
+{
+    int kind = __cu_array_simd_kind(arr, type);
+    // Clearing first makes every word zero, the scalar tail only sets bits.
+    if (kind == __CU_SIMD_INVALID || value == NULL || cu_bitset_clear(out) != 0 ||
+        cu_bitset_resize(out, arr->length) != 0)
+    {
+        return 1;
+    }
+
+    size_t len = arr->length;
+    uint64_t *words = (uint64_t *)(void *)out->words.data;
+    switch (kind)
+    {
+    case __CU_SIMD_I8:
+        __CU_ARRAY_SIMD_MASK_CASE(__CU_SIMD_U8, u8, uint8_t)
+    case __CU_SIMD_I16:
+        __CU_ARRAY_SIMD_MASK_CASE(__CU_SIMD_U16, u16, uint16_t)
+    case __CU_SIMD_I32:
+        __CU_ARRAY_SIMD_MASK_CASE(__CU_SIMD_U32, u32, uint32_t)
+    case __CU_SIMD_I64:
+        __CU_ARRAY_SIMD_MASK_CASE(__CU_SIMD_U64, u64, uint64_t)
+        __CU_ARRAY_SIMD_MASK_CASE(__CU_SIMD_F32, f32, float)
+        __CU_ARRAY_SIMD_MASK_CASE(__CU_SIMD_F64, f64, double)
+    default:
+        return 1;
+    }
+}
+
+CU_API int cu_array_simd_min(cu_array_t *arr, void *out, unsigned int type)
+{
+    int kind = __cu_array_simd_kind(arr, type);
+    if (kind == __CU_SIMD_INVALID || out == NULL || arr->length == 0u)
+    {
+        return 1;
+    }
+
+    size_t len = arr->length;
+    switch (kind)
+    {
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_U8, u8, uint8_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_I8, i8, int8_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_U16, u16, uint16_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_I16, i16, int16_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_U32, u32, uint32_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_I32, i32, int32_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_U64, u64, uint64_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_I64, i64, int64_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_F32, f32, float)
+        __CU_ARRAY_SIMD_MINMAX_CASE(min, __CU_SIMD_F64, f64, double)
+    default:
+        return 1;
+    }
+}
+
+CU_API int cu_array_simd_max(cu_array_t *arr, void *out, unsigned int type)
+{
+    int kind = __cu_array_simd_kind(arr, type);
+    if (kind == __CU_SIMD_INVALID || out == NULL || arr->length == 0u)
+    {
+        return 1;
+    }
+
+    size_t len = arr->length;
+    switch (kind)
+    {
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_U8, u8, uint8_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_I8, i8, int8_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_U16, u16, uint16_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_I16, i16, int16_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_U32, u32, uint32_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_I32, i32, int32_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_U64, u64, uint64_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_I64, i64, int64_t)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_F32, f32, float)
+        __CU_ARRAY_SIMD_MINMAX_CASE(max, __CU_SIMD_F64, f64, double)
+    default:
+        return 1;
+    }
+}
+
+CU_API int cu_array_simd_sum(cu_array_t *arr, void *out, unsigned int type)
+{
+    int kind = __cu_array_simd_kind(arr, type);
+    if (kind == __CU_SIMD_INVALID || out == NULL)
+    {
+        return 1;
+    }
+
+    size_t len = arr->length;
+    switch (kind)
+    {
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_U8, u8, uint8_t, uint64_t, uint64_t, __CU_ARRAY_SIMD_SAME)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_I8, i8, int8_t, uint64_t, int64_t, __cu_array_simd_to_signed)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_U16, u16, uint16_t, uint64_t, uint64_t, __CU_ARRAY_SIMD_SAME)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_I16, i16, int16_t, uint64_t, int64_t, __cu_array_simd_to_signed)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_U32, u32, uint32_t, uint64_t, uint64_t, __CU_ARRAY_SIMD_SAME)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_I32, i32, int32_t, uint64_t, int64_t, __cu_array_simd_to_signed)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_U64, u64, uint64_t, uint64_t, uint64_t, __CU_ARRAY_SIMD_SAME)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_I64, i64, int64_t, uint64_t, int64_t, __cu_array_simd_to_signed)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_F32, f32, float, double, double, __CU_ARRAY_SIMD_SAME)
+        __CU_ARRAY_SIMD_SUM_CASE(__CU_SIMD_F64, f64, double, double, double, __CU_ARRAY_SIMD_SAME)
+    default:
+        return 1;
+    }
+}
+
+CU_API const char *cu_array_simd_backend(void)
+{
+#if defined(__CU_ARRAY_SIMD_AVX2)
+    return "avx2";
+#elif defined(__CU_ARRAY_SIMD_SSE2)
+    return "sse2";
+#elif defined(__CU_ARRAY_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+#endif // CU_ARRAY_SIMD_IMPL
@@ -0,0 +1,308 @@
+/// @file cu_bench.h
+/// Simple microbenchmark "framework" as a header only library, the timing sibling of `cu_test.h`.
+/// It provides some simple MACROS:
+///     - CU_RUN_BENCHES(title)
+///     - CU_BENCH_PARSE_ARGS()
+///     - CU_BENCH(name, ops)
+///     - CU_BENCH_PAUSE() / CU_BENCH_RESUME()
+///     - CU_BENCH_DO_NOT_OPTIMIZE(var)
+///     - CU_BENCH_CLOBBER()
+///     - CU_RUN_BENCHES_END()
+///
+/// `CU_BENCH` is a loop header: its body is the measured code. Every benchmark first warms up
+/// while doubling the iterations of a sample until one takes `CU_BENCH_SAMPLE_NS`, then records
+/// `CU_BENCH_SAMPLES` samples and reports min, median, p99 (nearest rank), mean and ns per op.
+/// ```C
+/// #define _POSIX_C_SOURCE 199309L // clock_gettime under -std=c99
+/// #include "cu_bench.h"
+/// CU_RUN_BENCHES("Title") {
+///     CU_BENCH_PARSE_ARGS(); // --csv, --json, --filter <substring>
+///     CU_BENCH("sum 1k", 1000) {
+///         for (int i = 0; i < 1000; i++) { sum += i; }
+///         CU_BENCH_DO_NOT_OPTIMIZE(sum);
+///     }
+///     CU_RUN_BENCHES_END();
+/// }
+/// ```
+/// @def CU_BENCH_SAMPLES
+/// @brief Number of timed samples per benchmark (default: 51).
+/// @def CU_BENCH_SAMPLE_NS
+/// @brief Target duration of one sample in nanoseconds, the iteration count scales up to reach it (default: 1 ms).
+/// @def CU_BENCH_WARMUP_NS
+/// @brief Minimum time spent running a benchmark before the first sample, in nanoseconds (default: 20 ms).
+/// @def CU_FOUT
+/// @brief Define this before including to redirect output (e.g., to `stderr` or a file).
+/// For usage and examples see `bench/`.
+
+#ifndef CU_BENCH_H
+#define CU_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#if !defined(CLOCK_MONOTONIC)
+#error "cu_bench.h needs CLOCK_MONOTONIC, define _POSIX_C_SOURCE 199309L before the first include"
+#endif // !defined(CLOCK_MONOTONIC)
+#endif // defined(_WIN32)
+
+#ifndef CU_FOUT
+#define CU_FOUT stdout
+#endif // CU_FOUT
+
+#ifndef CU_BENCH_SAMPLES
+#define CU_BENCH_SAMPLES 51
+#endif // CU_BENCH_SAMPLES
+#ifndef CU_BENCH_SAMPLE_NS
+#define CU_BENCH_SAMPLE_NS 1000000ull
+#endif // CU_BENCH_SAMPLE_NS
+#ifndef CU_BENCH_WARMUP_NS
+#define CU_BENCH_WARMUP_NS 20000000ull
+#endif // CU_BENCH_WARMUP_NS
+
+#define __CU_BENCH_TEXT 0
+#define __CU_BENCH_CSV 1
+#define __CU_BENCH_JSON 2
+
+typedef struct __cu_bench_s
+{
+    const char *title;
+    int format;
+    const char *filter;
+    size_t num_reported;
+    // Current benchmark.
+    const char *name;
+    uint64_t ops;
+    int calibrated;
+    uint64_t iterations;
+    uint64_t remaining;
+    uint64_t start;
+    uint64_t paused;
+    uint64_t pause_start;
+    uint64_t warmup;
+    size_t num_samples;
+    uint64_t samples[CU_BENCH_SAMPLES];
+} __cu_bench_t;
+
+/// @brief Shouldn't be used by the user, it is called by `CU_RUN_BENCHES`.
+#define __CU_BENCH_INIT(suite_title)                    \
+    __cu_bench_t __g_cu_bench = {.title = suite_title}; \
+    const volatile void *__g_cu_bench_sink = NULL;
+
+/// @brief Monotonic clock in nanoseconds.
+static inline uint64_t __cu_bench_now(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)now.QuadPart / (uint64_t)freq.QuadPart * 1000000000ull +
+           (uint64_t)now.QuadPart % (uint64_t)freq.QuadPart * 1000000000ull / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif // defined(_WIN32)
+}
+
+static inline void __cu_bench_parse_args(__cu_bench_t *b, int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--csv") == 0)
+        {
+            b->format = __CU_BENCH_CSV;
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            b->format = __CU_BENCH_JSON;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            b->filter = argv[++i];
+        }
+    }
+}
+
+static inline void __cu_bench_report(__cu_bench_t *b)
+{
+    uint64_t *s = b->samples;
+    size_t n = b->num_samples;
+    for (size_t i = 1; i < n; i++)
+    {
+        uint64_t v = s[i];
+        size_t j = i;
+        for (; j > 0 && s[j - 1] > v; j--)
+        {
+            s[j] = s[j - 1];
+        }
+        s[j] = v;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        total += s[i];
+    }
+    // Samples hold the time of a whole sample, scaled down to one iteration here.
+    double it = (double)b->iterations;
+    double min = (double)s[0] / it;
+    double median = (n % 2u ? (double)s[n / 2u] : ((double)s[n / 2u - 1u] + (double)s[n / 2u]) / 2.0) / it;
+    double p99 = (double)s[(n * 99u + 99u) / 100u - 1u] / it;
+    double mean = (double)total / (double)n / it;
+    double per_op = median / (double)b->ops;
+
+    if (b->format == __CU_BENCH_CSV)
+    {
+        if (b->num_reported == 0u)
+        {
+            fprintf(CU_FOUT, "name,ops,iterations,samples,min_ns,median_ns,p99_ns,mean_ns,ns_per_op\n");
+        }
+        fprintf(CU_FOUT, "\"%s\",%llu,%llu,%zu,%.1f,%.1f,%.1f,%.1f,%.3f\n", b->name, (unsigned long long)b->ops,
+                (unsigned long long)b->iterations, n, min, median, p99, mean, per_op);
+    }
+    else if (b->format == __CU_BENCH_JSON)
+    {
+        fprintf(CU_FOUT,
+                "%s\n    {\"name\": \"%s\", \"ops\": %llu, \"iterations\": %llu, \"samples\": %zu, \"min_ns\": %.1f, "
+                "\"median_ns\": %.1f, \"p99_ns\": %.1f, \"mean_ns\": %.1f, \"ns_per_op\": %.3f}",
+                b->num_reported == 0u ? "" : ",", b->name, (unsigned long long)b->ops,
+                (unsigned long long)b->iterations, n, min, median, p99, mean, per_op);
+    }
+    else
+    {
+        if (b->num_reported == 0u)
+        {
+            fprintf(CU_FOUT, "%s\n%-40s %12s %14s %14s %12s\n", b->title, "benchmark", "iterations", "median ns",
+                    "p99 ns", "ns/op");
+        }
+        fprintf(CU_FOUT, "%-40s %12llu %14.1f %14.1f %12.3f\n", b->name, (unsigned long long)b->iterations, median, p99,
+                per_op);
+    }
+    b->num_reported += 1;
+}
+
+/// @brief Shouldn't be used by the user, it is called by `CU_BENCH`.
+static inline int __cu_bench_begin(__cu_bench_t *b, const char *name, uint64_t ops)
+{
+    if (b->filter != NULL && strstr(name, b->filter) == NULL)
+    {
+        return 0;
+    }
+    b->name = name;
+    b->ops = ops != 0u ? ops : 1u;
+    b->calibrated = 0;
+    b->iterations = 1;
+    b->warmup = 0;
+    b->num_samples = 0;
+    b->paused = 0;
+    b->remaining = 1;
+    b->start = __cu_bench_now();
+    return 1;
+}
+
+/// @brief Shouldn't be used by the user, it is called by `CU_BENCH` before every iteration.
+/// @return `1` to run the body once more, `0` when the benchmark is done.
+static inline int __cu_bench_next(__cu_bench_t *b)
+{
+    if (b->remaining != 0u)
+    {
+        b->remaining -= 1;
+        return 1;
+    }
+
+    // A sample of `iterations` runs of the body just finished.
+    uint64_t now = __cu_bench_now();
+    uint64_t elapsed = now - b->start - b->paused;
+    if (!b->calibrated)
+    {
+        b->warmup += elapsed;
+        if (elapsed < CU_BENCH_SAMPLE_NS && b->iterations < (UINT64_MAX >> 1))
+        {
+            b->iterations <<= 1;
+        }
+        else if (b->warmup >= CU_BENCH_WARMUP_NS)
+        {
+            b->calibrated = 1;
+        }
+    }
+    else
+    {
+        b->samples[b->num_samples++] = elapsed;
+        if (b->num_samples == CU_BENCH_SAMPLES)
+        {
+            __cu_bench_report(b);
+            return 0;
+        }
+    }
+
+    b->remaining = b->iterations - 1u;
+    b->paused = 0;
+    b->start = __cu_bench_now();
+    return 1;
+}
+
+/// @brief Runs the following statement (the body) as the benchmark `name`.
+/// @param name Name of the benchmark, a string.
+/// @param ops Operations done by one run of the body, used for the ns/op column.
+#define CU_BENCH(name, ops)                                              \
+    for (int __cu_bench_on = __cu_bench_begin(&__g_cu_bench, name, ops); \
+         __cu_bench_on && __cu_bench_next(&__g_cu_bench);)
+
+/// @brief Stops the clock, e.g. to reset the input between iterations.
+/// @note The clock is read for every pause, so the body should be much longer than a clock read.
+#define CU_BENCH_PAUSE() (__g_cu_bench.pause_start = __cu_bench_now())
+
+/// @brief Restarts the clock stopped by `CU_BENCH_PAUSE`.
+#define CU_BENCH_RESUME() (__g_cu_bench.paused += __cu_bench_now() - __g_cu_bench.pause_start)
+
+#if defined(__GNUC__) || defined(__clang__)
+/// @brief Forces the lvalue `var` to be computed and stored, so the work producing it is not optimized away.
+#define CU_BENCH_DO_NOT_OPTIMIZE(var) __asm__ __volatile__("" : : "r"(&(var)) : "memory")
+/// @brief Makes the compiler assume every memory location may have been read and written.
+#define CU_BENCH_CLOBBER() __asm__ __volatile__("" : : : "memory")
+#else
+/// @brief Forces the lvalue `var` to be computed and stored, so the work producing it is not optimized away.
+#define CU_BENCH_DO_NOT_OPTIMIZE(var) (__g_cu_bench_sink = (const volatile void *)&(var))
+/// @brief Makes the compiler assume every memory location may have been read and written.
+#define CU_BENCH_CLOBBER() (__g_cu_bench_sink = (const volatile void *)&__g_cu_bench)
+#endif // defined(__GNUC__) || defined(__clang__)
+
+/// @brief Reads `--csv`, `--json` and `--filter <substring>` from the command line.
+/// @note Must be called inside `CU_RUN_BENCHES`, before the first benchmark.
+#define CU_BENCH_PARSE_ARGS()                                                              \
+    do                                                                                     \
+    {                                                                                      \
+        __cu_bench_parse_args(&__g_cu_bench, __cu_bench_argc, __cu_bench_argv);            \
+        if (__g_cu_bench.format == __CU_BENCH_JSON)                                        \
+        {                                                                                  \
+            fprintf(CU_FOUT, "{\"title\": \"%s\", \"benchmarks\": [", __g_cu_bench.title); \
+        }                                                                                  \
+    } while (0)
+
+/// @brief Should be called at the end of the benchmark scope. Closes the JSON output.
+#define CU_RUN_BENCHES_END()                        \
+    if (__g_cu_bench.format == __CU_BENCH_JSON)     \
+    {                                               \
+        fprintf(CU_FOUT, "\n]}\n");                 \
+    }                                               \
+    return 0;
+
+/// @brief Wrapper around `main`.
+/// ```C
+/// CU_RUN_BENCHES("Title") {
+///     CU_BENCH_PARSE_ARGS();
+///     bench_something();
+///     ...
+///     CU_RUN_BENCHES_END();
+/// }
+/// ```
+/// @param title Title of the benchmark suite.
+#define CU_RUN_BENCHES(title) \
+    __CU_BENCH_INIT(title)    \
+    int main(int __cu_bench_argc, char **__cu_bench_argv)
+
+#endif // CU_BENCH_H
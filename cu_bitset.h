@@ -0,0 +1,519 @@
+/// @file cu_bitset.h
+/// @brief Simple, header-only packed bit array for C, built on top of `cu_array_t`.
+///
+/// Stores one bit per flag in 64-bit words, a `cu_array_t` with `item_size = 1` per flag takes 8x more memory.
+/// The words live in a `cu_array_t`, so the bitset grows and allocates like one (growth policy, allocator).
+/// ```C
+/// cu_bitset_t seen = {0};
+/// cu_bitset_init(&seen);
+/// cu_bitset_resize(&seen, 1000000);
+/// cu_bitset_set(&seen, 42);
+/// for (size_t i = cu_bitset_find_next(&seen, 0); i < seen.length; i = cu_bitset_find_next(&seen, i + 1)) { ... }
+/// cu_bitset_deinit(&seen);
+/// ```
+///
+/// A bitset also works as a selection mask over an array: `cu_bitset_select()` evaluates a predicate
+/// for every item (or `cu_array_simd_eq_mask()` compares them to a value), logical operations combine the masks,
+/// and `cu_bitset_retain()` keeps the selected items.
+///
+/// To include function implementations, define:
+///     #define CU_BITSET_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_bitset_init()`
+/// - `cu_bitset_init_with_allocator()`
+/// - `cu_bitset_deinit()`
+/// - `cu_bitset_reserve()`
+/// - `cu_bitset_resize()`
+/// - `cu_bitset_push()`
+/// - `cu_bitset_clear()`
+/// - `cu_bitset_fill()`
+/// - `cu_bitset_set()` / `cu_bitset_unset()` / `cu_bitset_assign()` / `cu_bitset_test()`
+/// - `cu_bitset_count()`
+/// - `cu_bitset_find_next()` / `cu_bitset_find_next_unset()`
+/// - `cu_bitset_and()` / `cu_bitset_or()` / `cu_bitset_xor()` / `cu_bitset_andnot()`
+/// - `cu_bitset_select()`
+/// - `cu_bitset_retain()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_BITSET_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+
+#ifndef CU_BITSET_H
+#define CU_BITSET_H
+
+#include "cu_array.h"
+
+/// @brief Number of bits per word of a `cu_bitset_t`.
+#define CU_BITSET_WORD_BITS (64u)
+
+typedef struct cu_bitset_s
+{
+    /// `uint64_t` words, bit `i` is bit `i % 64` of word `i / 64`. The bits past `length` are always zero.
+    cu_array_t words;
+    /// Number of bits.
+    size_t length;
+} cu_bitset_t;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define __CU_BITSET_POPCOUNT(x) ((size_t)__builtin_popcountll(x))
+#define __CU_BITSET_CTZ(x) ((size_t)__builtin_ctzll(x))
+#else
+#define __CU_BITSET_POPCOUNT(x) __cu_bitset_popcount(x)
+#define __CU_BITSET_CTZ(x) __cu_bitset_ctz(x)
+#endif // defined(__GNUC__) || defined(__clang__)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes an empty bitset. Storage is allocated lazily, like for `cu_array_init`.
+    /// @param bs Pointer to the bitset.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_init(cu_bitset_t *bs);
+
+    /// @brief Same as `cu_bitset_init`, but the words come from `allocator`.
+    /// @note The growth policy can be changed with `cu_array_set_growth(&bs->words, ...)`.
+    /// @param bs Pointer to the bitset.
+    /// @param allocator Allocator, `NULL` for `cu_malloc`/`cu_free`. Must outlive the bitset.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_init_with_allocator(cu_bitset_t *bs, const cu_allocator_t *allocator);
+
+    /// @brief Frees the storage and sets everything to zero.
+    /// @param bs Pointer to the bitset.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_deinit(cu_bitset_t *bs);
+
+    /// @brief Makes sure the bitset can hold at least `num_bits` bits without growing.
+    /// @param bs Pointer to the bitset.
+    /// @param num_bits Number of bits.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_reserve(cu_bitset_t *bs, size_t num_bits);
+
+    /// @brief Changes the number of bits, new bits are zero.
+    /// @param bs Pointer to the bitset.
+    /// @param num_bits New number of bits.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_resize(cu_bitset_t *bs, size_t num_bits);
+
+    /// @brief Appends one bit.
+    /// @param bs Pointer to the bitset.
+    /// @param value Non-zero to append a set bit.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_push(cu_bitset_t *bs, int value);
+
+    /// @brief Removes every bit (equivalent to `cu_bitset_resize(bs, 0)`), capacity stays the same.
+    /// @param bs Pointer to the bitset.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_clear(cu_bitset_t *bs);
+
+    /// @brief Sets every bit to `value`, the length stays the same.
+    /// @param bs Pointer to the bitset.
+    /// @param value Non-zero to set the bits, `0` to unset them.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_fill(cu_bitset_t *bs, int value);
+
+    /// @brief Returns the number of set bits, one `popcount` per word.
+    /// @param bs Pointer to the bitset.
+    /// @return Number of set bits, `0` on error.
+    CU_API size_t cu_bitset_count(const cu_bitset_t *bs);
+
+    /// @brief Returns the index of the first set bit at or after `pos`.
+    /// @note Skips whole zero words, then finds the bit with a count-trailing-zeros instruction.
+    /// @param bs Pointer to the bitset.
+    /// @param pos Index to start from.
+    /// @return Index of the bit, `bs->length` if there is none (or on error).
+    CU_API size_t cu_bitset_find_next(const cu_bitset_t *bs, size_t pos);
+
+    /// @brief Returns the index of the first unset bit at or after `pos`.
+    /// @param bs Pointer to the bitset.
+    /// @param pos Index to start from.
+    /// @return Index of the bit, `bs->length` if there is none (or on error).
+    CU_API size_t cu_bitset_find_next_unset(const cu_bitset_t *bs, size_t pos);
+
+    /// @brief `dst &= src`, a word at a time.
+    /// @param dst Pointer to the destination bitset.
+    /// @param src Pointer to a bitset of the same length.
+    /// @return `0` on success, `1` on error (e.g. the lengths differ).
+    CU_API int cu_bitset_and(cu_bitset_t *dst, const cu_bitset_t *src);
+
+    /// @brief `dst |= src`, a word at a time.
+    /// @param dst Pointer to the destination bitset.
+    /// @param src Pointer to a bitset of the same length.
+    /// @return `0` on success, `1` on error (e.g. the lengths differ).
+    CU_API int cu_bitset_or(cu_bitset_t *dst, const cu_bitset_t *src);
+
+    /// @brief `dst ^= src`, a word at a time.
+    /// @param dst Pointer to the destination bitset.
+    /// @param src Pointer to a bitset of the same length.
+    /// @return `0` on success, `1` on error (e.g. the lengths differ).
+    CU_API int cu_bitset_xor(cu_bitset_t *dst, const cu_bitset_t *src);
+
+    /// @brief `dst &= ~src`, a word at a time.
+    /// @param dst Pointer to the destination bitset.
+    /// @param src Pointer to a bitset of the same length.
+    /// @return `0` on success, `1` on error (e.g. the lengths differ).
+    CU_API int cu_bitset_andnot(cu_bitset_t *dst, const cu_bitset_t *src);
+
+    /// @brief Replaces the bits with one bit per item of `arr`, set where `pred` returns non-zero.
+    /// @param bs Pointer to the bitset.
+    /// @param arr Pointer to the array.
+    /// @param pred Predicate, called as `pred(item, ctx)` once per item in order.
+    /// @param ctx User context, passed to every `pred` call.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_bitset_select(cu_bitset_t *bs, cu_array_t *arr, int (*pred)(void *, void *), void *ctx);
+
+    /// @brief Keeps only the items of `arr` whose bit is set, like `cu_array_retain` with a mask.
+    /// @note Keeps the order, each run of selected items is moved with a single `cu_memmove`.
+    /// @param bs Pointer to a bitset with one bit per item of `arr`.
+    /// @param arr Pointer to the array.
+    /// @return `0` on success, `1` on error (e.g. the lengths differ).
+    CU_API int cu_bitset_retain(const cu_bitset_t *bs, cu_array_t *arr);
+
+#if !defined(__GNUC__) && !defined(__clang__)
+    CU_API size_t __cu_bitset_popcount(uint64_t x);
+    CU_API size_t __cu_bitset_ctz(uint64_t x);
+#endif // !defined(__GNUC__) && !defined(__clang__)
+
+#ifdef __cplusplus
+}
+#endif
+
+/// @brief Returns the bit at `pos`.
+/// @param bs Pointer to the bitset.
+/// @param pos Index of the bit.
+/// @return `1` if the bit is set, `0` if not or out of bounds.
+static inline int cu_bitset_test(const cu_bitset_t *bs, size_t pos)
+{
+    if (bs == NULL || pos >= bs->length)
+    {
+        return 0;
+    }
+    uint64_t word = ((const uint64_t *)(const void *)bs->words.data)[pos / CU_BITSET_WORD_BITS];
+    return (int)((word >> (pos % CU_BITSET_WORD_BITS)) & 1u);
+}
+
+/// @brief Sets the bit at `pos` to `value`.
+/// @param bs Pointer to the bitset.
+/// @param pos Index of the bit.
+/// @param value Non-zero to set the bit, `0` to unset it.
+/// @return `0` on success, `1` on error (e.g. out of bounds).
+static inline int cu_bitset_assign(cu_bitset_t *bs, size_t pos, int value)
+{
+    if (bs == NULL || pos >= bs->length)
+    {
+        return 1;
+    }
+    uint64_t *word = (uint64_t *)(void *)bs->words.data + pos / CU_BITSET_WORD_BITS;
+    uint64_t bit = (uint64_t)1u << (pos % CU_BITSET_WORD_BITS);
+    *word = value ? (*word | bit) : (*word & ~bit);
+    return 0;
+}
+
+/// @brief Sets the bit at `pos`.
+/// @param bs Pointer to the bitset.
+/// @param pos Index of the bit.
+/// @return `0` on success, `1` on error (e.g. out of bounds).
+static inline int cu_bitset_set(cu_bitset_t *bs, size_t pos)
+{
+    return cu_bitset_assign(bs, pos, 1);
+}
+
+/// @brief Unsets the bit at `pos`.
+/// @param bs Pointer to the bitset.
+/// @param pos Index of the bit.
+/// @return `0` on success, `1` on error (e.g. out of bounds).
+static inline int cu_bitset_unset(cu_bitset_t *bs, size_t pos)
+{
+    return cu_bitset_assign(bs, pos, 0);
+}
+
+#endif // CU_BITSET_H
+
+#ifdef CU_BITSET_IMPL
+
+#ifndef cu_memmove
+#define cu_memmove memmove
+#endif // cu_memmove
+
+// Definitions
+
+// Helper functions, not "public"
+
+#if !defined(__GNUC__) && !defined(__clang__)
+CU_API size_t __cu_bitset_popcount(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (size_t)((x * 0x0101010101010101ull) >> 56);
+}
+
+CU_API size_t __cu_bitset_ctz(uint64_t x)
+{
+    size_t n = 0;
+    while ((x & 1u) == 0u)
+    {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+#endif // !defined(__GNUC__) && !defined(__clang__)
+
+CU_API uint64_t *__cu_bitset_words(const cu_bitset_t *bs)
+{
+    return (uint64_t *)(void *)bs->words.data;
+}
+
+CU_API size_t __cu_bitset_num_words(size_t num_bits)
+{
+    return num_bits / CU_BITSET_WORD_BITS + (num_bits % CU_BITSET_WORD_BITS != 0u);
+}
+
+/// Zeroes the bits of the last word past `length`, the other functions rely on them being zero.
+CU_API void __cu_bitset_trim(cu_bitset_t *bs)
+{
+    size_t used = bs->length % CU_BITSET_WORD_BITS;
+    if (used != 0u)
+    {
+        __cu_bitset_words(bs)[bs->length / CU_BITSET_WORD_BITS] &= ((uint64_t)1u << used) - 1u;
+    }
+}
+
+CU_API size_t __cu_bitset_find(const cu_bitset_t *bs, size_t pos, uint64_t flip)
+{
+    if (bs == NULL || pos >= bs->length)
+    {
+        return bs != NULL ? bs->length : 0u;
+    }
+    const uint64_t *words = __cu_bitset_words(bs);
+    size_t num_words = bs->words.length;
+    size_t w = pos / CU_BITSET_WORD_BITS;
+    // `flip` turns the search for unset bits into one for set bits.
+    uint64_t word = (words[w] ^ flip) & (~(uint64_t)0 << (pos % CU_BITSET_WORD_BITS));
+    while (word == 0u)
+    {
+        if (++w == num_words)
+        {
+            return bs->length;
+        }
+        word = words[w] ^ flip;
+    }
+    size_t found = w * CU_BITSET_WORD_BITS + __CU_BITSET_CTZ(word);
+    // Flipped zero bits past the end look set.
+    return found < bs->length ? found : bs->length;
+}
+
+CU_API int __cu_bitset_check_pair(const cu_bitset_t *dst, const cu_bitset_t *src)
+{
+    return dst == NULL || src == NULL || dst->words.item_size != sizeof(uint64_t) || dst->length != src->length;
+}
+
+// "Public" function definitions
+
+CU_API int cu_bitset_init(cu_bitset_t *bs)
+{
+    return cu_bitset_init_with_allocator(bs, NULL);
+}
+
+CU_API int cu_bitset_init_with_allocator(cu_bitset_t *bs, const cu_allocator_t *allocator)
+{
+    if (bs == NULL || bs->words.data != NULL)
+    {
+        return 1;
+    }
+    *bs = (cu_bitset_t){0};
+    return cu_array_init_with_allocator(&bs->words, sizeof(uint64_t), allocator);
+}
+
+CU_API int cu_bitset_deinit(cu_bitset_t *bs)
+{
+    if (bs == NULL || cu_array_deinit(&bs->words) != 0)
+    {
+        return 1;
+    }
+    bs->length = 0;
+    return 0;
+}
+
+CU_API int cu_bitset_reserve(cu_bitset_t *bs, size_t num_bits)
+{
+    if (bs == NULL)
+    {
+        return 1;
+    }
+    return cu_array_reserve(&bs->words, __cu_bitset_num_words(num_bits));
+}
+
+CU_API int cu_bitset_resize(cu_bitset_t *bs, size_t num_bits)
+{
+    if (bs == NULL || bs->words.item_size != sizeof(uint64_t))
+    {
+        return 1;
+    }
+    size_t num_words = __cu_bitset_num_words(num_bits);
+    if (num_words > bs->words.length)
+    {
+        size_t added = num_words - bs->words.length;
+        uint64_t *words = (uint64_t *)(void *)cu_array_emplace_n(&bs->words, added);
+        if (words == NULL)
+        {
+            return 1;
+        }
+        for (size_t i = 0; i < added; i++)
+        {
+            words[i] = 0;
+        }
+    }
+    bs->words.length = num_words;
+    bs->length = num_bits;
+    __cu_bitset_trim(bs);
+    return 0;
+}
+
+CU_API int cu_bitset_push(cu_bitset_t *bs, int value)
+{
+    if (bs == NULL || bs->words.item_size != sizeof(uint64_t))
+    {
+        return 1;
+    }
+    if (bs->length % CU_BITSET_WORD_BITS == 0u)
+    {
+        uint64_t word = 0;
+        if (cu_array_append(&bs->words, &word) != 0)
+        {
+            return 1;
+        }
+    }
+    bs->length += 1;
+    return cu_bitset_assign(bs, bs->length - 1u, value);
+}
+
+CU_API int cu_bitset_clear(cu_bitset_t *bs)
+{
+    if (bs == NULL || cu_array_clear(&bs->words) != 0)
+    {
+        return 1;
+    }
+    bs->length = 0;
+    return 0;
+}
+
+CU_API int cu_bitset_fill(cu_bitset_t *bs, int value)
+{
+    if (bs == NULL || bs->words.item_size != sizeof(uint64_t))
+    {
+        return 1;
+    }
+    uint64_t *words = __cu_bitset_words(bs);
+    for (size_t i = 0; i < bs->words.length; i++)
+    {
+        words[i] = value ? ~(uint64_t)0 : 0u;
+    }
+    __cu_bitset_trim(bs);
+    return 0;
+}
+
+CU_API size_t cu_bitset_count(const cu_bitset_t *bs)
+{
+    if (bs == NULL || bs->words.item_size != sizeof(uint64_t))
+    {
+        return 0;
+    }
+    const uint64_t *words = __cu_bitset_words(bs);
+    size_t count = 0;
+    for (size_t i = 0; i < bs->words.length; i++)
+    {
+        count += __CU_BITSET_POPCOUNT(words[i]);
+    }
+    return count;
+}
+
+CU_API size_t cu_bitset_find_next(const cu_bitset_t *bs, size_t pos)
+{
+    return __cu_bitset_find(bs, pos, 0u);
+}
+
+CU_API size_t cu_bitset_find_next_unset(const cu_bitset_t *bs, size_t pos)
+{
+    return __cu_bitset_find(bs, pos, ~(uint64_t)0);
+}
+
+#define __CU_BITSET_OP(NAME, EXPR)                                        \
+    CU_API int cu_bitset_##NAME(cu_bitset_t *dst, const cu_bitset_t *src) \
+    {                                                                     \
+        if (__cu_bitset_check_pair(dst, src))                             \
+        {                                                                 \
+            return 1;                                                     \
+        }                                                                 \
+        uint64_t *d = __cu_bitset_words(dst);                             \
+        const uint64_t *s = __cu_bitset_words(src);                       \
+        for (size_t i = 0; i < dst->words.length; i++)                    \
+        {                                                                 \
+            d[i] = EXPR;                                                  \
+        }                                                                 \
+        return 0;                                                         \
+    }
+
+__CU_BITSET_OP(and, d[i] & s[i])
+__CU_BITSET_OP(or, d[i] | s[i])
+__CU_BITSET_OP(xor, d[i] ^ s[i])
+__CU_BITSET_OP(andnot, d[i] & ~s[i])
+
+CU_API int cu_bitset_select(cu_bitset_t *bs, cu_array_t *arr, int (*pred)(void *, void *), void *ctx)
+{
+    if (arr == NULL || arr->item_size == 0u || pred == NULL || cu_bitset_resize(bs, arr->length) != 0)
+    {
+        return 1;
+    }
+    // A whole word of predicates at a time, so the words are written once.
+    uint64_t *words = __cu_bitset_words(bs);
+    for (size_t w = 0; w < bs->words.length; w++)
+    {
+        size_t first = w * CU_BITSET_WORD_BITS;
+        size_t n = arr->length - first < CU_BITSET_WORD_BITS ? arr->length - first : CU_BITSET_WORD_BITS;
+        uint64_t word = 0;
+        for (size_t b = 0; b < n; b++)
+        {
+            word |= (uint64_t)(pred(__CU_ARRAY_OFFSET(arr->data, arr->item_size * (first + b)), ctx) != 0) << b;
+        }
+        words[w] = word;
+    }
+    return 0;
+}
+
+CU_API int cu_bitset_retain(const cu_bitset_t *bs, cu_array_t *arr)
+{
+    if (bs == NULL || arr == NULL || arr->item_size == 0u || bs->length != arr->length)
+    {
+        return 1;
+    }
+    if ((arr->flags & CU_ARRAY_READONLY) && __cu_array_prepare(arr, 0) != 0)
+    {
+        return 1;
+    }
+
+    size_t kept = 0;
+    size_t start = cu_bitset_find_next(bs, 0);
+    while (start < bs->length)
+    {
+        size_t end = cu_bitset_find_next_unset(bs, start);
+        if (kept != start)
+        {
+            cu_memmove(__CU_ARRAY_OFFSET(arr->data, arr->item_size * kept),
+                       __CU_ARRAY_OFFSET(arr->data, arr->item_size * start), arr->item_size * (end - start));
+        }
+        kept += end - start;
+        start = cu_bitset_find_next(bs, end);
+    }
+    arr->length = kept;
+    return 0;
+}
+
+#endif // CU_BITSET_IMPL
@@ -0,0 +1,429 @@
+/// @file cu_conc_array.h
+/// @brief Simple, header-only concurrent append-only array with stable addresses.
+///
+/// Any number of threads can push at the same time without a lock, and items never move:
+/// the storage is a list of segments that double in size, each allocated once and never reallocated,
+/// so pointers to items stay valid until `cu_conc_array_deinit()`.
+/// ```C
+/// cu_conc_array_t arr = {0};
+/// cu_conc_array_init(&arr, sizeof(result_t));
+/// // any thread
+/// size_t index;
+/// result_t *stored = (result_t *)cu_conc_array_push(&arr, &result, &index);
+/// // any thread, O(1)
+/// result_t *r = (result_t *)cu_conc_array_at(&arr, index);
+/// cu_conc_array_deinit(&arr); // after every thread is done
+/// ```
+///
+/// Push claims an index with an atomic fetch-add, allocating the segment with a compare-and-swap if
+/// it's the first item there, then marks the slot as written. Reading an index that is claimed but
+/// not written yet returns `NULL`.
+///
+/// Uses C11 `<stdatomic.h>` when available, the GCC/Clang `__atomic` builtins otherwise (e.g. with `-std=c99`).
+///
+/// To include function implementations, define:
+///     #define CU_CONC_ARRAY_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_conc_array_init()`
+/// - `cu_conc_array_init_with_allocator()`
+/// - `cu_conc_array_deinit()`
+/// - `cu_conc_array_push()`
+/// - `cu_conc_array_at()`
+/// - `cu_conc_array_length()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_CONC_ARRAY_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+/// @def CU_API
+/// @brief Override linkage keyword (default: extern or empty if CU_CONC_ARRAY_IMPL is defined).
+/// @def CU_UNIT
+/// @brief Type used for raw array storage (default: unsigned char). Item sizes stay in bytes and must be a multiple
+///        of `sizeof(CU_UNIT)`.
+/// @def CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT
+/// @brief The first segment holds `1 << CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT` items, every next one twice as many (default: 6).
+/// @def CU_NO_LIBC
+/// @brief Disable all standard library includes. You should define cu_malloc, cu_free, cu_memcpy.
+/// @def CU_NO_STDLIB_H
+/// @brief Disable inclusion of <stdlib.h>. You should define cu_malloc, cu_free.
+/// @def CU_NO_STRINGS_H
+/// @brief Disable inclusion of <string.h>. You should define cu_memcpy.
+
+#ifndef CU_CONC_ARRAY_H
+#define CU_CONC_ARRAY_H
+
+#ifndef CU_API
+#ifdef CU_CONC_ARRAY_IMPL
+#define CU_API
+#else
+#define CU_API extern
+#endif // CU_CONC_ARRAY_IMPL
+#endif // CU_API
+
+#ifndef CU_UNIT
+#define CU_UNIT unsigned char
+#endif // CU_UNIT
+
+#if (!defined(CU_NO_STDLIB_H)) && (!defined(CU_NO_LIBC))
+#include <stdlib.h>
+#endif // (!defined(CU_NO_STDLIB_H)) && (!defined(CU_NO_LIBC))
+
+#if defined(CU_NO_STDLIB_H) || defined(CU_NO_LIBC)
+#include <stddef.h>
+#endif // defined(CU_NO_STDLIB_H) || defined(CU_NO_LIBC)
+
+#if (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
+#include <string.h>
+#endif // (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
+
+#include <stdint.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef _Atomic size_t __cu_conc_atomic_size_t;
+typedef _Atomic unsigned char __cu_conc_atomic_flag_t;
+typedef CU_UNIT *_Atomic __cu_conc_atomic_ptr_t;
+#define __CU_CONC_RELAXED memory_order_relaxed
+#define __CU_CONC_ACQUIRE memory_order_acquire
+#define __CU_CONC_RELEASE memory_order_release
+#define __CU_CONC_ACQ_REL memory_order_acq_rel
+#define __CU_CONC_LOAD(p, order) atomic_load_explicit((p), (order))
+#define __CU_CONC_STORE(p, v, order) atomic_store_explicit((p), (v), (order))
+#define __CU_CONC_FETCH_ADD(p, v, order) atomic_fetch_add_explicit((p), (v), (order))
+#define __CU_CONC_CAS(p, expected, desired) \
+    atomic_compare_exchange_strong_explicit((p), (expected), (desired), memory_order_acq_rel, memory_order_acquire)
+#elif defined(__GNUC__) || defined(__clang__)
+typedef size_t __cu_conc_atomic_size_t;
+typedef unsigned char __cu_conc_atomic_flag_t;
+typedef CU_UNIT *__cu_conc_atomic_ptr_t;
+#define __CU_CONC_RELAXED __ATOMIC_RELAXED
+#define __CU_CONC_ACQUIRE __ATOMIC_ACQUIRE
+#define __CU_CONC_RELEASE __ATOMIC_RELEASE
+#define __CU_CONC_ACQ_REL __ATOMIC_ACQ_REL
+#define __CU_CONC_LOAD(p, order) __atomic_load_n((p), (order))
+#define __CU_CONC_STORE(p, v, order) __atomic_store_n((p), (v), (order))
+#define __CU_CONC_FETCH_ADD(p, v, order) __atomic_fetch_add((p), (v), (order))
+#define __CU_CONC_CAS(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#error "cu_conc_array.h needs C11 atomics or the GCC/Clang __atomic builtins"
+#endif
+
+#ifndef CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT
+#define CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT (6u)
+#endif // CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT
+
+/// @brief Number of segment pointers, enough for `SIZE_MAX` items.
+#define CU_CONC_ARRAY_MAX_SEGMENTS (sizeof(size_t) * 8u)
+
+#ifndef CU_ALLOCATOR_DEFINED
+#define CU_ALLOCATOR_DEFINED
+/// @brief Allocator interface, shared by all `cu_*` headers.
+/// @note The sizes passed to `realloc` and `free` are the sizes of the original allocation,
+///       so simple allocators (e.g. arenas) don't have to track them.
+typedef struct cu_allocator_s
+{
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} cu_allocator_t;
+#endif // CU_ALLOCATOR_DEFINED
+
+typedef struct cu_conc_array_s
+{
+    /// Segment `k` holds `1 << (CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT + k)` items, followed by one "written" flag per item.
+    __cu_conc_atomic_ptr_t segments[CU_CONC_ARRAY_MAX_SEGMENTS];
+    /// Number of claimed indices, some of them may still be being written.
+    __cu_conc_atomic_size_t length;
+    size_t item_size;
+    const cu_allocator_t *allocator;
+} cu_conc_array_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes a concurrent array. Segments are allocated lazily by the pushes.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of every item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_conc_array_init(cu_conc_array_t *arr, size_t item_size);
+
+    /// @brief Same as `cu_conc_array_init`, but the segments come from `allocator`.
+    /// @note The allocator is called from the pushing threads, so it must be thread-safe.
+    /// @param arr Pointer to the array.
+    /// @param item_size Size of every item in bytes.
+    /// @param allocator Allocator, `NULL` for `cu_malloc`/`cu_free`. Must outlive the array.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_conc_array_init_with_allocator(cu_conc_array_t *arr, size_t item_size, const cu_allocator_t *allocator);
+
+    /// @brief Frees every segment and sets everything to zero. No other thread may be using the array.
+    /// @param arr Pointer to the array.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_conc_array_deinit(cu_conc_array_t *arr);
+
+    /// @brief Appends a copy of `item`. Safe to call from any number of threads at once.
+    /// @note If the allocation of a new segment fails, the claimed index stays empty forever.
+    /// @param arr Pointer to the array.
+    /// @param item Pointer to the item.
+    /// @param index Receives the index of the item, can be `NULL`.
+    /// @return Pointer to the stored item, valid until `cu_conc_array_deinit`, `NULL` on error.
+    CU_API CU_UNIT *cu_conc_array_push(cu_conc_array_t *arr, const void *item, size_t *index);
+
+    /// @brief Returns a pointer to the item at `pos` in `O(1)`. Safe to call while other threads push.
+    /// @param arr Pointer to the array.
+    /// @param pos Index of the item.
+    /// @return Pointer to the item, `NULL` if `pos` wasn't pushed (or isn't written yet) or on error.
+    CU_API CU_UNIT *cu_conc_array_at(cu_conc_array_t *arr, size_t pos);
+
+    /// @brief Returns the number of claimed indices.
+    /// @note While other threads push, the last few items may not be written yet (`cu_conc_array_at` returns `NULL` for them).
+    /// @param arr Pointer to the array.
+    /// @return Number of items, `0` on error.
+    CU_API size_t cu_conc_array_length(cu_conc_array_t *arr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_CONC_ARRAY_H
+
+#ifdef CU_CONC_ARRAY_IMPL
+
+#ifndef cu_malloc
+#define cu_malloc malloc
+#endif // cu_malloc
+#ifndef cu_free
+#define cu_free free
+#endif // cu_free
+#ifndef cu_memcpy
+#define cu_memcpy memcpy
+#endif // cu_memcpy
+
+// Definitions
+
+// Helper functions, not "public"
+
+CU_API size_t __cu_conc_array_log2(size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (sizeof(unsigned long long) * 8u - 1u) - (size_t)__builtin_clzll((unsigned long long)x);
+#else
+    size_t log = 0;
+    while (x >>= 1)
+    {
+        log++;
+    }
+    return log;
+#endif
+}
+
+// Maps an index to its segment and the offset inside it. With `B` the first segment size, segment `k`
+// starts at index `B * (2^k - 1)`, so `pos + B` has its highest bit at `k + log2(B)`.
+CU_API int __cu_conc_array_locate(size_t pos, size_t *segment, size_t *offset)
+{
+    size_t first = (size_t)1 << CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT;
+    if (pos > SIZE_MAX - first)
+    {
+        return 1;
+    }
+    size_t biased = pos + first;
+    size_t high = __cu_conc_array_log2(biased);
+    *segment = high - CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT;
+    *offset = biased - ((size_t)1 << high);
+    return 0;
+}
+
+CU_API size_t __cu_conc_array_segment_items(size_t segment)
+{
+    return (size_t)1 << (CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT + segment);
+}
+
+CU_API size_t __cu_conc_array_segment_bytes(cu_conc_array_t *arr, size_t segment)
+{
+    // Items first, then one flag byte per item.
+    return (arr->item_size + 1u) * __cu_conc_array_segment_items(segment);
+}
+
+CU_API void *__cu_conc_array_alloc(cu_conc_array_t *arr, size_t size)
+{
+    return arr->allocator != NULL ? arr->allocator->alloc(arr->allocator->ctx, size) : cu_malloc(size);
+}
+
+CU_API void __cu_conc_array_free(cu_conc_array_t *arr, void *ptr, size_t size)
+{
+    if (arr->allocator != NULL)
+    {
+        arr->allocator->free(arr->allocator->ctx, ptr, size);
+        return;
+    }
+    (void)size;
+    cu_free(ptr);
+}
+
+// Pointer `bytes` past `ptr`, sizes are in bytes whatever `CU_UNIT` is.
+#define __CU_CONC_OFFSET(ptr, bytes) ((CU_UNIT *)(void *)((unsigned char *)(ptr) + (bytes)))
+
+CU_API CU_UNIT *__cu_conc_array_segment(cu_conc_array_t *arr, size_t segment)
+{
+    CU_UNIT *data = __CU_CONC_LOAD(&arr->segments[segment], __CU_CONC_ACQUIRE);
+    if (data != NULL)
+    {
+        return data;
+    }
+
+    // Several threads may race for the same segment, the first one to install it wins.
+    size_t items = __cu_conc_array_segment_items(segment);
+    if (items > SIZE_MAX / (arr->item_size + 1u))
+    {
+        return NULL;
+    }
+    size_t bytes = __cu_conc_array_segment_bytes(arr, segment);
+    CU_UNIT *fresh = (CU_UNIT *)__cu_conc_array_alloc(arr, bytes);
+    if (fresh == NULL)
+    {
+        return NULL;
+    }
+    __cu_conc_atomic_flag_t *flags =
+        (__cu_conc_atomic_flag_t *)(void *)__CU_CONC_OFFSET(fresh, arr->item_size * items);
+    for (size_t i = 0; i < items; i++)
+    {
+        __CU_CONC_STORE(&flags[i], 0u, __CU_CONC_RELAXED);
+    }
+
+    CU_UNIT *expected = NULL;
+    if (__CU_CONC_CAS(&arr->segments[segment], &expected, fresh))
+    {
+        return fresh;
+    }
+    __cu_conc_array_free(arr, fresh, bytes);
+    return expected;
+}
+
+// "Public" function definitions
+
+CU_API int cu_conc_array_init(cu_conc_array_t *arr, size_t item_size)
+{
+    return cu_conc_array_init_with_allocator(arr, item_size, NULL);
+}
+
+CU_API int cu_conc_array_init_with_allocator(cu_conc_array_t *arr, size_t item_size, const cu_allocator_t *allocator)
+{
+    if (arr == NULL || arr->item_size != 0u || item_size == 0u || item_size == SIZE_MAX ||
+        item_size % sizeof(CU_UNIT) != 0u)
+    {
+        return 1;
+    }
+    if (allocator != NULL && (allocator->alloc == NULL || allocator->free == NULL))
+    {
+        return 1;
+    }
+
+    for (size_t k = 0; k < CU_CONC_ARRAY_MAX_SEGMENTS; k++)
+    {
+        __CU_CONC_STORE(&arr->segments[k], NULL, __CU_CONC_RELAXED);
+    }
+    __CU_CONC_STORE(&arr->length, 0u, __CU_CONC_RELAXED);
+    arr->item_size = item_size;
+    arr->allocator = allocator;
+    return 0;
+}
+
+CU_API int cu_conc_array_deinit(cu_conc_array_t *arr)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 1;
+    }
+
+    for (size_t k = 0; k < CU_CONC_ARRAY_MAX_SEGMENTS; k++)
+    {
+        CU_UNIT *data = __CU_CONC_LOAD(&arr->segments[k], __CU_CONC_ACQUIRE);
+        if (data != NULL)
+        {
+            __cu_conc_array_free(arr, data, __cu_conc_array_segment_bytes(arr, k));
+            __CU_CONC_STORE(&arr->segments[k], NULL, __CU_CONC_RELAXED);
+        }
+    }
+    __CU_CONC_STORE(&arr->length, 0u, __CU_CONC_RELAXED);
+    arr->item_size = 0;
+    arr->allocator = NULL;
+    return 0;
+}
+
+CU_API CU_UNIT *cu_conc_array_push(cu_conc_array_t *arr, const void *item, size_t *index)
+{
+    if (arr == NULL || arr->item_size == 0u || item == NULL)
+    {
+        return NULL;
+    }
+
+    size_t pos = __CU_CONC_FETCH_ADD(&arr->length, 1u, __CU_CONC_RELAXED);
+    size_t segment;
+    size_t offset;
+    if (__cu_conc_array_locate(pos, &segment, &offset) != 0)
+    {
+        return NULL;
+    }
+    CU_UNIT *data = __cu_conc_array_segment(arr, segment);
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    CU_UNIT *slot = __CU_CONC_OFFSET(data, arr->item_size * offset);
+    cu_memcpy(slot, item, arr->item_size);
+    size_t flags_offset = arr->item_size * __cu_conc_array_segment_items(segment);
+    __cu_conc_atomic_flag_t *flags = (__cu_conc_atomic_flag_t *)(void *)__CU_CONC_OFFSET(data, flags_offset);
+    // Release, so a reader that sees the flag also sees the item.
+    __CU_CONC_STORE(&flags[offset], 1u, __CU_CONC_RELEASE);
+    if (index != NULL)
+    {
+        *index = pos;
+    }
+    return slot;
+}
+
+CU_API CU_UNIT *cu_conc_array_at(cu_conc_array_t *arr, size_t pos)
+{
+    if (arr == NULL || arr->item_size == 0u || pos >= __CU_CONC_LOAD(&arr->length, __CU_CONC_RELAXED))
+    {
+        return NULL;
+    }
+
+    size_t segment;
+    size_t offset;
+    if (__cu_conc_array_locate(pos, &segment, &offset) != 0)
+    {
+        return NULL;
+    }
+    CU_UNIT *data = __CU_CONC_LOAD(&arr->segments[segment], __CU_CONC_ACQUIRE);
+    if (data == NULL)
+    {
+        return NULL;
+    }
+    size_t flags_offset = arr->item_size * __cu_conc_array_segment_items(segment);
+    __cu_conc_atomic_flag_t *flags = (__cu_conc_atomic_flag_t *)(void *)__CU_CONC_OFFSET(data, flags_offset);
+    if (__CU_CONC_LOAD(&flags[offset], __CU_CONC_ACQUIRE) == 0u)
+    {
+        return NULL;
+    }
+    return __CU_CONC_OFFSET(data, arr->item_size * offset);
+}
+
+CU_API size_t cu_conc_array_length(cu_conc_array_t *arr)
+{
+    if (arr == NULL || arr->item_size == 0u)
+    {
+        return 0;
+    }
+    return __CU_CONC_LOAD(&arr->length, __CU_CONC_ACQUIRE);
+}
+
+#endif // CU_CONC_ARRAY_IMPL
@@ -0,0 +1,391 @@
+/// @file cu_deque.h
+/// @brief Simple, header-only double-ended queue for C, built next to `cu_array_t`.
+///
+/// A growable ring buffer of `item_size` byte items: pushing and popping at either end is `O(1)`
+/// amortized and never moves the other items, indexing is `O(1)`.
+/// ```C
+/// cu_deque_t queue = {0};
+/// cu_deque_init(&queue, sizeof(job_t));
+/// cu_deque_push_back(&queue, &job);
+/// job_t next;
+/// cu_deque_pop_front(&queue, &next);
+/// cu_deque_deinit(&queue);
+/// ```
+///
+/// To include function implementations, define:
+///     #define CU_DEQUE_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_deque_init()`
+/// - `cu_deque_init_with_allocator()`
+/// - `cu_deque_deinit()`
+/// - `cu_deque_reserve()`
+/// - `cu_deque_push_back()`
+/// - `cu_deque_push_front()`
+/// - `cu_deque_pop_back()`
+/// - `cu_deque_pop_front()`
+/// - `cu_deque_at()`
+/// - `cu_deque_clear()`
+/// - `cu_deque_drain()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_DEQUE_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+/// @def CU_DEQUE_DEFAULT_SIZE
+/// @brief Capacity of the first allocation, made lazily by the first push. Must be a power of two (default: 16).
+
+#ifndef CU_DEQUE_H
+#define CU_DEQUE_H
+
+#include "cu_array.h"
+
+typedef struct cu_deque_s
+{
+    CU_UNIT *data;
+    size_t item_size;
+    /// Slot of the first item, the items wrap around the end of `data`.
+    size_t head;
+    size_t length;
+    /// Always `0` or a power of two.
+    size_t capacity;
+    const cu_allocator_t *allocator;
+} cu_deque_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes a deque. Storage is allocated lazily by the first push.
+    /// @param dq Pointer to the deque.
+    /// @param item_size Size of every item in bytes.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_init(cu_deque_t *dq, size_t item_size);
+
+    /// @brief Same as `cu_deque_init`, but the storage comes from `allocator`.
+    /// @param dq Pointer to the deque.
+    /// @param item_size Size of every item in bytes.
+    /// @param allocator Allocator, `NULL` for `cu_malloc`/`cu_free`. Must outlive the deque.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_init_with_allocator(cu_deque_t *dq, size_t item_size, const cu_allocator_t *allocator);
+
+    /// @brief Frees the storage and sets everything to zero.
+    /// @param dq Pointer to the deque.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_deinit(cu_deque_t *dq);
+
+    /// @brief Makes sure the deque can hold at least `new_capacity` items without growing.
+    /// @note The capacity is rounded up to a power of two.
+    /// @param dq Pointer to the deque.
+    /// @param new_capacity Number of items.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_reserve(cu_deque_t *dq, size_t new_capacity);
+
+    /// @brief Appends a copy of `item` after the last item.
+    /// @param dq Pointer to the deque.
+    /// @param item Pointer to the item.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_push_back(cu_deque_t *dq, const void *item);
+
+    /// @brief Inserts a copy of `item` before the first item.
+    /// @param dq Pointer to the deque.
+    /// @param item Pointer to the item.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_push_front(cu_deque_t *dq, const void *item);
+
+    /// @brief Removes the last item, copying it into `out`.
+    /// @param dq Pointer to the deque.
+    /// @param out Pointer to `item_size` bytes, can be `NULL` to drop the item.
+    /// @return `0` on success, `1` if the deque is empty or on error.
+    CU_API int cu_deque_pop_back(cu_deque_t *dq, void *out);
+
+    /// @brief Removes the first item, copying it into `out`.
+    /// @param dq Pointer to the deque.
+    /// @param out Pointer to `item_size` bytes, can be `NULL` to drop the item.
+    /// @return `0` on success, `1` if the deque is empty or on error.
+    CU_API int cu_deque_pop_front(cu_deque_t *dq, void *out);
+
+    /// @brief Returns a pointer to the item at `pos`, counted from the front.
+    /// @note Any push can move the items.
+    /// @param dq Pointer to the deque.
+    /// @param pos Index of the item.
+    /// @return Pointer to the item on success, `NULL` on error.
+    CU_API CU_UNIT *cu_deque_at(cu_deque_t *dq, size_t pos);
+
+    /// @brief Removes every item, capacity stays the same.
+    /// @param dq Pointer to the deque.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_deque_clear(cu_deque_t *dq);
+
+    /// @brief Appends every item to `dst` in order (front first) and empties the deque.
+    /// @note At most two copies, one per contiguous part of the ring.
+    /// @param dq Pointer to the deque.
+    /// @param dst Pointer to an array initialized with the same `item_size`.
+    /// @return `0` on success, `1` on error (the deque is unchanged).
+    CU_API int cu_deque_drain(cu_deque_t *dq, cu_array_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_DEQUE_H
+
+#ifdef CU_DEQUE_IMPL
+
+#ifndef cu_malloc
+#define cu_malloc malloc
+#endif // cu_malloc
+#ifndef cu_free
+#define cu_free free
+#endif // cu_free
+#ifndef cu_memcpy
+#define cu_memcpy memcpy
+#endif // cu_memcpy
+#ifndef CU_DEQUE_DEFAULT_SIZE
+#define CU_DEQUE_DEFAULT_SIZE (16u)
+#endif // CU_DEQUE_DEFAULT_SIZE
+
+// Definitions
+
+// Helper functions, not "public"
+
+CU_API CU_UNIT *__cu_deque_slot(cu_deque_t *dq, size_t pos)
+{
+    return __CU_ARRAY_OFFSET(dq->data, dq->item_size * ((dq->head + pos) & (dq->capacity - 1u)));
+}
+
+// Moves the items to a new buffer of `new_capacity` slots, unwrapped so the front is at slot 0.
+CU_API int __cu_deque_resize(cu_deque_t *dq, size_t new_capacity)
+{
+    if (new_capacity > SIZE_MAX / dq->item_size)
+    {
+        return 1;
+    }
+    size_t bytes = dq->item_size * new_capacity;
+    CU_UNIT *data = (CU_UNIT *)(dq->allocator != NULL ? dq->allocator->alloc(dq->allocator->ctx, bytes) : cu_malloc(bytes));
+    if (data == NULL)
+    {
+        return 1;
+    }
+
+    if (dq->length != 0u)
+    {
+        size_t first = dq->capacity - dq->head < dq->length ? dq->capacity - dq->head : dq->length;
+        cu_memcpy(data, __CU_ARRAY_OFFSET(dq->data, dq->item_size * dq->head), dq->item_size * first);
+        cu_memcpy(__CU_ARRAY_OFFSET(data, dq->item_size * first), dq->data, dq->item_size * (dq->length - first));
+    }
+    if (dq->data != NULL)
+    {
+        if (dq->allocator != NULL)
+        {
+            dq->allocator->free(dq->allocator->ctx, dq->data, dq->item_size * dq->capacity);
+        }
+        else
+        {
+            cu_free(dq->data);
+        }
+    }
+    dq->data = data;
+    dq->head = 0;
+    dq->capacity = new_capacity;
+    return 0;
+}
+
+CU_API int __cu_deque_grow(cu_deque_t *dq)
+{
+    if (dq->capacity == 0u)
+    {
+        return __cu_deque_resize(dq, CU_DEQUE_DEFAULT_SIZE);
+    }
+    if (dq->capacity > (SIZE_MAX >> 1))
+    {
+        return 1;
+    }
+    return __cu_deque_resize(dq, dq->capacity << 1);
+}
+
+// "Public" function definitions
+
+CU_API int cu_deque_init(cu_deque_t *dq, size_t item_size)
+{
+    return cu_deque_init_with_allocator(dq, item_size, NULL);
+}
+
+CU_API int cu_deque_init_with_allocator(cu_deque_t *dq, size_t item_size, const cu_allocator_t *allocator)
+{
+    if (dq == NULL || dq->data != NULL || item_size == 0u)
+    {
+        return 1;
+    }
+    if (allocator != NULL && (allocator->alloc == NULL || allocator->free == NULL))
+    {
+        return 1;
+    }
+
+    *dq = (cu_deque_t){0};
+    dq->item_size = item_size;
+    dq->allocator = allocator;
+    return 0;
+}
+
+CU_API int cu_deque_deinit(cu_deque_t *dq)
+{
+    if (dq == NULL || dq->item_size == 0u)
+    {
+        return 1;
+    }
+
+    if (dq->data != NULL)
+    {
+        if (dq->allocator != NULL)
+        {
+            dq->allocator->free(dq->allocator->ctx, dq->data, dq->item_size * dq->capacity);
+        }
+        else
+        {
+            cu_free(dq->data);
+        }
+    }
+    *dq = (cu_deque_t){0};
+    return 0;
+}
+
+CU_API int cu_deque_reserve(cu_deque_t *dq, size_t new_capacity)
+{
+    if (dq == NULL || dq->item_size == 0u)
+    {
+        return 1;
+    }
+    if (new_capacity <= dq->capacity)
+    {
+        return 0;
+    }
+
+    size_t rounded = dq->capacity != 0u ? dq->capacity : CU_DEQUE_DEFAULT_SIZE;
+    while (rounded < new_capacity)
+    {
+        if (rounded > (SIZE_MAX >> 1))
+        {
+            return 1;
+        }
+        rounded <<= 1;
+    }
+    return __cu_deque_resize(dq, rounded);
+}
+
+CU_API int cu_deque_push_back(cu_deque_t *dq, const void *item)
+{
+    if (dq == NULL || dq->item_size == 0u || item == NULL)
+    {
+        return 1;
+    }
+    if (dq->length == dq->capacity && __cu_deque_grow(dq) != 0)
+    {
+        return 1;
+    }
+
+    cu_memcpy(__cu_deque_slot(dq, dq->length), item, dq->item_size);
+    dq->length += 1;
+    return 0;
+}
+
+CU_API int cu_deque_push_front(cu_deque_t *dq, const void *item)
+{
+    if (dq == NULL || dq->item_size == 0u || item == NULL)
+    {
+        return 1;
+    }
+    if (dq->length == dq->capacity && __cu_deque_grow(dq) != 0)
+    {
+        return 1;
+    }
+
+    dq->head = (dq->head + dq->capacity - 1u) & (dq->capacity - 1u);
+    cu_memcpy(__CU_ARRAY_OFFSET(dq->data, dq->item_size * dq->head), item, dq->item_size);
+    dq->length += 1;
+    return 0;
+}
+
+CU_API int cu_deque_pop_back(cu_deque_t *dq, void *out)
+{
+    if (dq == NULL || dq->item_size == 0u || dq->length == 0u)
+    {
+        return 1;
+    }
+
+    dq->length -= 1;
+    if (out != NULL)
+    {
+        cu_memcpy(out, __cu_deque_slot(dq, dq->length), dq->item_size);
+    }
+    return 0;
+}
+
+CU_API int cu_deque_pop_front(cu_deque_t *dq, void *out)
+{
+    if (dq == NULL || dq->item_size == 0u || dq->length == 0u)
+    {
+        return 1;
+    }
+
+    if (out != NULL)
+    {
+        cu_memcpy(out, __CU_ARRAY_OFFSET(dq->data, dq->item_size * dq->head), dq->item_size);
+    }
+    dq->head = (dq->head + 1u) & (dq->capacity - 1u);
+    dq->length -= 1;
+    return 0;
+}
+
+CU_API CU_UNIT *cu_deque_at(cu_deque_t *dq, size_t pos)
+{
+    if (dq == NULL || dq->item_size == 0u || pos >= dq->length)
+    {
+        return NULL;
+    }
+    return __cu_deque_slot(dq, pos);
+}
+
+CU_API int cu_deque_clear(cu_deque_t *dq)
+{
+    if (dq == NULL || dq->item_size == 0u)
+    {
+        return 1;
+    }
+    dq->head = 0;
+    dq->length = 0;
+    return 0;
+}
+
+CU_API int cu_deque_drain(cu_deque_t *dq, cu_array_t *dst)
+{
+    if (dq == NULL || dq->item_size == 0u || dst == NULL || dst->item_size != dq->item_size)
+    {
+        return 1;
+    }
+    if (dq->length == 0u)
+    {
+        return 0;
+    }
+    // One reservation up front, so the two extends can't fail halfway.
+    if (__cu_array_prepare(dst, dq->length) != 0)
+    {
+        return 1;
+    }
+
+    size_t first = dq->capacity - dq->head < dq->length ? dq->capacity - dq->head : dq->length;
+    cu_array_extend(dst, __CU_ARRAY_OFFSET(dq->data, dq->item_size * dq->head), first);
+    if (dq->length > first)
+    {
+        cu_array_extend(dst, dq->data, dq->length - first);
+    }
+    dq->head = 0;
+    dq->length = 0;
+    return 0;
+}
+
+#endif // CU_DEQUE_IMPL
@@ -0,0 +1,536 @@
+/// @file cu_map.h
+/// @brief Simple, header-only open-addressing hash map for C, built on `cu_array_t`.
+///
+/// Keys and values are fixed-size (`key_size`/`value_size` bytes) and live in two dense
+/// `cu_array_t` (`map.keys`, `map.values`), in insertion order until a removal, so iterating
+/// is a plain loop over contiguous memory. A separate Robin Hood table of `{hash, index}`
+/// slots maps keys to their position; removal shifts the following slots back, so there are
+/// no tombstones and lookups never slow down after many deletions.
+/// ```C
+/// cu_map_t map = {0};
+/// cu_map_init(&map, sizeof(uint32_t), sizeof(float), NULL, NULL); // hash and compare the bytes
+/// uint32_t id = 7; float score = 0.5f;
+/// cu_map_insert(&map, &id, &score);
+/// float *found = (float *)cu_map_get(&map, &id);
+/// for (size_t i = 0; i < map.keys.length; i++) { uint32_t *key = (uint32_t *)cu_map_key_at(&map, i); }
+/// cu_map_deinit(&map);
+/// ```
+///
+/// To include function implementations, define:
+///     #define CU_MAP_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_map_init()`
+/// - `cu_map_init_with_allocator()`
+/// - `cu_map_deinit()`
+/// - `cu_map_reserve()`
+/// - `cu_map_insert()`
+/// - `cu_map_get()`
+/// - `cu_map_find()`
+/// - `cu_map_remove()`
+/// - `cu_map_key_at()`
+/// - `cu_map_value_at()`
+/// - `cu_map_clear()`
+/// - `cu_map_hash_bytes()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_MAP_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+/// @def CU_MAP_DEFAULT_SIZE
+/// @brief Number of slots of the first table, allocated lazily by the first insert. Must be a power of two (default: 16).
+/// @def CU_MAP_MAX_LOAD
+/// @brief Maximum load of the table, in eighths: the table doubles once more than `CU_MAP_MAX_LOAD / 8` of the slots are used (default: 7).
+
+#ifndef CU_MAP_H
+#define CU_MAP_H
+
+#include "cu_array.h"
+
+/// @brief Hashes the `key_size` bytes at `key`. Equal keys must have equal hashes.
+typedef size_t (*cu_map_hash_t)(const void *key, size_t key_size);
+/// @brief Returns non-zero if the keys at `a` and `b` are equal.
+typedef int (*cu_map_eq_t)(const void *a, const void *b, size_t key_size);
+
+typedef struct cu_map_slot_s
+{
+    /// Index of the entry in `keys`/`values` plus one, `0` for an empty slot.
+    size_t entry;
+    size_t hash;
+} cu_map_slot_t;
+
+typedef struct cu_map_s
+{
+    /// Dense storage, `keys.length` entries. `values` is unused when `value_size` is `0` (a set).
+    cu_array_t keys;
+    cu_array_t values;
+    cu_map_slot_t *slots;
+    /// Number of slots, always `0` or a power of two.
+    size_t capacity;
+    cu_map_hash_t hash;
+    cu_map_eq_t eq;
+    const cu_allocator_t *allocator;
+} cu_map_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes a map. Storage is allocated lazily by the first insert.
+    /// @param map Pointer to the map.
+    /// @param key_size Size of a key in bytes.
+    /// @param value_size Size of a value in bytes, `0` for a set of keys.
+    /// @param hash Hash function, `NULL` for `cu_map_hash_bytes`.
+    /// @param eq Equality function, `NULL` to compare the bytes of the keys.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_map_init(cu_map_t *map, size_t key_size, size_t value_size, cu_map_hash_t hash, cu_map_eq_t eq);
+
+    /// @brief Same as `cu_map_init`, but the table and the dense storage come from `allocator`.
+    /// @param map Pointer to the map.
+    /// @param key_size Size of a key in bytes.
+    /// @param value_size Size of a value in bytes, `0` for a set of keys.
+    /// @param hash Hash function, `NULL` for `cu_map_hash_bytes`.
+    /// @param eq Equality function, `NULL` to compare the bytes of the keys.
+    /// @param allocator Allocator, `NULL` for `cu_malloc`/`cu_realloc`/`cu_free`. Must outlive the map.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_map_init_with_allocator(cu_map_t *map, size_t key_size, size_t value_size, cu_map_hash_t hash,
+                                          cu_map_eq_t eq, const cu_allocator_t *allocator);
+
+    /// @brief Frees everything and sets the map to zero.
+    /// @param map Pointer to the map.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_map_deinit(cu_map_t *map);
+
+    /// @brief Makes sure the map can hold at least `new_capacity` entries without growing.
+    /// @param map Pointer to the map.
+    /// @param new_capacity Number of entries.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_map_reserve(cu_map_t *map, size_t new_capacity);
+
+    /// @brief Inserts a copy of `key` and `value`, or overwrites the value if `key` is already present.
+    /// @param map Pointer to the map.
+    /// @param key Pointer to the key.
+    /// @param value Pointer to the value, ignored for a set.
+    /// @return `0` on success, `1` on error (the map is unchanged).
+    CU_API int cu_map_insert(cu_map_t *map, const void *key, const void *value);
+
+    /// @brief Returns a pointer to the value of `key` (to the stored key for a set).
+    /// @note Any insert or removal can move the values.
+    /// @param map Pointer to the map.
+    /// @param key Pointer to the key.
+    /// @return Pointer to the value, `NULL` if `key` is not present or on error.
+    CU_API CU_UNIT *cu_map_get(cu_map_t *map, const void *key);
+
+    /// @brief Returns the index of `key` in the dense storage.
+    /// @param map Pointer to the map.
+    /// @param key Pointer to the key.
+    /// @return Index of the entry, `map->keys.length` if `key` is not present or on error.
+    CU_API size_t cu_map_find(cu_map_t *map, const void *key);
+
+    /// @brief Removes `key` and its value.
+    /// @note The last entry moves into the hole, so indices and pointers of that entry change.
+    /// @param map Pointer to the map.
+    /// @param key Pointer to the key.
+    /// @return `0` if the entry was removed, `1` if `key` is not present or on error.
+    CU_API int cu_map_remove(cu_map_t *map, const void *key);
+
+    /// @brief Returns a pointer to the key of entry `pos` of the dense storage.
+    /// @param map Pointer to the map.
+    /// @param pos Index of the entry, below `map->keys.length`.
+    /// @return Pointer to the key on success, `NULL` on error.
+    CU_API CU_UNIT *cu_map_key_at(cu_map_t *map, size_t pos);
+
+    /// @brief Returns a pointer to the value of entry `pos` of the dense storage.
+    /// @param map Pointer to the map.
+    /// @param pos Index of the entry, below `map->keys.length`.
+    /// @return Pointer to the value on success, `NULL` on error or for a set.
+    CU_API CU_UNIT *cu_map_value_at(cu_map_t *map, size_t pos);
+
+    /// @brief Removes every entry, capacity stays the same.
+    /// @param map Pointer to the map.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_map_clear(cu_map_t *map);
+
+    /// @brief Default hash: FNV-1a over the bytes, followed by a 64-bit finalizer so the low bits are well mixed.
+    /// @param key Pointer to the key.
+    /// @param key_size Size of the key in bytes.
+    /// @return Hash of the key.
+    CU_API size_t cu_map_hash_bytes(const void *key, size_t key_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_MAP_H
+
+#ifdef CU_MAP_IMPL
+
+#ifndef cu_malloc
+#define cu_malloc malloc
+#endif // cu_malloc
+#ifndef cu_free
+#define cu_free free
+#endif // cu_free
+#ifndef cu_memcpy
+#define cu_memcpy memcpy
+#endif // cu_memcpy
+#ifndef cu_memcmp
+#define cu_memcmp memcmp
+#endif // cu_memcmp
+#ifndef CU_MAP_DEFAULT_SIZE
+#define CU_MAP_DEFAULT_SIZE (16u)
+#endif // CU_MAP_DEFAULT_SIZE
+#ifndef CU_MAP_MAX_LOAD
+#define CU_MAP_MAX_LOAD (7u)
+#endif // CU_MAP_MAX_LOAD
+
+// Definitions
+
+// Helper functions, not "public"
+
+CU_API int __cu_map_eq_bytes(const void *a, const void *b, size_t key_size)
+{
+    return cu_memcmp(a, b, key_size) == 0;
+}
+
+CU_API void __cu_map_free_slots(cu_map_t *map)
+{
+    if (map->slots == NULL)
+    {
+        return;
+    }
+    if (map->allocator != NULL)
+    {
+        map->allocator->free(map->allocator->ctx, map->slots, sizeof(cu_map_slot_t) * map->capacity);
+    }
+    else
+    {
+        cu_free(map->slots);
+    }
+}
+
+// Returns the slot holding `key` (with hash `hash`), or `map->capacity` if there is none.
+CU_API size_t __cu_map_lookup(cu_map_t *map, const void *key, size_t hash)
+{
+    if (map->capacity == 0u)
+    {
+        return 0;
+    }
+    size_t mask = map->capacity - 1u;
+    size_t pos = hash & mask;
+    for (size_t dist = 0;; dist++, pos = (pos + 1u) & mask)
+    {
+        cu_map_slot_t *slot = &map->slots[pos];
+        // Robin Hood invariant: `key` would have displaced any entry closer to its home slot.
+        if (slot->entry == 0u || ((pos - slot->hash) & mask) < dist)
+        {
+            return map->capacity;
+        }
+        if (slot->hash == hash && map->eq(__CU_ARRAY_OFFSET(map->keys.data, map->keys.item_size * (slot->entry - 1u)), key,
+                                          map->keys.item_size))
+        {
+            return pos;
+        }
+    }
+}
+
+// Places a slot known to be absent, displacing richer slots along the way. Needs a free slot.
+CU_API void __cu_map_place(cu_map_slot_t *slots, size_t mask, cu_map_slot_t carry)
+{
+    size_t pos = carry.hash & mask;
+    for (size_t dist = 0;; dist++, pos = (pos + 1u) & mask)
+    {
+        if (slots[pos].entry == 0u)
+        {
+            slots[pos] = carry;
+            return;
+        }
+        size_t other = (pos - slots[pos].hash) & mask;
+        if (other < dist)
+        {
+            cu_map_slot_t tmp = slots[pos];
+            slots[pos] = carry;
+            carry = tmp;
+            dist = other;
+        }
+    }
+}
+
+CU_API int __cu_map_rehash(cu_map_t *map, size_t new_capacity)
+{
+    if (new_capacity > SIZE_MAX / sizeof(cu_map_slot_t))
+    {
+        return 1;
+    }
+    size_t bytes = sizeof(cu_map_slot_t) * new_capacity;
+    cu_map_slot_t *slots = (cu_map_slot_t *)(map->allocator != NULL ? map->allocator->alloc(map->allocator->ctx, bytes)
+                                                                    : cu_malloc(bytes));
+    if (slots == NULL)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < new_capacity; i++)
+    {
+        slots[i] = (cu_map_slot_t){0};
+    }
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        if (map->slots[i].entry != 0u)
+        {
+            __cu_map_place(slots, new_capacity - 1u, map->slots[i]);
+        }
+    }
+    __cu_map_free_slots(map);
+    map->slots = slots;
+    map->capacity = new_capacity;
+    return 0;
+}
+
+// Smallest table that holds `entries` within the maximum load.
+CU_API int __cu_map_fit(cu_map_t *map, size_t entries)
+{
+    if (entries > SIZE_MAX / 8u)
+    {
+        return 1;
+    }
+    size_t capacity = map->capacity != 0u ? map->capacity : CU_MAP_DEFAULT_SIZE;
+    while (entries * 8u > capacity * CU_MAP_MAX_LOAD)
+    {
+        if (capacity > (SIZE_MAX >> 1) / 8u)
+        {
+            return 1;
+        }
+        capacity <<= 1;
+    }
+    return capacity == map->capacity ? 0 : __cu_map_rehash(map, capacity);
+}
+
+// "Public" function definitions
+
+CU_API int cu_map_init(cu_map_t *map, size_t key_size, size_t value_size, cu_map_hash_t hash, cu_map_eq_t eq)
+{
+    return cu_map_init_with_allocator(map, key_size, value_size, hash, eq, NULL);
+}
+
+CU_API int cu_map_init_with_allocator(cu_map_t *map, size_t key_size, size_t value_size, cu_map_hash_t hash,
+                                      cu_map_eq_t eq, const cu_allocator_t *allocator)
+{
+    if (map == NULL || map->keys.item_size != 0u || key_size == 0u)
+    {
+        return 1;
+    }
+    if (allocator != NULL && (allocator->alloc == NULL || allocator->free == NULL))
+    {
+        return 1;
+    }
+
+    cu_map_t tmp = (cu_map_t){0};
+    if (cu_array_init_with_allocator(&tmp.keys, key_size, allocator) != 0)
+    {
+        return 1;
+    }
+    if (value_size != 0u && cu_array_init_with_allocator(&tmp.values, value_size, allocator) != 0)
+    {
+        cu_array_deinit(&tmp.keys);
+        return 1;
+    }
+    tmp.hash = hash != NULL ? hash : cu_map_hash_bytes;
+    tmp.eq = eq != NULL ? eq : __cu_map_eq_bytes;
+    tmp.allocator = allocator;
+    *map = tmp;
+    return 0;
+}
+
+CU_API int cu_map_deinit(cu_map_t *map)
+{
+    if (map == NULL || map->keys.item_size == 0u)
+    {
+        return 1;
+    }
+
+    __cu_map_free_slots(map);
+    cu_array_deinit(&map->keys);
+    if (map->values.item_size != 0u)
+    {
+        cu_array_deinit(&map->values);
+    }
+    *map = (cu_map_t){0};
+    return 0;
+}
+
+CU_API int cu_map_reserve(cu_map_t *map, size_t new_capacity)
+{
+    if (map == NULL || map->keys.item_size == 0u)
+    {
+        return 1;
+    }
+    if (__cu_map_fit(map, new_capacity) != 0 || cu_array_reserve(&map->keys, new_capacity) != 0)
+    {
+        return 1;
+    }
+    if (map->values.item_size != 0u && cu_array_reserve(&map->values, new_capacity) != 0)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+CU_API int cu_map_insert(cu_map_t *map, const void *key, const void *value)
+{
+    if (map == NULL || map->keys.item_size == 0u || key == NULL || (map->values.item_size != 0u && value == NULL))
+    {
+        return 1;
+    }
+
+    size_t hash = map->hash(key, map->keys.item_size);
+    size_t pos = __cu_map_lookup(map, key, hash);
+    if (pos != map->capacity)
+    {
+        if (map->values.item_size != 0u)
+        {
+            cu_memcpy(__CU_ARRAY_OFFSET(map->values.data, map->values.item_size * (map->slots[pos].entry - 1u)), value,
+                      map->values.item_size);
+        }
+        return 0;
+    }
+
+    // Make room everywhere first, so a failed allocation leaves the map untouched.
+    size_t index = map->keys.length;
+    if (__cu_map_fit(map, index + 1u) != 0 || __cu_array_prepare(&map->keys, 1) != 0 ||
+        (map->values.item_size != 0u && __cu_array_prepare(&map->values, 1) != 0))
+    {
+        return 1;
+    }
+    cu_memcpy(__CU_ARRAY_OFFSET(map->keys.data, map->keys.item_size * index), key, map->keys.item_size);
+    map->keys.length += 1;
+    if (map->values.item_size != 0u)
+    {
+        cu_memcpy(__CU_ARRAY_OFFSET(map->values.data, map->values.item_size * index), value, map->values.item_size);
+        map->values.length += 1;
+    }
+    __cu_map_place(map->slots, map->capacity - 1u, (cu_map_slot_t){index + 1u, hash});
+    return 0;
+}
+
+CU_API CU_UNIT *cu_map_get(cu_map_t *map, const void *key)
+{
+    size_t index = cu_map_find(map, key);
+    if (map == NULL || index >= map->keys.length)
+    {
+        return NULL;
+    }
+    return map->values.item_size != 0u ? __CU_ARRAY_OFFSET(map->values.data, map->values.item_size * index)
+                                       : __CU_ARRAY_OFFSET(map->keys.data, map->keys.item_size * index);
+}
+
+CU_API size_t cu_map_find(cu_map_t *map, const void *key)
+{
+    if (map == NULL || map->keys.item_size == 0u || key == NULL)
+    {
+        return map != NULL ? map->keys.length : 0u;
+    }
+    size_t pos = __cu_map_lookup(map, key, map->hash(key, map->keys.item_size));
+    return pos == map->capacity ? map->keys.length : map->slots[pos].entry - 1u;
+}
+
+CU_API int cu_map_remove(cu_map_t *map, const void *key)
+{
+    if (map == NULL || map->keys.item_size == 0u || key == NULL)
+    {
+        return 1;
+    }
+    size_t pos = __cu_map_lookup(map, key, map->hash(key, map->keys.item_size));
+    if (pos == map->capacity)
+    {
+        return 1;
+    }
+
+    size_t mask = map->capacity - 1u;
+    size_t index = map->slots[pos].entry - 1u;
+    // Backward shift: pull every following displaced slot one step closer to its home.
+    for (size_t next = (pos + 1u) & mask;
+         map->slots[next].entry != 0u && ((next - map->slots[next].hash) & mask) != 0u; next = (next + 1u) & mask)
+    {
+        map->slots[pos] = map->slots[next];
+        pos = next;
+    }
+    map->slots[pos] = (cu_map_slot_t){0};
+
+    // The last entry fills the hole in the dense storage, its slot has to follow.
+    size_t last = map->keys.length - 1u;
+    if (index != last)
+    {
+        CU_UNIT *moved = __CU_ARRAY_OFFSET(map->keys.data, map->keys.item_size * last);
+        pos = map->hash(moved, map->keys.item_size) & mask;
+        while (map->slots[pos].entry != last + 1u)
+        {
+            pos = (pos + 1u) & mask;
+        }
+        map->slots[pos].entry = index + 1u;
+    }
+    cu_array_swap_remove(&map->keys, index);
+    if (map->values.item_size != 0u)
+    {
+        cu_array_swap_remove(&map->values, index);
+    }
+    return 0;
+}
+
+CU_API CU_UNIT *cu_map_key_at(cu_map_t *map, size_t pos)
+{
+    if (map == NULL || pos >= map->keys.length)
+    {
+        return NULL;
+    }
+    return __CU_ARRAY_OFFSET(map->keys.data, map->keys.item_size * pos);
+}
+
+CU_API CU_UNIT *cu_map_value_at(cu_map_t *map, size_t pos)
+{
+    if (map == NULL || map->values.item_size == 0u || pos >= map->values.length)
+    {
+        return NULL;
+    }
+    return __CU_ARRAY_OFFSET(map->values.data, map->values.item_size * pos);
+}
+
+CU_API int cu_map_clear(cu_map_t *map)
+{
+    if (map == NULL || map->keys.item_size == 0u)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        map->slots[i] = (cu_map_slot_t){0};
+    }
+    cu_array_clear(&map->keys);
+    if (map->values.item_size != 0u)
+    {
+        cu_array_clear(&map->values);
+    }
+    return 0;
+}
+
+CU_API size_t cu_map_hash_bytes(const void *key, size_t key_size)
+{
+    const unsigned char *bytes = (const unsigned char *)key;
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < key_size; i++)
+    {
+        h = (h ^ bytes[i]) * 0x100000001b3ull;
+    }
+    // splitmix64 finalizer, FNV alone leaves the low bits (the home slot) poorly mixed.
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return (size_t)h;
+}
+
+#endif // CU_MAP_IMPL
@@ -0,0 +1,677 @@
+/// @file cu_ring.h
+/// @brief Simple, header-only lock-free ring buffer for passing items between threads.
+///
+/// A fixed-capacity ring of `item_size` byte items, with the same generic design as `cu_array_t`.
+/// The default ring is single-producer/single-consumer (one thread pushes, one thread pops),
+/// `cu_ring_init_mpmc()` makes one that any number of threads can push to and pop from:
+/// ```C
+/// cu_ring_t ring = {0};
+/// cu_ring_init(&ring, sizeof(int), 1024);
+/// // producer thread
+/// int x = 42;
+/// while (cu_ring_push(&ring, &x) != 0) { /* full */ }
+/// // consumer thread
+/// int y;
+/// while (cu_ring_pop(&ring, &y) != 0) { /* empty */ }
+/// ```
+/// Single-producer/single-consumer rings can also be filled and drained in place, without copies:
+/// ```C
+/// CU_UNIT *slots;
+/// size_t n = cu_ring_reserve(&ring, 64, &slots); // up to 64 contiguous free slots
+/// ... write n items to slots ...
+/// cu_ring_commit(&ring, n);                        // the consumer can see them now
+/// ```
+///
+/// The head and tail live on separate cache lines, each side only reads the other side's
+/// position when its cached copy says the ring is full (or empty).
+///
+/// Uses C11 `<stdatomic.h>` when available, the GCC/Clang `__atomic` builtins otherwise (e.g. with `-std=c99`).
+///
+/// To include function implementations, define:
+///     #define CU_RING_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_ring_init()`
+/// - `cu_ring_init_mpmc()`
+/// - `cu_ring_init_with_allocator()`
+/// - `cu_ring_deinit()`
+/// - `cu_ring_push()`
+/// - `cu_ring_pop()`
+/// - `cu_ring_push_n()`
+/// - `cu_ring_pop_n()`
+/// - `cu_ring_reserve()`
+/// - `cu_ring_commit()`
+/// - `cu_ring_peek()`
+/// - `cu_ring_consume()`
+/// - `cu_ring_size()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_RING_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+/// @def CU_API
+/// @brief Override linkage keyword (default: extern or empty if CU_RING_IMPL is defined).
+/// @def CU_UNIT
+/// @brief Type used for raw ring storage (default: unsigned char). Item sizes stay in bytes and must be a multiple
+///        of `sizeof(CU_UNIT)`.
+/// @def CU_RING_CACHE_LINE
+/// @brief Size of a cache line, the head and the tail are kept this far apart (default: 64).
+/// @def CU_NO_LIBC
+/// @brief Disable all standard library includes. You should define cu_malloc, cu_free, cu_memcpy.
+/// @def CU_NO_STDLIB_H
+/// @brief Disable inclusion of <stdlib.h>. You should define cu_malloc, cu_free.
+/// @def CU_NO_STRINGS_H
+/// @brief Disable inclusion of <string.h>. You should define cu_memcpy.
+
+#ifndef CU_RING_H
+#define CU_RING_H
+
+#ifndef CU_API
+#ifdef CU_RING_IMPL
+#define CU_API
+#else
+#define CU_API extern
+#endif // CU_RING_IMPL
+#endif // CU_API
+
+#ifndef CU_UNIT
+#define CU_UNIT unsigned char
+#endif // CU_UNIT
+
+#if (!defined(CU_NO_STDLIB_H)) && (!defined(CU_NO_LIBC))
+#include <stdlib.h>
+#endif // (!defined(CU_NO_STDLIB_H)) && (!defined(CU_NO_LIBC))
+
+#if defined(CU_NO_STDLIB_H) || defined(CU_NO_LIBC)
+#include <stddef.h>
+#endif // defined(CU_NO_STDLIB_H) || defined(CU_NO_LIBC)
+
+#if (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
+#include <string.h>
+#endif // (!defined(CU_NO_STRINGS_H)) && (!defined(CU_NO_LIBC))
+
+#include <stdint.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef _Atomic size_t __cu_ring_atomic_t;
+#define __CU_RING_RELAXED memory_order_relaxed
+#define __CU_RING_ACQUIRE memory_order_acquire
+#define __CU_RING_RELEASE memory_order_release
+#define __CU_RING_LOAD(p, order) atomic_load_explicit((p), (order))
+#define __CU_RING_STORE(p, v, order) atomic_store_explicit((p), (v), (order))
+#define __CU_RING_CAS_WEAK(p, expected, desired) \
+    atomic_compare_exchange_weak_explicit((p), (expected), (desired), memory_order_relaxed, memory_order_relaxed)
+#elif defined(__GNUC__) || defined(__clang__)
+typedef size_t __cu_ring_atomic_t;
+#define __CU_RING_RELAXED __ATOMIC_RELAXED
+#define __CU_RING_ACQUIRE __ATOMIC_ACQUIRE
+#define __CU_RING_RELEASE __ATOMIC_RELEASE
+#define __CU_RING_LOAD(p, order) __atomic_load_n((p), (order))
+#define __CU_RING_STORE(p, v, order) __atomic_store_n((p), (v), (order))
+#define __CU_RING_CAS_WEAK(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#else
+#error "cu_ring.h needs C11 atomics or the GCC/Clang __atomic builtins"
+#endif
+
+#ifndef CU_RING_CACHE_LINE
+#define CU_RING_CACHE_LINE (64u)
+#endif // CU_RING_CACHE_LINE
+
+/// @brief Any thread can push and pop (`cu_ring_t.flags`).
+#define CU_RING_MPMC (1u)
+
+#ifndef CU_ALLOCATOR_DEFINED
+#define CU_ALLOCATOR_DEFINED
+/// @brief Allocator interface, shared by all `cu_*` headers.
+/// @note The sizes passed to `realloc` and `free` are the sizes of the original allocation,
+///       so simple allocators (e.g. arenas) don't have to track them.
+typedef struct cu_allocator_s
+{
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} cu_allocator_t;
+#endif // CU_ALLOCATOR_DEFINED
+
+typedef struct cu_ring_s
+{
+    // Set by init, only read afterwards.
+    CU_UNIT *data;
+    /// Per-slot sequence numbers, only for `CU_RING_MPMC` rings.
+    __cu_ring_atomic_t *sequences;
+    size_t item_size;
+    size_t capacity;
+    const cu_allocator_t *allocator;
+    unsigned int flags;
+    char __pad0[CU_RING_CACHE_LINE];
+
+    // Consumer side: the next position to read and the last producer position it saw.
+    __cu_ring_atomic_t head;
+    size_t cached_tail;
+    char __pad1[CU_RING_CACHE_LINE - 2u * sizeof(size_t)];
+
+    // Producer side: the next position to write and the last consumer position it saw.
+    __cu_ring_atomic_t tail;
+    size_t cached_head;
+    char __pad2[CU_RING_CACHE_LINE - 2u * sizeof(size_t)];
+} cu_ring_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes a single-producer/single-consumer ring and allocates its storage.
+    /// @param ring Pointer to the ring.
+    /// @param item_size Size of every item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param capacity Number of items, rounded up to a power of two.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_ring_init(cu_ring_t *ring, size_t item_size, size_t capacity);
+
+    /// @brief Initializes a multi-producer/multi-consumer ring and allocates its storage.
+    /// @note Every slot gets a sequence number, so pushes and pops from many threads never lock.
+    ///       `cu_ring_reserve()` and `cu_ring_peek()` aren't supported on these rings.
+    /// @param ring Pointer to the ring.
+    /// @param item_size Size of every item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param capacity Number of items, rounded up to a power of two (at least 2).
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_ring_init_mpmc(cu_ring_t *ring, size_t item_size, size_t capacity);
+
+    /// @brief Same as `cu_ring_init` and `cu_ring_init_mpmc`, but the storage comes from `allocator`.
+    /// @param ring Pointer to the ring.
+    /// @param item_size Size of every item in bytes, a multiple of `sizeof(CU_UNIT)`.
+    /// @param capacity Number of items, rounded up to a power of two.
+    /// @param flags `0` or `CU_RING_MPMC`.
+    /// @param allocator Allocator, `NULL` for `cu_malloc`/`cu_free`. Must outlive the ring.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_ring_init_with_allocator(cu_ring_t *ring, size_t item_size, size_t capacity, unsigned int flags,
+                                           const cu_allocator_t *allocator);
+
+    /// @brief Frees the storage and sets everything to zero. No other thread may be using the ring.
+    /// @param ring Pointer to the ring.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_ring_deinit(cu_ring_t *ring);
+
+    /// @brief Copies `item` into the ring.
+    /// @param ring Pointer to the ring.
+    /// @param item Pointer to the item.
+    /// @return `0` on success, `1` if the ring is full or on error.
+    CU_API int cu_ring_push(cu_ring_t *ring, const void *item);
+
+    /// @brief Copies the oldest item into `out` and removes it from the ring.
+    /// @param ring Pointer to the ring.
+    /// @param out Pointer to `item_size` bytes.
+    /// @return `0` on success, `1` if the ring is empty or on error.
+    CU_API int cu_ring_pop(cu_ring_t *ring, void *out);
+
+    /// @brief Pushes up to `num_items` items, publishing them all at once on single-producer rings.
+    /// @param ring Pointer to the ring.
+    /// @param items Pointer to `num_items` contiguous items.
+    /// @param num_items Number of items.
+    /// @return Number of items pushed, less than `num_items` if the ring got full.
+    CU_API size_t cu_ring_push_n(cu_ring_t *ring, const void *items, size_t num_items);
+
+    /// @brief Pops up to `num_items` items into `out`, oldest first.
+    /// @param ring Pointer to the ring.
+    /// @param out Pointer to room for `num_items` items.
+    /// @param num_items Maximum number of items.
+    /// @return Number of items popped, less than `num_items` if the ring got empty.
+    CU_API size_t cu_ring_pop_n(cu_ring_t *ring, void *out, size_t num_items);
+
+    /// @brief Reserves up to `num_items` contiguous free slots for the producer to write in place.
+    /// @note Single-producer/single-consumer rings only. Fewer slots are returned when the ring is
+    ///       almost full or the free space wraps around the end of the storage.
+    /// @param ring Pointer to the ring.
+    /// @param num_items Number of slots wanted.
+    /// @param slots Receives a pointer to the first slot. Step to the next slot by `item_size` bytes
+    ///        (e.g. through `unsigned char *`), not with `CU_UNIT` pointer arithmetic.
+    /// @return Number of reserved slots, `0` if the ring is full or on error.
+    CU_API size_t cu_ring_reserve(cu_ring_t *ring, size_t num_items, CU_UNIT **slots);
+
+    /// @brief Publishes the first `num_items` slots returned by `cu_ring_reserve()` to the consumer.
+    /// @param ring Pointer to the ring.
+    /// @param num_items Number of written slots, at most what `cu_ring_reserve()` returned.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_ring_commit(cu_ring_t *ring, size_t num_items);
+
+    /// @brief Gives the consumer up to `num_items` contiguous items to read in place.
+    /// @note Single-producer/single-consumer rings only. The items stay in the ring until `cu_ring_consume()`.
+    /// @param ring Pointer to the ring.
+    /// @param num_items Number of items wanted.
+    /// @param items Receives a pointer to the oldest item. Step to the next item by `item_size` bytes
+    ///        (e.g. through `unsigned char *`), not with `CU_UNIT` pointer arithmetic.
+    /// @return Number of readable items, `0` if the ring is empty or on error.
+    CU_API size_t cu_ring_peek(cu_ring_t *ring, size_t num_items, CU_UNIT **items);
+
+    /// @brief Removes the first `num_items` items returned by `cu_ring_peek()`, giving their slots back to the producer.
+    /// @param ring Pointer to the ring.
+    /// @param num_items Number of read items, at most what `cu_ring_peek()` returned.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_ring_consume(cu_ring_t *ring, size_t num_items);
+
+    /// @brief Returns the number of items in the ring.
+    /// @note Only a snapshot if other threads are pushing or popping.
+    /// @param ring Pointer to the ring.
+    /// @return Number of items, `0` on error.
+    CU_API size_t cu_ring_size(cu_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_RING_H
+
+#ifdef CU_RING_IMPL
+
+#ifndef cu_malloc
+#define cu_malloc malloc
+#endif // cu_malloc
+#ifndef cu_free
+#define cu_free free
+#endif // cu_free
+#ifndef cu_memcpy
+#define cu_memcpy memcpy
+#endif // cu_memcpy
+
+// Definitions
+
+// Helper functions, not "public"
+
+CU_API void *__cu_ring_alloc(const cu_allocator_t *allocator, size_t size)
+{
+    return allocator != NULL ? allocator->alloc(allocator->ctx, size) : cu_malloc(size);
+}
+
+CU_API void __cu_ring_free(const cu_allocator_t *allocator, void *ptr, size_t size)
+{
+    if (allocator != NULL)
+    {
+        allocator->free(allocator->ctx, ptr, size);
+        return;
+    }
+    (void)size;
+    cu_free(ptr);
+}
+
+// Pointer `bytes` past `ptr`, sizes are in bytes whatever `CU_UNIT` is.
+#define __CU_RING_OFFSET(ptr, bytes) ((CU_UNIT *)(void *)((unsigned char *)(ptr) + (bytes)))
+#define __CU_RING_OFFSET_CONST(ptr, bytes) ((const CU_UNIT *)(const void *)((const unsigned char *)(ptr) + (bytes)))
+
+CU_API CU_UNIT *__cu_ring_slot(cu_ring_t *ring, size_t pos)
+{
+    return __CU_RING_OFFSET(ring->data, ring->item_size * (pos & (ring->capacity - 1u)));
+}
+
+// Bounded MPMC queue with a sequence number per slot (D. Vyukov). A slot is free for the producer
+// at position `pos` when its sequence is `pos`, and full for the consumer when it is `pos + 1`.
+
+CU_API int __cu_ring_push_mpmc(cu_ring_t *ring, const void *item)
+{
+    size_t pos = __CU_RING_LOAD(&ring->tail, __CU_RING_RELAXED);
+    for (;;)
+    {
+        __cu_ring_atomic_t *seq = &ring->sequences[pos & (ring->capacity - 1u)];
+        intptr_t diff = (intptr_t)__CU_RING_LOAD(seq, __CU_RING_ACQUIRE) - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (__CU_RING_CAS_WEAK(&ring->tail, &pos, pos + 1u))
+            {
+                cu_memcpy(__cu_ring_slot(ring, pos), item, ring->item_size);
+                __CU_RING_STORE(seq, pos + 1u, __CU_RING_RELEASE);
+                return 0;
+            }
+            // `pos` was updated by the failed exchange.
+        }
+        else if (diff < 0)
+        {
+            return 1;
+        }
+        else
+        {
+            pos = __CU_RING_LOAD(&ring->tail, __CU_RING_RELAXED);
+        }
+    }
+}
+
+CU_API int __cu_ring_pop_mpmc(cu_ring_t *ring, void *out)
+{
+    size_t pos = __CU_RING_LOAD(&ring->head, __CU_RING_RELAXED);
+    for (;;)
+    {
+        __cu_ring_atomic_t *seq = &ring->sequences[pos & (ring->capacity - 1u)];
+        intptr_t diff = (intptr_t)__CU_RING_LOAD(seq, __CU_RING_ACQUIRE) - (intptr_t)(pos + 1u);
+        if (diff == 0)
+        {
+            if (__CU_RING_CAS_WEAK(&ring->head, &pos, pos + 1u))
+            {
+                cu_memcpy(out, __cu_ring_slot(ring, pos), ring->item_size);
+                __CU_RING_STORE(seq, pos + ring->capacity, __CU_RING_RELEASE);
+                return 0;
+            }
+        }
+        else if (diff < 0)
+        {
+            return 1;
+        }
+        else
+        {
+            pos = __CU_RING_LOAD(&ring->head, __CU_RING_RELAXED);
+        }
+    }
+}
+
+// Free slots seen by the single producer, looks at the consumer's line only if the cached head isn't enough.
+CU_API size_t __cu_ring_free_slots(cu_ring_t *ring, size_t tail, size_t wanted)
+{
+    size_t free_slots = ring->capacity - (tail - ring->cached_head);
+    if (free_slots < wanted)
+    {
+        ring->cached_head = __CU_RING_LOAD(&ring->head, __CU_RING_ACQUIRE);
+        free_slots = ring->capacity - (tail - ring->cached_head);
+    }
+    return free_slots;
+}
+
+// Items seen by the single consumer, looks at the producer's line only if the cached tail isn't enough.
+CU_API size_t __cu_ring_used_slots(cu_ring_t *ring, size_t head, size_t wanted)
+{
+    size_t used = ring->cached_tail - head;
+    if (used < wanted)
+    {
+        ring->cached_tail = __CU_RING_LOAD(&ring->tail, __CU_RING_ACQUIRE);
+        used = ring->cached_tail - head;
+    }
+    return used;
+}
+
+// "Public" function definitions
+
+CU_API int cu_ring_init(cu_ring_t *ring, size_t item_size, size_t capacity)
+{
+    return cu_ring_init_with_allocator(ring, item_size, capacity, 0u, NULL);
+}
+
+CU_API int cu_ring_init_mpmc(cu_ring_t *ring, size_t item_size, size_t capacity)
+{
+    return cu_ring_init_with_allocator(ring, item_size, capacity, CU_RING_MPMC, NULL);
+}
+
+CU_API int cu_ring_init_with_allocator(cu_ring_t *ring, size_t item_size, size_t capacity, unsigned int flags,
+                                       const cu_allocator_t *allocator)
+{
+    if (ring == NULL || ring->data != NULL || item_size == 0u || item_size % sizeof(CU_UNIT) != 0u || capacity == 0u ||
+        (flags & ~CU_RING_MPMC) != 0u)
+    {
+        return 1;
+    }
+    if (allocator != NULL && (allocator->alloc == NULL || allocator->free == NULL))
+    {
+        return 1;
+    }
+
+    // With a single slot a sequence number can't tell "free" from "full".
+    size_t rounded = (flags & CU_RING_MPMC) ? 2u : 1u;
+    while (rounded < capacity)
+    {
+        if (rounded > (SIZE_MAX >> 1))
+        {
+            return 1;
+        }
+        rounded <<= 1;
+    }
+    if (rounded > SIZE_MAX / item_size || rounded > SIZE_MAX / sizeof(__cu_ring_atomic_t))
+    {
+        return 1;
+    }
+
+    CU_UNIT *data = (CU_UNIT *)__cu_ring_alloc(allocator, item_size * rounded);
+    if (data == NULL)
+    {
+        return 1;
+    }
+    __cu_ring_atomic_t *sequences = NULL;
+    if (flags & CU_RING_MPMC)
+    {
+        sequences = (__cu_ring_atomic_t *)__cu_ring_alloc(allocator, sizeof(__cu_ring_atomic_t) * rounded);
+        if (sequences == NULL)
+        {
+            __cu_ring_free(allocator, data, item_size * rounded);
+            return 1;
+        }
+        for (size_t i = 0; i < rounded; i++)
+        {
+            __CU_RING_STORE(&sequences[i], i, __CU_RING_RELAXED);
+        }
+    }
+
+    ring->data = data;
+    ring->sequences = sequences;
+    ring->item_size = item_size;
+    ring->capacity = rounded;
+    ring->allocator = allocator;
+    ring->flags = flags;
+    __CU_RING_STORE(&ring->head, 0u, __CU_RING_RELAXED);
+    ring->cached_tail = 0;
+    __CU_RING_STORE(&ring->tail, 0u, __CU_RING_RELAXED);
+    ring->cached_head = 0;
+    return 0;
+}
+
+CU_API int cu_ring_deinit(cu_ring_t *ring)
+{
+    if (ring == NULL || ring->item_size == 0u)
+    {
+        return 1;
+    }
+
+    __cu_ring_free(ring->allocator, ring->data, ring->item_size * ring->capacity);
+    if (ring->sequences != NULL)
+    {
+        __cu_ring_free(ring->allocator, ring->sequences, sizeof(__cu_ring_atomic_t) * ring->capacity);
+    }
+    ring->data = NULL;
+    ring->sequences = NULL;
+    ring->item_size = 0;
+    ring->capacity = 0;
+    ring->allocator = NULL;
+    ring->flags = 0;
+    __CU_RING_STORE(&ring->head, 0u, __CU_RING_RELAXED);
+    ring->cached_tail = 0;
+    __CU_RING_STORE(&ring->tail, 0u, __CU_RING_RELAXED);
+    ring->cached_head = 0;
+    return 0;
+}
+
+CU_API int cu_ring_push(cu_ring_t *ring, const void *item)
+{
+    if (ring == NULL || ring->item_size == 0u || item == NULL)
+    {
+        return 1;
+    }
+    if (ring->flags & CU_RING_MPMC)
+    {
+        return __cu_ring_push_mpmc(ring, item);
+    }
+
+    size_t tail = __CU_RING_LOAD(&ring->tail, __CU_RING_RELAXED);
+    if (__cu_ring_free_slots(ring, tail, 1u) == 0u)
+    {
+        return 1;
+    }
+    cu_memcpy(__cu_ring_slot(ring, tail), item, ring->item_size);
+    __CU_RING_STORE(&ring->tail, tail + 1u, __CU_RING_RELEASE);
+    return 0;
+}
+
+CU_API int cu_ring_pop(cu_ring_t *ring, void *out)
+{
+    if (ring == NULL || ring->item_size == 0u || out == NULL)
+    {
+        return 1;
+    }
+    if (ring->flags & CU_RING_MPMC)
+    {
+        return __cu_ring_pop_mpmc(ring, out);
+    }
+
+    size_t head = __CU_RING_LOAD(&ring->head, __CU_RING_RELAXED);
+    if (__cu_ring_used_slots(ring, head, 1u) == 0u)
+    {
+        return 1;
+    }
+    cu_memcpy(out, __cu_ring_slot(ring, head), ring->item_size);
+    __CU_RING_STORE(&ring->head, head + 1u, __CU_RING_RELEASE);
+    return 0;
+}
+
+CU_API size_t cu_ring_push_n(cu_ring_t *ring, const void *items, size_t num_items)
+{
+    if (ring == NULL || ring->item_size == 0u || items == NULL)
+    {
+        return 0;
+    }
+
+    const CU_UNIT *src = (const CU_UNIT *)items;
+    if (ring->flags & CU_RING_MPMC)
+    {
+        size_t pushed = 0;
+        while (pushed < num_items && __cu_ring_push_mpmc(ring, __CU_RING_OFFSET_CONST(src, ring->item_size * pushed)) == 0)
+        {
+            pushed++;
+        }
+        return pushed;
+    }
+
+    // At most two copies (before and after the wrap) and a single release store.
+    size_t tail = __CU_RING_LOAD(&ring->tail, __CU_RING_RELAXED);
+    size_t free_slots = __cu_ring_free_slots(ring, tail, num_items);
+    size_t count = num_items < free_slots ? num_items : free_slots;
+    size_t offset = tail & (ring->capacity - 1u);
+    size_t first = ring->capacity - offset < count ? ring->capacity - offset : count;
+    cu_memcpy(__CU_RING_OFFSET(ring->data, ring->item_size * offset), src, ring->item_size * first);
+    cu_memcpy(ring->data, __CU_RING_OFFSET_CONST(src, ring->item_size * first), ring->item_size * (count - first));
+    __CU_RING_STORE(&ring->tail, tail + count, __CU_RING_RELEASE);
+    return count;
+}
+
+CU_API size_t cu_ring_pop_n(cu_ring_t *ring, void *out, size_t num_items)
+{
+    if (ring == NULL || ring->item_size == 0u || out == NULL)
+    {
+        return 0;
+    }
+
+    CU_UNIT *dst = (CU_UNIT *)out;
+    if (ring->flags & CU_RING_MPMC)
+    {
+        size_t popped = 0;
+        while (popped < num_items && __cu_ring_pop_mpmc(ring, __CU_RING_OFFSET(dst, ring->item_size * popped)) == 0)
+        {
+            popped++;
+        }
+        return popped;
+    }
+
+    size_t head = __CU_RING_LOAD(&ring->head, __CU_RING_RELAXED);
+    size_t used = __cu_ring_used_slots(ring, head, num_items);
+    size_t count = num_items < used ? num_items : used;
+    size_t offset = head & (ring->capacity - 1u);
+    size_t first = ring->capacity - offset < count ? ring->capacity - offset : count;
+    cu_memcpy(dst, __CU_RING_OFFSET(ring->data, ring->item_size * offset), ring->item_size * first);
+    cu_memcpy(__CU_RING_OFFSET(dst, ring->item_size * first), ring->data, ring->item_size * (count - first));
+    __CU_RING_STORE(&ring->head, head + count, __CU_RING_RELEASE);
+    return count;
+}
+
+CU_API size_t cu_ring_reserve(cu_ring_t *ring, size_t num_items, CU_UNIT **slots)
+{
+    if (ring == NULL || ring->item_size == 0u || slots == NULL || (ring->flags & CU_RING_MPMC))
+    {
+        return 0;
+    }
+
+    size_t tail = __CU_RING_LOAD(&ring->tail, __CU_RING_RELAXED);
+    size_t free_slots = __cu_ring_free_slots(ring, tail, num_items);
+    size_t offset = tail & (ring->capacity - 1u);
+    size_t count = num_items < free_slots ? num_items : free_slots;
+    if (count > ring->capacity - offset)
+    {
+        count = ring->capacity - offset;
+    }
+    *slots = __CU_RING_OFFSET(ring->data, ring->item_size * offset);
+    return count;
+}
+
+CU_API int cu_ring_commit(cu_ring_t *ring, size_t num_items)
+{
+    if (ring == NULL || ring->item_size == 0u || (ring->flags & CU_RING_MPMC))
+    {
+        return 1;
+    }
+
+    size_t tail = __CU_RING_LOAD(&ring->tail, __CU_RING_RELAXED);
+    // The cached head is at least as old as the one `cu_ring_reserve` used, so this can't reject a valid commit.
+    if (num_items > ring->capacity - (tail - ring->cached_head))
+    {
+        return 1;
+    }
+    __CU_RING_STORE(&ring->tail, tail + num_items, __CU_RING_RELEASE);
+    return 0;
+}
+
+CU_API size_t cu_ring_peek(cu_ring_t *ring, size_t num_items, CU_UNIT **items)
+{
+    if (ring == NULL || ring->item_size == 0u || items == NULL || (ring->flags & CU_RING_MPMC))
+    {
+        return 0;
+    }
+
+    size_t head = __CU_RING_LOAD(&ring->head, __CU_RING_RELAXED);
+    size_t used = __cu_ring_used_slots(ring, head, num_items);
+    size_t offset = head & (ring->capacity - 1u);
+    size_t count = num_items < used ? num_items : used;
+    if (count > ring->capacity - offset)
+    {
+        count = ring->capacity - offset;
+    }
+    *items = __CU_RING_OFFSET(ring->data, ring->item_size * offset);
+    return count;
+}
+
+CU_API int cu_ring_consume(cu_ring_t *ring, size_t num_items)
+{
+    if (ring == NULL || ring->item_size == 0u || (ring->flags & CU_RING_MPMC))
+    {
+        return 1;
+    }
+
+    size_t head = __CU_RING_LOAD(&ring->head, __CU_RING_RELAXED);
+    if (num_items > ring->cached_tail - head)
+    {
+        return 1;
+    }
+    __CU_RING_STORE(&ring->head, head + num_items, __CU_RING_RELEASE);
+    return 0;
+}
+
+CU_API size_t cu_ring_size(cu_ring_t *ring)
+{
+    if (ring == NULL || ring->item_size == 0u)
+    {
+        return 0;
+    }
+
+    // Read the head first, so the difference can't go negative.
+    size_t head = __CU_RING_LOAD(&ring->head, __CU_RING_ACQUIRE);
+    size_t tail = __CU_RING_LOAD(&ring->tail, __CU_RING_ACQUIRE);
+    size_t size = tail - head;
+    return size > ring->capacity ? ring->capacity : size;
+}
+
+#endif // CU_RING_IMPL
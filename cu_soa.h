@@ -0,0 +1,337 @@
+/// @file cu_soa.h
+/// @brief Simple, header-only struct-of-arrays container for C, built on `cu_array_t`.
+///
+/// Every field of a record gets its own column (a `cu_array_t` of that field's size),
+/// so a pass over one field only touches that field's memory:
+/// ```C
+/// size_t fields[3] = {sizeof(uint32_t), sizeof(float), sizeof(double)}; // id, x, weight
+/// cu_soa_t soa = {0};
+/// cu_soa_init(&soa, fields, 3);
+/// uint32_t id = 1; float x = 2.0f; double w = 0.5;
+/// const void *record[3] = {&id, &x, &w};
+/// cu_soa_append(&soa, record);
+/// float *xs = (float *)cu_soa_column(&soa, 1); // soa.length items
+/// cu_soa_deinit(&soa);
+/// ```
+///
+/// To include function implementations, define:
+///     #define CU_SOA_IMPL
+/// before including this header in **one** `.c` or `.cpp` file.
+///
+/// ### Main API
+/// - `cu_soa_init()`
+/// - `cu_soa_init_with_allocator()`
+/// - `cu_soa_deinit()`
+/// - `cu_soa_reserve()`
+/// - `cu_soa_append()`
+/// - `cu_soa_at()`
+/// - `cu_soa_column()`
+/// - `cu_soa_remove_at()`
+/// - `cu_soa_swap_remove()`
+/// - `cu_soa_clear()`
+///
+/// @see `tests/` for examples.
+///
+/// @def CU_SOA_IMPL
+/// @brief Enables function definitions inside the header. Must be defined in exactly one .c or .cpp file.
+
+#ifndef CU_SOA_H
+#define CU_SOA_H
+
+#include "cu_array.h"
+
+typedef struct cu_soa_s
+{
+    /// One column per field, `columns[f].length == length` for every `f`.
+    cu_array_t *columns;
+    size_t num_fields;
+    size_t length;
+    const cu_allocator_t *allocator;
+} cu_soa_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Declarations
+
+    /// @brief Initializes a struct-of-arrays with one column per field. Columns are allocated lazily.
+    /// @param soa Pointer to the container.
+    /// @param field_sizes Size in bytes of each field, all non-zero.
+    /// @param num_fields Number of fields.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_init(cu_soa_t *soa, const size_t *field_sizes, size_t num_fields);
+
+    /// @brief Same as `cu_soa_init`, but every column (and the column table) uses `allocator`.
+    /// @param soa Pointer to the container.
+    /// @param field_sizes Size in bytes of each field, all non-zero.
+    /// @param num_fields Number of fields.
+    /// @param allocator Allocator, `NULL` for `cu_malloc`/`cu_realloc`/`cu_free`. Must outlive the container.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_init_with_allocator(cu_soa_t *soa, const size_t *field_sizes, size_t num_fields,
+                                          const cu_allocator_t *allocator);
+
+    /// @brief Frees every column and sets everything to zero.
+    /// @param soa Pointer to the container.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_deinit(cu_soa_t *soa);
+
+    /// @brief Makes sure every column can hold at least `new_capacity` records.
+    /// @param soa Pointer to the container.
+    /// @param new_capacity Number of records.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_reserve(cu_soa_t *soa, size_t new_capacity);
+
+    /// @brief Appends a record, copying field `f` from `fields[f]`.
+    /// @note Either every column grows or none does, the columns always have the same length.
+    /// @param soa Pointer to the container.
+    /// @param fields Array of `num_fields` pointers, one per field.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_append(cu_soa_t *soa, const void *const *fields);
+
+    /// @brief Returns a pointer to field `field` of record `pos`.
+    /// @param soa Pointer to the container.
+    /// @param field Index of the field.
+    /// @param pos Index of the record.
+    /// @return Pointer to the field on success, `NULL` on error.
+    CU_API CU_UNIT *cu_soa_at(cu_soa_t *soa, size_t field, size_t pos);
+
+    /// @brief Returns the column of field `field`, `soa->length` contiguous items, for loops over a single field.
+    /// @note Any modification of the container can move the column.
+    /// @param soa Pointer to the container.
+    /// @param field Index of the field.
+    /// @return Pointer to the first item on success, `NULL` on error or if nothing was allocated yet.
+    CU_API CU_UNIT *cu_soa_column(cu_soa_t *soa, size_t field);
+
+    /// @brief Removes record `pos` from every column, keeping the order.
+    /// @param soa Pointer to the container.
+    /// @param pos Index of the record.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_remove_at(cu_soa_t *soa, size_t pos);
+
+    /// @brief Removes record `pos` in `O(1)` by moving the last record into its place.
+    /// @param soa Pointer to the container.
+    /// @param pos Index of the record.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_swap_remove(cu_soa_t *soa, size_t pos);
+
+    /// @brief Removes every record, capacity stays the same.
+    /// @param soa Pointer to the container.
+    /// @return `0` on success, `1` on error.
+    CU_API int cu_soa_clear(cu_soa_t *soa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CU_SOA_H
+
+#ifdef CU_SOA_IMPL
+
+#ifndef cu_malloc
+#define cu_malloc malloc
+#endif // cu_malloc
+#ifndef cu_free
+#define cu_free free
+#endif // cu_free
+#ifndef cu_memcpy
+#define cu_memcpy memcpy
+#endif // cu_memcpy
+
+// Definitions
+
+// Helper functions, not "public"
+
+CU_API void *__cu_soa_alloc(const cu_allocator_t *allocator, size_t size)
+{
+    return allocator != NULL ? allocator->alloc(allocator->ctx, size) : cu_malloc(size);
+}
+
+CU_API void __cu_soa_free(const cu_allocator_t *allocator, void *ptr, size_t size)
+{
+    if (allocator != NULL)
+    {
+        allocator->free(allocator->ctx, ptr, size);
+        return;
+    }
+    (void)size;
+    cu_free(ptr);
+}
+
+// "Public" function definitions
+
+CU_API int cu_soa_init(cu_soa_t *soa, const size_t *field_sizes, size_t num_fields)
+{
+    return cu_soa_init_with_allocator(soa, field_sizes, num_fields, NULL);
+}
+
+CU_API int cu_soa_init_with_allocator(cu_soa_t *soa, const size_t *field_sizes, size_t num_fields,
+                                      const cu_allocator_t *allocator)
+{
+    if (soa == NULL || soa->columns != NULL || field_sizes == NULL || num_fields == 0u ||
+        num_fields > SIZE_MAX / sizeof(cu_array_t))
+    {
+        return 1;
+    }
+    for (size_t f = 0; f < num_fields; f++)
+    {
+        if (field_sizes[f] == 0u)
+        {
+            return 1;
+        }
+    }
+
+    cu_array_t *columns = (cu_array_t *)__cu_soa_alloc(allocator, sizeof(cu_array_t) * num_fields);
+    if (columns == NULL)
+    {
+        return 1;
+    }
+    for (size_t f = 0; f < num_fields; f++)
+    {
+        columns[f] = (cu_array_t){0};
+        if (cu_array_init_with_allocator(&columns[f], field_sizes[f], allocator) != 0)
+        {
+            __cu_soa_free(allocator, columns, sizeof(cu_array_t) * num_fields);
+            return 1;
+        }
+    }
+
+    *soa = (cu_soa_t){0};
+    soa->columns = columns;
+    soa->num_fields = num_fields;
+    soa->allocator = allocator;
+    return 0;
+}
+
+CU_API int cu_soa_deinit(cu_soa_t *soa)
+{
+    if (soa == NULL || soa->columns == NULL)
+    {
+        return 1;
+    }
+
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        cu_array_deinit(&soa->columns[f]);
+    }
+    __cu_soa_free(soa->allocator, soa->columns, sizeof(cu_array_t) * soa->num_fields);
+    *soa = (cu_soa_t){0};
+    return 0;
+}
+
+CU_API int cu_soa_reserve(cu_soa_t *soa, size_t new_capacity)
+{
+    if (soa == NULL || soa->columns == NULL)
+    {
+        return 1;
+    }
+
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        if (cu_array_reserve(&soa->columns[f], new_capacity) != 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+CU_API int cu_soa_append(cu_soa_t *soa, const void *const *fields)
+{
+    if (soa == NULL || soa->columns == NULL || fields == NULL)
+    {
+        return 1;
+    }
+
+    // Grow every column first, so a failed allocation leaves all of them untouched.
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        cu_array_t *col = &soa->columns[f];
+        if (fields[f] == NULL || ((col->length >= col->capacity || (col->flags & CU_ARRAY_READONLY)) &&
+                                  __cu_array_prepare(col, 1) != 0))
+        {
+            return 1;
+        }
+    }
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        cu_array_t *col = &soa->columns[f];
+        cu_memcpy(__CU_ARRAY_OFFSET(col->data, col->item_size * col->length), fields[f], col->item_size);
+        col->length += 1;
+    }
+    soa->length += 1;
+    return 0;
+}
+
+CU_API CU_UNIT *cu_soa_at(cu_soa_t *soa, size_t field, size_t pos)
+{
+    if (soa == NULL || soa->columns == NULL || field >= soa->num_fields || pos >= soa->length)
+    {
+        return NULL;
+    }
+    cu_array_t *col = &soa->columns[field];
+    return __CU_ARRAY_OFFSET(col->data, col->item_size * pos);
+}
+
+CU_API CU_UNIT *cu_soa_column(cu_soa_t *soa, size_t field)
+{
+    if (soa == NULL || soa->columns == NULL || field >= soa->num_fields)
+    {
+        return NULL;
+    }
+    return soa->columns[field].data;
+}
+
+CU_API int cu_soa_remove_at(cu_soa_t *soa, size_t pos)
+{
+    if (soa == NULL || soa->columns == NULL || pos >= soa->length)
+    {
+        return 1;
+    }
+
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        if (cu_array_remove_at(&soa->columns[f], pos) != 0)
+        {
+            return 1;
+        }
+    }
+    soa->length -= 1;
+    return 0;
+}
+
+CU_API int cu_soa_swap_remove(cu_soa_t *soa, size_t pos)
+{
+    if (soa == NULL || soa->columns == NULL || pos >= soa->length)
+    {
+        return 1;
+    }
+
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        if (cu_array_swap_remove(&soa->columns[f], pos) != 0)
+        {
+            return 1;
+        }
+    }
+    soa->length -= 1;
+    return 0;
+}
+
+CU_API int cu_soa_clear(cu_soa_t *soa)
+{
+    if (soa == NULL || soa->columns == NULL)
+    {
+        return 1;
+    }
+
+    for (size_t f = 0; f < soa->num_fields; f++)
+    {
+        cu_array_clear(&soa->columns[f]);
+    }
+    soa->length = 0;
+    return 0;
+}
+
+#endif // CU_SOA_IMPL
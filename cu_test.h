@@ -8,21 +8,56 @@
 ///     - CU_TEST_CHECK(condition)
 ///     - CU_TEST_REQUIRE(condition)
 ///     - CU_TEST_COMMENT(msg)
+///     - CU_TEST_ENTRY(fn)
+///     - CU_RUN_TEST_TABLE(title, table)
+///
+/// Instead of calling the tests by hand in `CU_RUN_TESTS`, they can be listed in a table:
+/// ```C
+/// static const cu_test_entry_t tests[] = {CU_TEST_ENTRY(test_a), CU_TEST_ENTRY(test_b)};
+/// CU_RUN_TEST_TABLE("Title", tests)
+/// ```
+/// The generated `main` takes `--filter <substring>`, `--shard i/n` (runs every n-th test, starting
+/// at the i-th, `1 <= i <= n`), `--time` (prints the wall-clock time of every test) and `--list`.
+/// `--time` needs `CLOCK_MONOTONIC` (e.g. `_POSIX_C_SOURCE 199309L`), otherwise it prints process CPU times,
+/// which with `--jobs` add up the time of every thread.
+/// With `CU_TEST_PARALLEL`, `--jobs N` runs the tests on N threads, add `--fork` to run them in
+/// N child processes instead (a crashing test then fails the run instead of killing it).
 /// @def CU_TEST_SILENT
 /// @brief Define this macro before including to silence all test output (other than the summary at the end).
 /// @def CU_FOUT
 /// @brief Define this before including to redirect output (e.g., to `stderr` or a file).
+/// @def CU_TEST_PARALLEL
+/// @brief Enables `--jobs` and `--fork` for `CU_RUN_TEST_TABLE`. Needs POSIX, includes <pthread.h>,
+/// <unistd.h> and <sys/wait.h>, link with `-pthread`.
 /// For usage and examples see the doccomments and the tests for the other headers under tests/.
 
 #ifndef CU_TEST_H
 #define CU_TEST_H
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(CU_TEST_PARALLEL)
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // defined(CU_TEST_PARALLEL)
 
 #ifndef CU_FOUT
 #define CU_FOUT stdout
 #endif // CU_FOUT
 
+// The counters are shared by the worker threads of `--jobs`.
+#if defined(__GNUC__) || defined(__clang__)
+#define __CU_TEST_INC(var) ((void)__atomic_fetch_add(&(var), 1, __ATOMIC_RELAXED))
+#define __CU_TEST_FAIL_RUN() __atomic_store_n(&__g_cu_unit_test_result, 1, __ATOMIC_RELAXED)
+#else
+#define __CU_TEST_INC(var) ((var) += 1)
+#define __CU_TEST_FAIL_RUN() (__g_cu_unit_test_result = 1)
+#endif // defined(__GNUC__) || defined(__clang__)
+
 #ifndef CU_TEST_SILENT
 /// @brief Simply prints to `CU_FOUT`.
 /// @param msg Message, should be double quoted.
@@ -71,7 +106,7 @@
 #define CU_TEST_START(title, desc)                             \
     int __cu_test_result = 0;                                  \
     const char *__cu_test_title = title;                       \
-    __g_cu_num_tests += 1;                                     \
+    __CU_TEST_INC(__g_cu_num_tests);                           \
     do                                                         \
     {                                                          \
         fprintf(CU_FOUT, "TEST START: " title "\n" desc "\n"); \
@@ -83,7 +118,7 @@
 /// @note By defining `CU_TEST_SILENT`, it doesn't print anything.
 #define CU_TEST_START(title, desc) \
     int __cu_test_result = 0;      \
-    __g_cu_num_tests += 1;
+    __CU_TEST_INC(__g_cu_num_tests);
 #endif
 
 #ifndef CU_TEST_SILENT
@@ -93,26 +128,26 @@
     if (__cu_test_result == 0)                                        \
     {                                                                 \
         fprintf(CU_FOUT, "TEST END: %s PASSED\n\n", __cu_test_title); \
-        __g_cu_num_tests_passed += 1;                                 \
+        __CU_TEST_INC(__g_cu_num_tests_passed);                       \
     }                                                                 \
     else                                                              \
     {                                                                 \
         fprintf(CU_FOUT, "TEST END: %s FAILED\n\n", __cu_test_title); \
-        __g_cu_unit_test_result = 1;                                  \
+        __CU_TEST_FAIL_RUN();                                         \
     }                                                                 \
     return __cu_test_result;
 #else
 /// @brief Should be called at the end of each test.
 /// @note By defining `CU_TEST_SILENT`, it doesn't print anything.
-#define CU_TEST_END()                 \
-    if (__cu_test_result == 0)        \
-    {                                 \
-        __g_cu_num_tests_passed += 1; \
-    }                                 \
-    else                              \
-    {                                 \
-        __g_cu_unit_test_result = 1;  \
-    }                                 \
+#define CU_TEST_END()                           \
+    if (__cu_test_result == 0)                  \
+    {                                           \
+        __CU_TEST_INC(__g_cu_num_tests_passed); \
+    }                                           \
+    else                                        \
+    {                                           \
+        __CU_TEST_FAIL_RUN();                   \
+    }                                           \
     return __cu_test_result;
 #endif
 
@@ -123,11 +158,11 @@
 #define CU_TEST_CHECK(condition)                                  \
     do                                                            \
     {                                                             \
-        __g_cu_num_checks += 1;                                   \
+        __CU_TEST_INC(__g_cu_num_checks);                         \
         if (condition)                                            \
         {                                                         \
             fprintf(CU_FOUT, "\tCheck PASSED: %s\n", #condition); \
-            __g_cu_num_checks_passed += 1;                        \
+            __CU_TEST_INC(__g_cu_num_checks_passed);              \
         }                                                         \
         else                                                      \
         {                                                         \
@@ -140,19 +175,19 @@
 /// @brief Checks the condition.
 /// @param condition Condition: if evaluates to true, the check is PASSED, else FAILED.
 /// @note By defining `CU_TEST_SILENT`, it doesn't print anything.
-#define CU_TEST_CHECK(condition)           \
-    do                                     \
-    {                                      \
-        __g_cu_num_checks += 1;            \
-        if (condition)                     \
-        {                                  \
-            __g_cu_num_checks_passed += 1; \
-        }                                  \
-        else                               \
-        {                                  \
-            __cu_test_result = 1;          \
-        }                                  \
-                                           \
+#define CU_TEST_CHECK(condition)                     \
+    do                                               \
+    {                                                \
+        __CU_TEST_INC(__g_cu_num_checks);            \
+        if (condition)                               \
+        {                                            \
+            __CU_TEST_INC(__g_cu_num_checks_passed); \
+        }                                            \
+        else                                         \
+        {                                            \
+            __cu_test_result = 1;                    \
+        }                                            \
+                                                     \
     } while (0)
 #endif
 
@@ -163,7 +198,7 @@
 #define CU_TEST_REQUIRE(cond)                                   \
     do                                                          \
     {                                                           \
-        __g_cu_num_checks += 1;                                 \
+        __CU_TEST_INC(__g_cu_num_checks);                       \
         if (!(cond))                                            \
         {                                                       \
             fprintf(CU_FOUT, "\tREQUIRED FAILED: %s\n", #cond); \
@@ -173,26 +208,26 @@
         else                                                    \
         {                                                       \
             fprintf(CU_FOUT, "\tCheck PASSED: %s\n", #cond);    \
-            __g_cu_num_checks_passed += 1;                      \
+            __CU_TEST_INC(__g_cu_num_checks_passed);            \
         }                                                       \
     } while (0)
 #else
 /// @brief Same as CU_TEST_CHECK, but it returns on failure.
 /// @param condition Condition: if evaluates to true, the check is PASSED, else FAILED.
 /// @note By defining `CU_TEST_SILENT`, it doesn't print anything.
-#define CU_TEST_REQUIRE(cond)              \
-    do                                     \
-    {                                      \
-        __g_cu_num_checks += 1;            \
-        if (!(cond))                       \
-        {                                  \
-            __cu_test_result = 1;          \
-            return __cu_test_result;       \
-        }                                  \
-        else                               \
-        {                                  \
-            __g_cu_num_checks_passed += 1; \
-        }                                  \
+#define CU_TEST_REQUIRE(cond)                        \
+    do                                               \
+    {                                                \
+        __CU_TEST_INC(__g_cu_num_checks);            \
+        if (!(cond))                                 \
+        {                                            \
+            __cu_test_result = 1;                    \
+            return __cu_test_result;                 \
+        }                                            \
+        else                                         \
+        {                                            \
+            __CU_TEST_INC(__g_cu_num_checks_passed); \
+        }                                            \
     } while (0)
 #endif
 
@@ -209,4 +244,329 @@
     __CU_TEST_INIT(title)   \
     int main(void)
 
+// Test tables
+
+/// @brief A test function, as called by `CU_RUN_TEST_TABLE`.
+typedef int (*cu_test_fn_t)(void);
+
+/// @brief Entry of a test table, see `CU_TEST_ENTRY`.
+typedef struct cu_test_entry_s
+{
+    const char *name;
+    cu_test_fn_t fn;
+} cu_test_entry_t;
+
+/// @brief Entry of a test table for the test function `fn`, named after it.
+#define CU_TEST_ENTRY(fn) {#fn, fn}
+
+// Defined by `__CU_TEST_INIT`, declared here for the table runner.
+extern int __g_cu_unit_test_result;
+extern const char *__g_cu_unit_test_title;
+extern size_t __g_cu_num_tests;
+extern size_t __g_cu_num_tests_passed;
+extern size_t __g_cu_num_checks;
+extern size_t __g_cu_num_checks_passed;
+
+/// @brief Wall-clock time in milliseconds (CPU time if there is no monotonic clock).
+static inline double __cu_test_now_ms(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+#else
+    return (double)clock() * 1000.0 / (double)CLOCKS_PER_SEC;
+#endif // defined(CLOCK_MONOTONIC)
+}
+
+#if defined(CLOCK_MONOTONIC)
+#define __CU_TEST_TIME_UNIT "ms"
+#else
+#define __CU_TEST_TIME_UNIT "ms CPU"
+#endif // defined(CLOCK_MONOTONIC)
+
+static inline void __cu_test_run_one(const cu_test_entry_t *test, int print_time)
+{
+    double start = __cu_test_now_ms();
+    test->fn();
+    if (print_time)
+    {
+        fprintf(CU_FOUT, "%-48s %10.3f " __CU_TEST_TIME_UNIT "\n", test->name, __cu_test_now_ms() - start);
+    }
+}
+
+#if defined(CU_TEST_PARALLEL)
+typedef struct __cu_test_queue_s
+{
+    const cu_test_entry_t **tests;
+    size_t num_tests;
+    size_t next;
+    int print_time;
+} __cu_test_queue_t;
+
+static inline void *__cu_test_thread(void *arg)
+{
+    __cu_test_queue_t *queue = (__cu_test_queue_t *)arg;
+    for (;;)
+    {
+        size_t i = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+        if (i >= queue->num_tests)
+        {
+            return NULL;
+        }
+        __cu_test_run_one(queue->tests[i], queue->print_time);
+    }
+}
+
+static inline int __cu_test_run_threads(const cu_test_entry_t **tests, size_t num_tests, size_t jobs, int print_time)
+{
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * jobs);
+    if (threads == NULL)
+    {
+        return 1;
+    }
+    __cu_test_queue_t queue = {tests, num_tests, 0, print_time};
+    size_t started = 0;
+    for (; started < jobs; started++)
+    {
+        if (pthread_create(&threads[started], NULL, __cu_test_thread, &queue) != 0)
+        {
+            break;
+        }
+    }
+    if (started == 0u)
+    {
+        __cu_test_thread(&queue);
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    return 0;
+}
+
+/// Worker `w` of `jobs` runs every `jobs`-th selected test and sends its counters back through a pipe.
+static inline int __cu_test_run_fork(const cu_test_entry_t **tests, size_t num_tests, size_t jobs, int print_time)
+{
+    pid_t *pids = (pid_t *)malloc(sizeof(pid_t) * jobs);
+    int *pipes = (int *)malloc(sizeof(int) * jobs);
+    if (pids == NULL || pipes == NULL)
+    {
+        free(pids);
+        free(pipes);
+        return 1;
+    }
+    fflush(CU_FOUT);
+    size_t started = 0;
+    for (; started < jobs; started++)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            break;
+        }
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+            break;
+        }
+        if (pid == 0)
+        {
+            close(fds[0]);
+            for (size_t i = started; i < num_tests; i += jobs)
+            {
+                __cu_test_run_one(tests[i], print_time);
+            }
+            size_t counts[5] = {__g_cu_num_tests, __g_cu_num_tests_passed, __g_cu_num_checks,
+                                __g_cu_num_checks_passed, (size_t)__g_cu_unit_test_result};
+            fflush(CU_FOUT);
+            _exit(write(fds[1], counts, sizeof(counts)) == (ssize_t)sizeof(counts) ? 0 : 1);
+        }
+        close(fds[1]);
+        pids[started] = pid;
+        pipes[started] = fds[0];
+    }
+
+    // A worker that crashed or never started fails the run, its tests are not counted.
+    int result = started == jobs ? 0 : 1;
+    for (size_t w = 0; w < started; w++)
+    {
+        size_t counts[5] = {0};
+        int status = 0;
+        ssize_t got = read(pipes[w], counts, sizeof(counts));
+        close(pipes[w]);
+        waitpid(pids[w], &status, 0);
+        if (got != (ssize_t)sizeof(counts) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(CU_FOUT, "Worker %zu crashed\n", w);
+            result = 1;
+            continue;
+        }
+        __g_cu_num_tests += counts[0];
+        __g_cu_num_tests_passed += counts[1];
+        __g_cu_num_checks += counts[2];
+        __g_cu_num_checks_passed += counts[3];
+        result |= (int)counts[4];
+    }
+    free(pids);
+    free(pipes);
+    return result;
+}
+#endif // defined(CU_TEST_PARALLEL)
+
+static inline int __cu_test_parse_size(const char *str, size_t *out)
+{
+    char *end = NULL;
+    unsigned long value = strtoul(str, &end, 10);
+    if (end == str || value == 0u)
+    {
+        return 1;
+    }
+    *out = (size_t)value;
+    return 0;
+}
+
+/// @brief Shouldn't be used by the user, it is the `main` of `CU_RUN_TEST_TABLE`.
+static inline int __cu_test_run_table(const cu_test_entry_t *table, size_t num_entries, int argc, char **argv)
+{
+    const char *filter = NULL;
+    size_t shard = 1;
+    size_t num_shards = 1;
+    size_t jobs = 1;
+    int print_time = 0;
+    int list = 0;
+    int use_fork = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc)
+        {
+            const char *slash = strchr(argv[++i], '/');
+            if (slash == NULL || __cu_test_parse_size(argv[i], &shard) != 0 ||
+                __cu_test_parse_size(slash + 1, &num_shards) != 0 || shard > num_shards)
+            {
+                fprintf(CU_FOUT, "Invalid --shard %s, expected i/n with 1 <= i <= n\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            if (__cu_test_parse_size(argv[++i], &jobs) != 0)
+            {
+                fprintf(CU_FOUT, "Invalid --jobs %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--fork") == 0)
+        {
+            use_fork = 1;
+        }
+        else if (strcmp(argv[i], "--time") == 0)
+        {
+            print_time = 1;
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            list = 1;
+        }
+        else
+        {
+            fprintf(CU_FOUT, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const cu_test_entry_t **tests = (const cu_test_entry_t **)malloc(sizeof(cu_test_entry_t *) * (num_entries + 1u));
+    if (tests == NULL)
+    {
+        return 1;
+    }
+    size_t num_tests = 0;
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        if (i % num_shards == shard - 1u && (filter == NULL || strstr(table[i].name, filter) != NULL))
+        {
+            tests[num_tests++] = &table[i];
+        }
+    }
+    if (list)
+    {
+        for (size_t i = 0; i < num_tests; i++)
+        {
+            fprintf(CU_FOUT, "%s\n", tests[i]->name);
+        }
+        free(tests);
+        return 0;
+    }
+
+    if (jobs > num_tests)
+    {
+        jobs = num_tests != 0u ? num_tests : 1u;
+    }
+#if !defined(CLOCK_MONOTONIC)
+    if (print_time)
+    {
+        fprintf(CU_FOUT, "--time: no CLOCK_MONOTONIC, printing process CPU times (summed over all threads)\n");
+    }
+#endif // !defined(CLOCK_MONOTONIC)
+    double start = __cu_test_now_ms();
+#if defined(CU_TEST_PARALLEL)
+    if (use_fork)
+    {
+        if (__cu_test_run_fork(tests, num_tests, jobs, print_time) != 0)
+        {
+            __g_cu_unit_test_result = 1;
+        }
+    }
+    else if (jobs > 1u)
+    {
+        if (__cu_test_run_threads(tests, num_tests, jobs, print_time) != 0)
+        {
+            __g_cu_unit_test_result = 1;
+        }
+    }
+    else
+#else
+    if (jobs > 1u || use_fork)
+    {
+        fprintf(CU_FOUT, "--jobs and --fork need CU_TEST_PARALLEL, running serially\n");
+    }
+#endif // defined(CU_TEST_PARALLEL)
+    {
+        for (size_t i = 0; i < num_tests; i++)
+        {
+            __cu_test_run_one(tests[i], print_time);
+        }
+    }
+    free(tests);
+    if (print_time)
+    {
+        fprintf(CU_FOUT, "Total time: %.3f " __CU_TEST_TIME_UNIT "\n", __cu_test_now_ms() - start);
+    }
+    CU_RUN_END();
+}
+
+/// @brief Generates a `main` that runs the tests of `table`, see the top of the file for the options.
+/// ```C
+/// static const cu_test_entry_t tests[] = {
+///     CU_TEST_ENTRY(test_something),
+///     ...
+/// };
+/// CU_RUN_TEST_TABLE("Title", tests)
+/// ```
+/// @param title Title of the unit test.
+/// @param table Array of `cu_test_entry_t`.
+#define CU_RUN_TEST_TABLE(title, table)                                                    \
+    __CU_TEST_INIT(title)                                                                  \
+    int main(int argc, char **argv)                                                        \
+    {                                                                                      \
+        return __cu_test_run_table(table, sizeof(table) / sizeof((table)[0]), argc, argv); \
+    }
+
 #endif // CU_TEST_H
@@ -0,0 +1,137 @@
+#define CU_ARENA_IMPL
+// Larger than the alignment of malloc, so the blocks have to align their data.
+#define CU_ARENA_ALIGNMENT (64u)
+#include "../cu_arena.h"
+#define CU_ARRAY_IMPL
+#include "../cu_array.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+int test_cu_arena_tc_1();
+int test_cu_arena_tc_2();
+int test_cu_arena_tc_3();
+
+CU_RUN_TESTS("cu_arena unit test")
+{
+    test_cu_arena_tc_1();
+    test_cu_arena_tc_2();
+    test_cu_arena_tc_3();
+
+    CU_RUN_END();
+}
+
+int test_cu_arena_tc_1()
+{
+    CU_TEST_START("cu_arena init, alloc and deinit", "Checks if allocations are aligned and don't overlap.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    CU_TEST_REQUIRE(cu_arena_init(&arena, 256) == 0);
+    CU_TEST_CHECK(arena.head == NULL);
+
+    unsigned char *a = cu_arena_alloc(&arena, 10);
+    unsigned char *b = cu_arena_alloc(&arena, 20);
+    CU_TEST_REQUIRE(a != NULL && b != NULL);
+    CU_TEST_CHECK((size_t)a % CU_ARENA_ALIGNMENT == 0);
+    CU_TEST_CHECK((size_t)b % CU_ARENA_ALIGNMENT == 0);
+    CU_TEST_CHECK(b >= a + 10);
+
+    CU_TEST_COMMENT("Allocations larger than a block get a block of their own.");
+    unsigned char *big = cu_arena_alloc(&arena, 1000);
+    CU_TEST_REQUIRE(big != NULL);
+    CU_TEST_CHECK(arena.head->capacity >= 1000);
+    memset(big, 0xAB, 1000);
+    CU_TEST_CHECK((size_t)big % CU_ARENA_ALIGNMENT == 0);
+
+    CU_TEST_COMMENT("Sizes that overflow once aligned are rejected.");
+    CU_TEST_CHECK(cu_arena_alloc(&arena, (size_t)-1) == NULL);
+    CU_TEST_CHECK(cu_arena_alloc(&arena, (size_t)-1 - CU_ARENA_ALIGNMENT) == NULL);
+    const cu_allocator_t *allocator = cu_arena_allocator(&arena);
+    unsigned char *last = allocator->alloc(allocator->ctx, 8);
+    CU_TEST_REQUIRE(last != NULL);
+    CU_TEST_CHECK(allocator->realloc(allocator->ctx, last, 8, (size_t)-1) == NULL);
+    CU_TEST_CHECK(allocator->realloc(allocator->ctx, last, 8, 16) == last);
+
+    cu_arena_deinit(&arena);
+    CU_TEST_CHECK(arena.head == NULL);
+    CU_TEST_CHECK(cu_arena_alloc(&arena, 1) == NULL);
+    CU_TEST_END();
+}
+
+int test_cu_arena_tc_2()
+{
+    CU_TEST_START("cu_arena reset", "Checks if reset keeps one block and reuses it.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 128);
+    for (int i = 0; i < 20; i++)
+    {
+        cu_arena_alloc(&arena, 64);
+    }
+    CU_TEST_CHECK(arena.head->next != NULL);
+
+    cu_arena_block_t *head = arena.head;
+    CU_TEST_CHECK(cu_arena_reset(&arena) == 0);
+    CU_TEST_CHECK(arena.head == head);
+    CU_TEST_CHECK(arena.head->next == NULL);
+    CU_TEST_CHECK(arena.head->used == 0);
+    CU_TEST_CHECK(cu_arena_alloc(&arena, 64) == (void *)__cu_arena_block_data(head));
+
+    cu_arena_deinit(&arena);
+    CU_TEST_END();
+}
+
+int test_cu_arena_tc_3()
+{
+    CU_TEST_START("cu_arena as cu_array allocator", "Checks if arrays can grow inside an arena.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 64 * 1024);
+
+    cu_array_t arr = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_init_with_allocator(&arr, sizeof(int), cu_arena_allocator(&arena)) == 0);
+    CU_TEST_CHECK(arr.allocator == &arena.allocator);
+
+    CU_TEST_COMMENT("The array is the most recent allocation, so it grows in place.");
+    int first = 0;
+    cu_array_append(&arr, &first);
+    CU_UNIT *first_data = arr.data;
+    for (int i = 1; i < 1000; i++)
+    {
+        cu_array_append(&arr, &i);
+    }
+    CU_TEST_CHECK(arr.data == first_data);
+    CU_TEST_CHECK(arr.length == 1000);
+
+    CU_TEST_COMMENT("A second array forces the first one to move when it grows.");
+    cu_array_t other = (cu_array_t){0};
+    cu_array_init_with_allocator(&other, sizeof(int), cu_arena_allocator(&arena));
+    int ok = 1;
+    for (int i = 1000; i < 3000; i++)
+    {
+        ok &= cu_array_append(&arr, &i) == 0;
+        ok &= cu_array_append(&other, &i) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    for (int i = 0; i < 3000; i++)
+    {
+        ok &= *(int *)cu_array_at(&arr, i) == i;
+    }
+    for (int i = 0; i < 2000; i++)
+    {
+        ok &= *(int *)cu_array_at(&other, i) == i + 1000;
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Sorting uses the scratch buffer from the arena too.");
+    CU_TEST_CHECK(cu_array_radix_sort(&other, 0, sizeof(int), CU_RADIX_SIGNED | CU_RADIX_DESCENDING) == 0);
+    CU_TEST_CHECK(*(int *)cu_array_at(&other, 0) == 2999);
+
+    cu_array_deinit(&other);
+    cu_array_deinit(&arr);
+    cu_arena_deinit(&arena);
+
+    CU_TEST_COMMENT("Incomplete allocators are rejected.");
+    cu_allocator_t broken = {0};
+    CU_TEST_CHECK(cu_array_init_with_allocator(&arr, sizeof(int), &broken) == 1);
+    CU_TEST_END();
+}
@@ -1,8 +1,45 @@
+#define _GNU_SOURCE
 #define CU_ARRAY_IMPL
 #define CU_DEBUG
+#define CU_ARRAY_THREADS
+#define CU_ARRAY_PSORT_THRESHOLD (1024u)
+#define CU_ARRAY_MMAP
+#define CU_ARRAY_STATS
+#define CU_ARRAY_IO
+#define CU_ARRAY_CHUNK_PREFETCH_DISTANCE (256u)
 #include "../cu_array.h"
 #define CU_TEST_SILENT
 #include "../cu_test.h"
+#include <limits.h>
+#include <stddef.h>
+
+CU_ARRAY_DEFINE(int)
+CU_ARRAY_DEFINE_ORDERED(int)
+
+static size_t g_num_compares = 0;
+
+int compare_int_counting(void *a, void *b)
+{
+    g_num_compares += 1;
+    return cu_compare_int(a, b);
+}
+
+int compare_int_desc(void *a, void *b)
+{
+    return cu_compare_int(b, a);
+}
+
+int is_sorted_int(cu_array_t *arr)
+{
+    for (size_t i = 1; i < arr->length; i++)
+    {
+        if (*(int *)cu_array_at(arr, i - 1) > *(int *)cu_array_at(arr, i))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
 
 int test_cu_array_tc_1();
 int test_cu_array_tc_2();
@@ -11,6 +48,26 @@ int test_cu_array_tc_4();
 int test_cu_array_tc_5();
 int test_cu_array_tc_6();
 int test_cu_array_tc_7();
+int test_cu_array_tc_8();
+int test_cu_array_tc_9();
+int test_cu_array_tc_10();
+int test_cu_array_tc_11();
+int test_cu_array_tc_12();
+int test_cu_array_tc_13();
+int test_cu_array_tc_14();
+int test_cu_array_tc_15();
+int test_cu_array_tc_16();
+int test_cu_array_tc_17();
+int test_cu_array_tc_18();
+int test_cu_array_tc_19();
+int test_cu_array_tc_20();
+int test_cu_array_tc_21();
+int test_cu_array_tc_22();
+int test_cu_array_tc_23();
+int test_cu_array_tc_24();
+int test_cu_array_tc_25();
+int test_cu_array_tc_26();
+int test_cu_array_tc_27();
 
 CU_RUN_TESTS("cu_array unit test")
 {
@@ -21,16 +78,41 @@ CU_RUN_TESTS("cu_array unit test")
     test_cu_array_tc_5();
     test_cu_array_tc_6();
     test_cu_array_tc_7();
+    test_cu_array_tc_8();
+    test_cu_array_tc_9();
+    test_cu_array_tc_10();
+    test_cu_array_tc_11();
+    test_cu_array_tc_12();
+    test_cu_array_tc_13();
+    test_cu_array_tc_14();
+    test_cu_array_tc_15();
+    test_cu_array_tc_16();
+    test_cu_array_tc_17();
+    test_cu_array_tc_18();
+    test_cu_array_tc_19();
+    test_cu_array_tc_20();
+    test_cu_array_tc_21();
+    test_cu_array_tc_22();
+    test_cu_array_tc_23();
+    test_cu_array_tc_24();
+    test_cu_array_tc_25();
+    test_cu_array_tc_26();
+    test_cu_array_tc_27();
 
     CU_RUN_END();
 }
 
 int test_cu_array_tc_1()
 {
-    CU_TEST_START("cu_array init and deinit", "Checks if the initialisation and deinit works.");
+    CU_TEST_START("cu_array init and deinit", "Checks if the lazy initialisation and deinit works.");
 
     cu_array_t arr = (cu_array_t){0};
     cu_array_init(&arr, sizeof(int));
+    CU_TEST_CHECK(arr.capacity == 0);
+    CU_TEST_CHECK(arr.data == NULL);
+
+    int to_append = 1;
+    cu_array_append(&arr, &to_append);
     CU_TEST_CHECK(arr.capacity == CU_ARRAY_DEFAULT_SIZE);
 
     cu_array_deinit(&arr);
@@ -206,4 +288,1443 @@ int test_cu_array_tc_7()
 
     cu_array_deinit(&arr);
     CU_TEST_END();
-}
\ No newline at end of file
+}
+
+int test_cu_array_tc_8()
+{
+    CU_TEST_START("cu_array typed", "Checks if the arrays generated by CU_ARRAY_DEFINE work properly.");
+
+    cu_array_int_t arr = (cu_array_int_t){0};
+    CU_TEST_REQUIRE(cu_array_int_init(&arr) == 0);
+    CU_TEST_CHECK(arr.base.item_size == sizeof(int));
+
+    for (int i = 0; i < 100; i++)
+    {
+        cu_array_int_append(&arr, i);
+    }
+    CU_TEST_CHECK(arr.base.length == 100);
+    CU_TEST_CHECK(*cu_array_int_at(&arr, 99) == 99);
+    CU_TEST_CHECK(cu_array_int_at(&arr, 100) == NULL);
+
+    int to_extend[3] = {100, 101, 102};
+    cu_array_int_extend(&arr, to_extend, 3);
+    CU_TEST_CHECK(arr.base.length == 103);
+    CU_TEST_CHECK(*cu_array_int_at(&arr, 102) == 102);
+
+    cu_array_int_insert(&arr, -1, 0);
+    CU_TEST_CHECK(*cu_array_int_at(&arr, 0) == -1);
+    CU_TEST_CHECK(*cu_array_int_at(&arr, 1) == 0);
+    CU_TEST_CHECK(cu_array_int_insert(&arr, 0, arr.base.length + 1) == 1);
+
+    cu_array_int_remove_at(&arr, 0);
+    cu_array_int_remove_at(&arr, arr.base.length - 1);
+    CU_TEST_CHECK(arr.base.length == 102);
+    int *data = cu_array_int_data(&arr);
+    int ok = 1;
+    for (int i = 0; i < 102; i++)
+    {
+        ok &= data[i] == i;
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("The generic functions work on the underlying array.");
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr.base, 5) == 5);
+    CU_TEST_CHECK(cu_array_int_reserve(&arr, 1000) == 0);
+    CU_TEST_CHECK(arr.base.capacity == 1000);
+
+    cu_array_int_deinit(&arr);
+    CU_TEST_CHECK(arr.base.data == NULL);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_9()
+{
+    CU_TEST_START("cu_array qsort patterns",
+                  "Checks if sorting works and stays O(n log n) "
+                  "on random, sorted, reversed, duplicate and organ-pipe inputs.");
+
+    const size_t n = 10000;
+    // 2 * n * log2(n) is a generous bound for introsort, quadratic behaviour would be ~n * n.
+    const size_t max_compares = 2u * n * 14u;
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+
+    for (int pattern = 0; pattern < 6; pattern++)
+    {
+        cu_array_clear(&arr);
+        unsigned int seed = 12345u;
+        long long sum_before = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            int value = 0;
+            seed = seed * 1103515245u + 12345u;
+            switch (pattern)
+            {
+            case 0: value = (int)(seed >> 8); break;             // random
+            case 1: value = (int)i; break;                       // sorted
+            case 2: value = (int)(n - i); break;                 // reversed
+            case 3: value = 7; break;                            // all equal
+            case 4: value = (int)((seed >> 8) % 4u); break;      // few distinct
+            case 5: value = (int)(i < n / 2 ? i : n - i); break; // organ-pipe
+            }
+            sum_before += value;
+            cu_array_append(&arr, &value);
+        }
+
+        g_num_compares = 0;
+        CU_TEST_CHECK(cu_array_qsort(&arr, compare_int_counting) == 0);
+        CU_TEST_CHECK(is_sorted_int(&arr));
+        CU_TEST_CHECK(g_num_compares < max_compares);
+
+        long long sum_after = 0;
+        for (size_t i = 0; i < arr.length; i++)
+        {
+            sum_after += *(int *)cu_array_at(&arr, i);
+        }
+        CU_TEST_CHECK(arr.length == n);
+        CU_TEST_CHECK(sum_before == sum_after);
+    }
+
+    CU_TEST_COMMENT("Small arrays go through insertion sort only.");
+    int small[3] = {2, 0, 1};
+    cu_array_clear(&arr);
+    cu_array_extend(&arr, small, 3);
+    cu_array_qsort(&arr, cu_compare_int);
+    CU_TEST_CHECK(is_sorted_int(&arr));
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+typedef struct big_item_s
+{
+    int key;
+    unsigned char payload[300];
+} big_item_t;
+
+int compare_big_item_r(void *a, void *b, void *ctx)
+{
+    int direction = *(int *)ctx;
+    int ka = ((big_item_t *)a)->key;
+    int kb = ((big_item_t *)b)->key;
+    return direction * ((ka > kb) - (ka < kb));
+}
+
+int compare_bytes3_r(void *a, void *b, void *ctx)
+{
+    (void)ctx;
+    return memcmp(a, b, 3);
+}
+
+int test_cu_array_tc_10()
+{
+    CU_TEST_START("cu_array qsort_r", "Checks the reentrant sort with a context, large and unaligned items.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(big_item_t));
+
+    CU_TEST_COMMENT("Items larger than the swap chunk, sorted descending through the context.");
+    big_item_t item;
+    for (int i = 0; i < 200; i++)
+    {
+        item.key = (i * 37) % 200;
+        memset(item.payload, item.key & 0xFF, sizeof(item.payload));
+        cu_array_append(&arr, &item);
+    }
+    int direction = -1;
+    CU_TEST_CHECK(cu_array_qsort_r(&arr, compare_big_item_r, &direction) == 0);
+    int ok = 1;
+    for (size_t i = 0; i < arr.length; i++)
+    {
+        big_item_t *at = (big_item_t *)cu_array_at(&arr, i);
+        ok &= at->key == (int)(199 - i);
+        ok &= at->payload[0] == (at->key & 0xFF) && at->payload[299] == (at->key & 0xFF);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_qsort_r(&arr, NULL, &direction) == 1);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Items that are not word sized.");
+    cu_array_init(&arr, 3);
+    for (int i = 0; i < 100; i++)
+    {
+        unsigned char bytes[3] = {(unsigned char)(99 - i), 0, (unsigned char)i};
+        cu_array_append(&arr, bytes);
+    }
+    cu_array_qsort_r(&arr, compare_bytes3_r, NULL);
+    ok = 1;
+    for (size_t i = 0; i < arr.length; i++)
+    {
+        unsigned char *at = cu_array_at(&arr, i);
+        ok &= at[0] == i && at[1] == 0 && at[2] == 99 - i;
+    }
+    CU_TEST_CHECK(ok);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_11()
+{
+    CU_TEST_START("cu_array psort", "Checks if the parallel sort works with different thread counts.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+
+    size_t thread_counts[4] = {0, 1, 3, 8};
+    for (size_t t = 0; t < 4; t++)
+    {
+        cu_array_clear(&arr);
+        unsigned int seed = 42u;
+        long long sum_before = 0;
+        for (size_t i = 0; i < 100000; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            int value = (int)((seed >> 8) % 50000u);
+            sum_before += value;
+            cu_array_append(&arr, &value);
+        }
+
+        CU_TEST_CHECK(cu_array_psort(&arr, cu_compare_int, thread_counts[t]) == 0);
+        CU_TEST_CHECK(is_sorted_int(&arr));
+
+        long long sum_after = 0;
+        for (size_t i = 0; i < arr.length; i++)
+        {
+            sum_after += *(int *)cu_array_at(&arr, i);
+        }
+        CU_TEST_CHECK(sum_before == sum_after);
+    }
+
+    CU_TEST_COMMENT("Below the threshold it falls back to the sequential sort.");
+    int small[5] = {4, 3, 2, 1, 0};
+    cu_array_clear(&arr);
+    cu_array_extend(&arr, small, 5);
+    CU_TEST_CHECK(cu_array_psort(&arr, cu_compare_int, 4) == 0);
+    CU_TEST_CHECK(is_sorted_int(&arr));
+    CU_TEST_CHECK(cu_array_psort(&arr, NULL, 4) == 1);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+typedef struct keyed_item_s
+{
+    char tag;
+    unsigned long long key;
+    int original_index;
+} keyed_item_t;
+
+int test_cu_array_tc_12()
+{
+    CU_TEST_START("cu_array radix sort", "Checks the radix sort on signed, unsigned, float and struct keys.");
+
+    CU_TEST_COMMENT("cu_compare_int doesn't overflow.");
+    int lo = INT_MIN, hi = INT_MAX;
+    CU_TEST_CHECK(cu_compare_int(&lo, &hi) < 0);
+    CU_TEST_CHECK(cu_compare_int(&hi, &lo) > 0);
+    CU_TEST_CHECK(cu_compare_int(&lo, &lo) == 0);
+
+    CU_TEST_COMMENT("Signed ints, including the extremes.");
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+    unsigned int seed = 7u;
+    for (int i = 0; i < 5000; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        int value = (int)seed;
+        cu_array_append(&arr, &value);
+    }
+    cu_array_append(&arr, &lo);
+    cu_array_append(&arr, &hi);
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, 0, sizeof(int), CU_RADIX_SIGNED) == 0);
+    CU_TEST_CHECK(is_sorted_int(&arr));
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 0) == INT_MIN);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, arr.length - 1) == INT_MAX);
+
+    CU_TEST_COMMENT("Small values only need one pass, the constant bytes are skipped.");
+    cu_array_clear(&arr);
+    for (int i = 0; i < 300; i++)
+    {
+        int value = (i * 7) % 200;
+        cu_array_append(&arr, &value);
+    }
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, 0, sizeof(int), CU_RADIX_UNSIGNED) == 0);
+    CU_TEST_CHECK(is_sorted_int(&arr));
+
+    CU_TEST_COMMENT("Invalid keys.");
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, 0, 3, CU_RADIX_UNSIGNED) == 1);
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, 2, 4, CU_RADIX_UNSIGNED) == 1);
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, SIZE_MAX - 1u, 4, CU_RADIX_UNSIGNED) == 1);
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, 0, 2, CU_RADIX_FLOAT) == 1);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Floats, descending.");
+    cu_array_init(&arr, sizeof(float));
+    float floats[8] = {0.5f, -1.0f, 3.25f, -0.0f, 100.0f, -200.5f, 1e-8f, 0.0f};
+    cu_array_extend(&arr, floats, 8);
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, 0, sizeof(float), CU_RADIX_FLOAT | CU_RADIX_DESCENDING) == 0);
+    int ok = 1;
+    for (size_t i = 1; i < arr.length; i++)
+    {
+        ok &= *(float *)cu_array_at(&arr, i - 1) >= *(float *)cu_array_at(&arr, i);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(*(float *)cu_array_at(&arr, 0) == 100.0f);
+    CU_TEST_CHECK(*(float *)cu_array_at(&arr, 7) == -200.5f);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Struct with a 64-bit key at an offset, the sort is stable.");
+    cu_array_init(&arr, sizeof(keyed_item_t));
+    for (int i = 0; i < 1000; i++)
+    {
+        keyed_item_t item = {.tag = 'x', .key = ((unsigned long long)(i % 10) << 40) + (i % 3), .original_index = i};
+        cu_array_append(&arr, &item);
+    }
+    CU_TEST_CHECK(cu_array_radix_sort(&arr, offsetof(keyed_item_t, key), 8, CU_RADIX_UNSIGNED) == 0);
+    ok = 1;
+    for (size_t i = 1; i < arr.length; i++)
+    {
+        keyed_item_t *prev = (keyed_item_t *)cu_array_at(&arr, i - 1);
+        keyed_item_t *curr = (keyed_item_t *)cu_array_at(&arr, i);
+        ok &= prev->key <= curr->key;
+        ok &= prev->key != curr->key || prev->original_index < curr->original_index;
+        ok &= curr->tag == 'x';
+    }
+    CU_TEST_CHECK(ok);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_13()
+{
+    CU_TEST_START("cu_array small arrays", "Checks if CU_SARRAY uses its inline storage and moves to the heap when it outgrows it.");
+
+    CU_SARRAY(int, 8) sarr;
+    CU_TEST_REQUIRE(CU_SARRAY_INIT(&sarr) == 0);
+    CU_TEST_CHECK(sarr.base.data == (CU_UNIT *)sarr.storage);
+    CU_TEST_CHECK(sarr.base.capacity == 8);
+    CU_TEST_CHECK(sarr.base.flags & CU_ARRAY_EXTERNAL_STORAGE);
+
+    for (int i = 0; i < 8; i++)
+    {
+        cu_array_append(&sarr.base, &i);
+    }
+    CU_TEST_CHECK(sarr.base.data == (CU_UNIT *)sarr.storage);
+    int to_insert = -1;
+    cu_array_insert(&sarr.base, &to_insert, 0);
+    cu_array_remove_at(&sarr.base, 0);
+    CU_TEST_CHECK(*(int *)cu_array_at(&sarr.base, 0) == 0);
+
+    CU_TEST_COMMENT("The 9th item moves everything to the heap.");
+    int ninth = 8;
+    CU_TEST_CHECK(cu_array_append(&sarr.base, &ninth) == 0);
+    CU_TEST_CHECK(sarr.base.data != (CU_UNIT *)sarr.storage);
+    CU_TEST_CHECK(!(sarr.base.flags & CU_ARRAY_EXTERNAL_STORAGE));
+    CU_TEST_CHECK(sarr.base.capacity > 8);
+    int ok = 1;
+    for (int i = 0; i < 9; i++)
+    {
+        ok &= *(int *)cu_array_at(&sarr.base, i) == i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_deinit(&sarr.base) == 0);
+
+    CU_TEST_COMMENT("A small array that never grows doesn't free its inline storage.");
+    CU_SARRAY_INIT(&sarr);
+    cu_array_append(&sarr.base, &ninth);
+    CU_TEST_CHECK(cu_array_deinit(&sarr.base) == 0);
+
+    CU_TEST_COMMENT("Any caller-provided buffer works, reserve moves it to the heap.");
+    int buffer[4];
+    cu_array_t arr = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_init_with_buffer(&arr, sizeof(int), buffer, 4) == 0);
+    cu_array_append(&arr, &ninth);
+    CU_TEST_CHECK(cu_array_reserve(&arr, 100) == 0);
+    CU_TEST_CHECK(arr.data != (CU_UNIT *)buffer);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 0) == ninth);
+    cu_array_deinit(&arr);
+    CU_TEST_CHECK(cu_array_init_with_buffer(&arr, sizeof(int), NULL, 4) == 1);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_14()
+{
+    CU_TEST_START("cu_array growth policy", "Checks runtime growth policies and shrink_to_fit.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+
+    CU_TEST_COMMENT("Invalid policies are rejected.");
+    cu_array_growth_t shrinking = {4, 1, 2, 0, 0, 0};
+    cu_array_growth_t no_increment = {4, 2, 1, 16, 0, 0};
+    CU_TEST_CHECK(cu_array_set_growth(&arr, &shrinking) == 1);
+    CU_TEST_CHECK(cu_array_set_growth(&arr, &no_increment) == 1);
+
+    CU_TEST_COMMENT("1.5x from 4 items, linear above 20, capped at 40.");
+    cu_array_growth_t growth = {4, 3, 2, 20, 8, 40};
+    CU_TEST_REQUIRE(cu_array_set_growth(&arr, &growth) == 0);
+    size_t expected[] = {4, 6, 9, 13, 19, 28, 36, 40};
+    size_t step = 0;
+    int ok = 1;
+    for (int i = 0; i < 40; i++)
+    {
+        ok &= cu_array_append(&arr, &i) == 0;
+        if (arr.capacity != expected[step])
+        {
+            step++;
+            ok &= arr.capacity == expected[step];
+        }
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(step == 7);
+    int too_many = 40;
+    CU_TEST_CHECK(cu_array_append(&arr, &too_many) == 1);
+    CU_TEST_CHECK(cu_array_reserve(&arr, 41) == 1);
+    CU_TEST_CHECK(arr.length == 40);
+
+    CU_TEST_COMMENT("shrink_to_fit gives the unused memory back.");
+    cu_array_set_growth(&arr, NULL);
+    cu_array_reserve(&arr, 1000);
+    CU_TEST_CHECK(cu_array_shrink_to_fit(&arr) == 0);
+    CU_TEST_CHECK(arr.capacity == 40);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 39) == 39);
+    cu_array_clear(&arr);
+    CU_TEST_CHECK(cu_array_shrink_to_fit(&arr) == 0);
+    CU_TEST_CHECK(arr.capacity == 0);
+    CU_TEST_CHECK(arr.data == NULL);
+    CU_TEST_CHECK(cu_array_append(&arr, &too_many) == 0);
+    CU_TEST_CHECK(arr.capacity == CU_ARRAY_DEFAULT_SIZE);
+
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("A never used array can be deinitialized.");
+    cu_array_init(&arr, sizeof(int));
+    CU_TEST_CHECK(cu_array_deinit(&arr) == 0);
+    CU_TEST_CHECK(cu_array_init(&arr, 0) == 1);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_15()
+{
+    CU_TEST_START("cu_array mmap backend", "Checks if arrays backed by mmap grow, shrink and keep their items.");
+
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    unsigned int mmap_flags[2] = {0, CU_ARRAY_MMAP_HUGE_PAGES};
+    for (int f = 0; f < 2; f++)
+    {
+        cu_array_t arr = (cu_array_t){0};
+        CU_TEST_REQUIRE(cu_array_init_mmap(&arr, sizeof(int), mmap_flags[f]) == 0);
+        CU_TEST_CHECK(arr.allocator == cu_array_mmap_allocator(mmap_flags[f]));
+
+        int ok = 1;
+        for (int i = 0; i < 1000000; i++)
+        {
+            ok &= cu_array_append(&arr, &i) == 0;
+        }
+        CU_TEST_CHECK(ok);
+        CU_TEST_CHECK((size_t)arr.data % page_size == 0);
+        if (mmap_flags[f] & CU_ARRAY_MMAP_HUGE_PAGES)
+        {
+            CU_TEST_CHECK(arr.capacity * arr.item_size >= CU_ARRAY_HUGE_PAGE_SIZE);
+        }
+        for (int i = 0; i < 1000000; i++)
+        {
+            ok &= *(int *)cu_array_at(&arr, i) == i;
+        }
+        CU_TEST_CHECK(ok);
+
+        CU_TEST_COMMENT("Shrinking unmaps the tail, the items stay.");
+        for (int i = 0; i < 999000; i++)
+        {
+            cu_array_remove_at(&arr, arr.length - 1);
+        }
+        CU_TEST_CHECK(cu_array_shrink_to_fit(&arr) == 0);
+        CU_TEST_CHECK(arr.capacity == 1000);
+        CU_TEST_CHECK(*(int *)cu_array_at(&arr, 999) == 999);
+
+        CU_TEST_COMMENT("Sizes that can't be rounded to whole pages are rejected.");
+        size_t capacity = arr.capacity;
+        CU_TEST_CHECK(cu_array_reserve(&arr, SIZE_MAX / sizeof(int) - 100u) == 1 && arr.capacity == capacity);
+        CU_TEST_CHECK(arr.allocator->alloc(arr.allocator->ctx, SIZE_MAX - 100u) == NULL);
+        CU_TEST_CHECK(*(int *)cu_array_at(&arr, 999) == 999);
+
+        CU_TEST_CHECK(cu_array_deinit(&arr) == 0);
+    }
+
+    cu_array_t bytes = (cu_array_t){0};
+    cu_array_init_mmap(&bytes, 1, CU_ARRAY_MMAP_HUGE_PAGES);
+    CU_TEST_CHECK(cu_array_reserve(&bytes, SIZE_MAX - 100u) == 1 && bytes.capacity == 0 && bytes.data == NULL);
+    cu_array_deinit(&bytes);
+
+    CU_TEST_COMMENT("Huge page storage stays aligned when it can't grow in place.");
+    const cu_allocator_t *huge = cu_array_mmap_allocator(CU_ARRAY_MMAP_HUGE_PAGES);
+    unsigned char *ptr = (unsigned char *)huge->alloc(huge->ctx, CU_ARRAY_HUGE_PAGE_SIZE);
+    CU_TEST_REQUIRE(ptr != NULL);
+    ptr[0] = 42;
+    // Only a hint, the move is forced if the kernel puts the page right after the storage.
+    void *blocker = mmap(ptr + CU_ARRAY_HUGE_PAGE_SIZE, page_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    CU_TEST_REQUIRE(blocker != MAP_FAILED);
+    unsigned char *moved = (unsigned char *)huge->realloc(huge->ctx, ptr, CU_ARRAY_HUGE_PAGE_SIZE, 3u * CU_ARRAY_HUGE_PAGE_SIZE);
+    CU_TEST_REQUIRE(moved != NULL);
+    CU_TEST_CHECK(blocker != ptr + CU_ARRAY_HUGE_PAGE_SIZE || moved != ptr);
+    CU_TEST_CHECK((size_t)moved % CU_ARRAY_HUGE_PAGE_SIZE == 0 && moved[0] == 42);
+    moved[3u * CU_ARRAY_HUGE_PAGE_SIZE - 1u] = 1;
+    huge->free(huge->ctx, moved, 3u * CU_ARRAY_HUGE_PAGE_SIZE);
+    munmap(blocker, page_size);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_16()
+{
+    CU_TEST_START("cu_array save and map", "Checks if saved arrays can be mapped back read-only and copy-on-write.");
+
+    const char *path = "build/test_cu_array_tc_16.bin";
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+    for (int i = 0; i < 10000; i++)
+    {
+        cu_array_append(&arr, &i);
+    }
+    CU_TEST_REQUIRE(cu_array_save(&arr, path) == 0);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Read-only mapping, the first modification copies the items out.");
+    cu_array_t mapped = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_map(&mapped, path, CU_ARRAY_MAP_READONLY | CU_ARRAY_MAP_VERIFY) == 0);
+    CU_TEST_CHECK(mapped.item_size == sizeof(int));
+    CU_TEST_CHECK(mapped.length == 10000);
+    CU_TEST_CHECK((size_t)mapped.data % 64 == 0);
+    CU_TEST_CHECK(mapped.flags == (CU_ARRAY_MAPPED | CU_ARRAY_READONLY));
+    CU_TEST_CHECK(*(int *)cu_array_at(&mapped, 1234) == 1234);
+    CU_TEST_CHECK(cu_array_remove_at(&mapped, 0) == 0);
+    CU_TEST_CHECK(mapped.flags == 0);
+    CU_TEST_CHECK(*(int *)cu_array_at(&mapped, 0) == 1);
+    cu_array_deinit(&mapped);
+
+    CU_TEST_COMMENT("Views of a read-only mapping stay read-only, arrays over them copy the items out.");
+    CU_TEST_REQUIRE(cu_array_map(&mapped, path, CU_ARRAY_MAP_READONLY) == 0);
+    cu_array_view_t view = cu_array_view(&mapped);
+    CU_TEST_CHECK(view.flags == CU_ARRAY_READONLY);
+    cu_array_view_t part = (cu_array_view_t){0};
+    CU_TEST_REQUIRE(cu_array_slice(&mapped, 100, 50, &part) == 0);
+    CU_TEST_CHECK(part.flags == CU_ARRAY_READONLY);
+    CU_TEST_CHECK(cu_array_view_qsort(part, compare_int_desc) == 1);
+    cu_array_t copy = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_from_view(&copy, part) == 0);
+    CU_TEST_CHECK(copy.flags == (CU_ARRAY_EXTERNAL_STORAGE | CU_ARRAY_READONLY));
+    CU_TEST_CHECK(cu_array_qsort(&copy, compare_int_desc) == 0);
+    CU_TEST_CHECK(copy.flags == 0);
+    CU_TEST_CHECK(copy.data != part.data);
+    CU_TEST_CHECK(*(int *)cu_array_at(&copy, 0) == 149);
+    CU_TEST_CHECK(*(int *)cu_array_view_at(part, 0) == 100);
+    cu_array_deinit(&copy);
+    cu_array_deinit(&mapped);
+
+    CU_TEST_COMMENT("Copy-on-write mapping, changes in place stay private, growth copies out.");
+    CU_TEST_REQUIRE(cu_array_map(&mapped, path, CU_ARRAY_MAP_COPY_ON_WRITE) == 0);
+    CU_TEST_CHECK(mapped.flags == CU_ARRAY_MAPPED);
+    CU_TEST_CHECK(cu_array_qsort(&mapped, compare_int_desc) == 0);
+    CU_TEST_CHECK(mapped.flags == CU_ARRAY_MAPPED);
+    CU_TEST_CHECK(*(int *)cu_array_at(&mapped, 0) == 9999);
+    int extra = -1;
+    CU_TEST_CHECK(cu_array_append(&mapped, &extra) == 0);
+    CU_TEST_CHECK(mapped.flags == 0);
+    CU_TEST_CHECK(mapped.length == 10001);
+    CU_TEST_CHECK(*(int *)cu_array_at(&mapped, 0) == 9999);
+    cu_array_deinit(&mapped);
+
+    CU_TEST_COMMENT("The file itself is unchanged.");
+    CU_TEST_REQUIRE(cu_array_map(&mapped, path, CU_ARRAY_MAP_READONLY | CU_ARRAY_MAP_VERIFY) == 0);
+    CU_TEST_CHECK(*(int *)cu_array_at(&mapped, 0) == 0);
+    CU_TEST_CHECK(cu_array_deinit(&mapped) == 0);
+
+    CU_TEST_COMMENT("Invalid flags, missing and corrupted files are rejected.");
+    CU_TEST_CHECK(cu_array_map(&mapped, path, CU_ARRAY_MAP_READONLY | CU_ARRAY_MAP_COPY_ON_WRITE) == 1);
+    CU_TEST_CHECK(cu_array_map(&mapped, "build/does_not_exist.bin", CU_ARRAY_MAP_READONLY) == 1);
+    FILE *file = fopen(path, "r+b");
+    CU_TEST_REQUIRE(file != NULL);
+    fseek(file, CU_ARRAY_FILE_DATA_OFFSET + 10, SEEK_SET);
+    fputc(0x55, file);
+    fclose(file);
+    CU_TEST_CHECK(cu_array_map(&mapped, path, CU_ARRAY_MAP_READONLY | CU_ARRAY_MAP_VERIFY) == 1);
+    CU_TEST_CHECK(mapped.data == NULL);
+    remove(path);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_17()
+{
+    CU_TEST_START("cu_array bulk operations", "Checks insert_range, remove_range and emplace_n.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+
+    CU_TEST_COMMENT("emplace_n hands out slots to fill in place.");
+    int *slots = (int *)cu_array_emplace_n(&arr, 100);
+    CU_TEST_REQUIRE(slots != NULL);
+    for (int i = 0; i < 100; i++)
+    {
+        slots[i] = i;
+    }
+    CU_TEST_CHECK(arr.length == 100);
+    CU_TEST_CHECK(cu_array_emplace_n(&arr, 0) == NULL);
+
+    CU_TEST_COMMENT("insert_range in the middle, at the front and at the end.");
+    int block[50];
+    for (int i = 0; i < 50; i++)
+    {
+        block[i] = 1000 + i;
+    }
+    CU_TEST_CHECK(cu_array_insert_range(&arr, block, 50, 10) == 0);
+    CU_TEST_CHECK(arr.length == 150);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 9) == 9);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 10) == 1000);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 59) == 1049);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 60) == 10);
+    CU_TEST_CHECK(cu_array_insert_range(&arr, block, 2, 0) == 0);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 0) == 1000);
+    CU_TEST_CHECK(cu_array_insert_range(&arr, block, 2, arr.length) == 0);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, arr.length - 1) == 1001);
+    CU_TEST_CHECK(cu_array_insert_range(&arr, block, 2, arr.length + 1) == 1);
+    CU_TEST_CHECK(arr.length == 154);
+
+    CU_TEST_COMMENT("remove_range undoes the inserts.");
+    CU_TEST_CHECK(cu_array_remove_range(&arr, arr.length - 2, 2) == 0);
+    CU_TEST_CHECK(cu_array_remove_range(&arr, 0, 2) == 0);
+    CU_TEST_CHECK(cu_array_remove_range(&arr, 10, 50) == 0);
+    CU_TEST_CHECK(arr.length == 100);
+    int ok = 1;
+    for (int i = 0; i < 100; i++)
+    {
+        ok &= *(int *)cu_array_at(&arr, i) == i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_remove_range(&arr, 90, 11) == 1);
+    CU_TEST_CHECK(cu_array_remove_range(&arr, 101, 0) == 1);
+    CU_TEST_CHECK(cu_array_remove_range(&arr, 100, 0) == 0);
+    CU_TEST_CHECK(cu_array_remove_range(&arr, 0, 100) == 0);
+    CU_TEST_CHECK(arr.length == 0);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int is_multiple_of(void *item, void *ctx)
+{
+    return *(int *)item % *(int *)ctx == 0;
+}
+
+int test_cu_array_tc_18()
+{
+    CU_TEST_START("cu_array retain and swap_remove", "Checks filtering in a single pass and O(1) unordered removal.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+    for (int i = 0; i < 1000; i++)
+    {
+        cu_array_append(&arr, &i);
+    }
+
+    int divisor = 3;
+    CU_TEST_CHECK(cu_array_retain(&arr, is_multiple_of, &divisor) == 0);
+    CU_TEST_CHECK(arr.length == 334);
+    int ok = 1;
+    for (size_t i = 0; i < arr.length; i++)
+    {
+        ok &= *(int *)cu_array_at(&arr, i) == (int)(3 * i);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_retain(&arr, NULL, &divisor) == 1);
+
+    divisor = 1;
+    CU_TEST_CHECK(cu_array_retain(&arr, is_multiple_of, &divisor) == 0);
+    CU_TEST_CHECK(arr.length == 334);
+    divisor = 100000;
+    CU_TEST_CHECK(cu_array_retain(&arr, is_multiple_of, &divisor) == 0);
+    CU_TEST_CHECK(arr.length == 1);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 0) == 0);
+
+    CU_TEST_COMMENT("swap_remove moves the last item into the hole.");
+    cu_array_clear(&arr);
+    int to_extend[5] = {0, 1, 2, 3, 4};
+    cu_array_extend(&arr, to_extend, 5);
+    CU_TEST_CHECK(cu_array_swap_remove(&arr, 1) == 0);
+    CU_TEST_CHECK(arr.length == 4);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 1) == 4);
+    CU_TEST_CHECK(cu_array_swap_remove(&arr, 3) == 0);
+    CU_TEST_CHECK(arr.length == 3);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 2) == 2);
+    CU_TEST_CHECK(cu_array_swap_remove(&arr, 3) == 1);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_19()
+{
+    CU_TEST_START("cu_array binary search", "Checks lower_bound, upper_bound, bsearch and insert_sorted, generic and typed.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+    int key = 5;
+    CU_TEST_CHECK(cu_array_lower_bound(&arr, &key, cu_compare_int) == 0);
+    CU_TEST_CHECK(cu_array_upper_bound(&arr, &key, cu_compare_int) == 0);
+    CU_TEST_CHECK(cu_array_bsearch(&arr, &key, cu_compare_int) == NULL);
+    CU_TEST_CHECK(cu_array_insert_sorted(&arr, &key, NULL) == 1);
+
+    CU_TEST_COMMENT("Every even number in [0, 200) twice, inserted in scrambled order.");
+    for (int i = 0; i < 200; i++)
+    {
+        int x = ((i * 37) % 100) * 2;
+        CU_TEST_CHECK(cu_array_insert_sorted(&arr, &x, cu_compare_int) == 0);
+    }
+    CU_TEST_CHECK(arr.length == 200);
+    CU_TEST_CHECK(is_sorted_int(&arr));
+
+    int ok = 1;
+    for (int k = -1; k <= 200; k++)
+    {
+        size_t expected_lower = k < 0 ? 0 : (size_t)((k + 1) / 2) * 2;
+        size_t expected_upper = k < 0 ? 0 : (size_t)(k / 2 + 1) * 2;
+        if (k >= 200)
+        {
+            expected_lower = 200;
+            expected_upper = 200;
+        }
+        ok &= cu_array_lower_bound(&arr, &k, cu_compare_int) == expected_lower;
+        ok &= cu_array_upper_bound(&arr, &k, cu_compare_int) == expected_upper;
+        int *found = (int *)cu_array_bsearch(&arr, &k, cu_compare_int);
+        ok &= (k >= 0 && k % 2 == 0) ? (found == (int *)cu_array_at(&arr, expected_lower)) : (found == NULL);
+    }
+    CU_TEST_CHECK(ok);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("The typed variants agree with the generic ones.");
+    cu_array_int_t typed = {0};
+    cu_array_int_init(&typed);
+    CU_TEST_CHECK(cu_array_int_lower_bound(&typed, 1) == 0);
+    CU_TEST_CHECK(cu_array_int_bsearch(&typed, 1) == NULL);
+    for (int i = 0; i < 300; i++)
+    {
+        CU_TEST_CHECK(cu_array_int_insert_sorted(&typed, (i * 71) % 150) == 0);
+    }
+    CU_TEST_CHECK(is_sorted_int(&typed.base));
+    ok = 1;
+    for (int k = -2; k <= 152; k++)
+    {
+        ok &= cu_array_int_lower_bound(&typed, k) == cu_array_lower_bound(&typed.base, &k, cu_compare_int);
+        ok &= cu_array_int_upper_bound(&typed, k) == cu_array_upper_bound(&typed.base, &k, cu_compare_int);
+        ok &= cu_array_int_bsearch(&typed, k) == (int *)cu_array_bsearch(&typed.base, &k, cu_compare_int);
+    }
+    CU_TEST_CHECK(ok);
+    cu_array_int_deinit(&typed);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_20()
+{
+    CU_TEST_START("cu_array Eytzinger layout", "Checks that searches on the Eytzinger layout agree with the sorted array.");
+
+    cu_array_t sorted = (cu_array_t){0};
+    cu_array_t eytz = (cu_array_t){0};
+    cu_array_int_t typed = {0};
+    cu_array_init(&sorted, sizeof(int));
+    cu_array_init(&eytz, sizeof(int));
+    cu_array_int_init(&typed);
+    int key = 3;
+    CU_TEST_CHECK(cu_array_eytzinger_build(&eytz) == 0);
+    CU_TEST_CHECK(cu_array_eytzinger_lower_bound(&eytz, &key, cu_compare_int) == 0);
+    CU_TEST_CHECK(cu_array_eytzinger_search(&eytz, &key, cu_compare_int) == NULL);
+    CU_TEST_CHECK(cu_array_eytzinger_build(NULL) == 1);
+
+    int ok = 1;
+    for (size_t n = 1; n <= 600; n += 37)
+    {
+        cu_array_clear(&sorted);
+        cu_array_clear(&eytz);
+        cu_array_clear(&typed.base);
+        for (size_t i = 0; i < n; i++)
+        {
+            int x = (int)(i / 2u) * 3;
+            cu_array_append(&sorted, &x);
+            cu_array_append(&eytz, &x);
+            cu_array_int_append(&typed, x);
+        }
+        ok &= cu_array_eytzinger_build(&eytz) == 0;
+        ok &= cu_array_eytzinger_build(&typed.base) == 0;
+
+        for (int k = -1; k <= (int)n * 2; k++)
+        {
+            size_t lower = cu_array_lower_bound(&sorted, &k, cu_compare_int);
+            size_t pos = cu_array_eytzinger_lower_bound(&eytz, &k, cu_compare_int);
+            ok &= cu_array_int_eytzinger_lower_bound(&typed, k) == pos;
+            if (lower == sorted.length)
+            {
+                ok &= pos == eytz.length;
+            }
+            else
+            {
+                ok &= pos < eytz.length && *(int *)cu_array_at(&eytz, pos) == *(int *)cu_array_at(&sorted, lower);
+            }
+            int *found = (int *)cu_array_eytzinger_search(&eytz, &k, cu_compare_int);
+            ok &= (cu_array_bsearch(&sorted, &k, cu_compare_int) == NULL) == (found == NULL);
+            ok &= found == NULL || *found == k;
+        }
+    }
+    CU_TEST_CHECK(ok);
+
+    cu_array_deinit(&sorted);
+    cu_array_deinit(&eytz);
+    cu_array_int_deinit(&typed);
+    CU_TEST_END();
+}
+
+typedef struct stats_hook_log_s
+{
+    size_t events[5];
+    size_t bytes;
+    cu_array_stats_t last;
+} stats_hook_log_t;
+
+void stats_hook(cu_array_t *arr, unsigned int event, size_t bytes, void *ctx)
+{
+    stats_hook_log_t *log = (stats_hook_log_t *)ctx;
+    log->events[event] += 1;
+    log->bytes += bytes;
+    log->last = arr->stats;
+}
+
+int test_cu_array_tc_21()
+{
+    CU_TEST_START("cu_array stats", "Checks the CU_ARRAY_STATS counters and the hook.");
+
+    stats_hook_log_t log = {{0}, 0, {0}};
+    cu_array_set_stats_hook(stats_hook, &log);
+    cu_array_int_t arr = {0};
+    cu_array_int_init(&arr);
+    for (int i = 0; i < 100; i++)
+    {
+        cu_array_int_append(&arr, i);
+    }
+    CU_TEST_CHECK(arr.base.stats.grows == log.events[CU_ARRAY_STATS_GROW] && arr.base.stats.grows >= 2);
+    CU_TEST_CHECK(arr.base.stats.peak_length == 100 && arr.base.stats.peak_capacity == arr.base.capacity);
+    CU_TEST_CHECK(arr.base.stats.moves == 0 && arr.base.stats.reserves == 0);
+
+    CU_TEST_COMMENT("Inserting or removing before the end shifts the tail.");
+    int x = -1;
+    cu_array_insert(&arr.base, &x, 0);
+    CU_TEST_CHECK(arr.base.stats.moves == 1 && arr.base.stats.moved_bytes == 100 * sizeof(int));
+    cu_array_remove_at(&arr.base, 0);
+    CU_TEST_CHECK(arr.base.stats.moves == 2 && arr.base.stats.moved_bytes == 200 * sizeof(int));
+    cu_array_int_insert(&arr, 7, 90);
+    cu_array_int_remove_at(&arr, 90);
+    CU_TEST_CHECK(arr.base.stats.moves == 4 && arr.base.stats.moved_bytes == 220 * sizeof(int));
+    cu_array_int_remove_at(&arr, 99);
+    cu_array_append(&arr.base, &x);
+    CU_TEST_CHECK(arr.base.stats.moves == 4 && log.events[CU_ARRAY_STATS_MOVE] == 4);
+    CU_TEST_CHECK(*cu_array_int_at(&arr, 90) == 90 && *cu_array_int_at(&arr, 99) == -1);
+
+    CU_TEST_COMMENT("Reserve and shrink are counted, extend is not a reserve.");
+    size_t grows = arr.base.stats.grows;
+    cu_array_reserve(&arr.base, 1000);
+    CU_TEST_CHECK(arr.base.stats.reserves == 1 && arr.base.stats.grows == grows + 1);
+    CU_TEST_CHECK(arr.base.stats.peak_capacity == 1000);
+    cu_array_extend(&arr.base, arr.base.data, 10);
+    CU_TEST_CHECK(arr.base.stats.reserves == 1 && arr.base.stats.grows == grows + 1);
+    CU_TEST_CHECK(arr.base.stats.peak_length == 110);
+    cu_array_shrink_to_fit(&arr.base);
+    CU_TEST_CHECK(arr.base.stats.shrinks == 1 && arr.base.capacity == 110 && arr.base.stats.peak_capacity == 1000);
+    CU_TEST_CHECK(log.bytes == arr.base.stats.copied_bytes + arr.base.stats.moved_bytes);
+
+    CU_TEST_COMMENT("The hook sees the final counters before they are cleared.");
+    cu_array_stats_t final_stats = arr.base.stats;
+    cu_array_int_deinit(&arr);
+    CU_TEST_CHECK(log.events[CU_ARRAY_STATS_DEINIT] == 1);
+    CU_TEST_CHECK(log.last.grows == final_stats.grows && log.last.peak_length == 110);
+    CU_TEST_CHECK(arr.base.stats.grows == 0);
+
+    cu_array_set_stats_hook(NULL, NULL);
+    cu_array_init(&arr.base, sizeof(int));
+    cu_array_append(&arr.base, &x);
+    CU_TEST_CHECK(arr.base.stats.grows == 1 && log.events[CU_ARRAY_STATS_GROW] == final_stats.grows);
+    cu_array_deinit(&arr.base);
+
+    CU_TEST_COMMENT("mremap moves pages, the items are never copied.");
+    cu_array_t mapped = (cu_array_t){0};
+    cu_array_init_mmap(&mapped, sizeof(int), 0);
+    int ok = 1;
+    for (int i = 0; i < 100000; i++)
+    {
+        ok &= cu_array_append(&mapped, &i) == 0;
+    }
+    CU_TEST_CHECK(ok && mapped.stats.grows >= 2 && mapped.stats.copied_bytes == 0);
+    cu_array_deinit(&mapped);
+    CU_TEST_END();
+}
+
+typedef struct chunk_log_s
+{
+    size_t calls;
+    size_t items;
+    size_t max_count;
+    long long sum;
+    int in_order;
+} chunk_log_t;
+
+void chunk_sum(void *items, size_t count, void *ctx)
+{
+    chunk_log_t *log = (chunk_log_t *)ctx;
+    const int *ints = (const int *)items;
+    log->in_order &= ints[0] == (int)log->items;
+    log->calls += 1;
+    log->items += count;
+    log->max_count = count > log->max_count ? count : log->max_count;
+    for (size_t i = 0; i < count; i++)
+    {
+        log->sum += ints[i];
+    }
+}
+
+int test_cu_array_tc_22()
+{
+    CU_TEST_START("cu_array iterators", "Checks begin/end, the cursor, CU_ARRAY_FOREACH and cu_array_for_each_chunk.");
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+    CU_TEST_CHECK(cu_array_begin(&arr) == NULL && cu_array_end(&arr) == NULL);
+    cu_array_iter_t it = cu_array_iter(&arr);
+    CU_TEST_CHECK(cu_array_iter_next(&it) == NULL);
+    int visited = 0;
+    CU_ARRAY_FOREACH(int, x, &arr)
+    {
+        (void)x;
+        visited++;
+    }
+    CU_TEST_CHECK(visited == 0);
+    chunk_log_t log = {0, 0, 0, 0, 1};
+    CU_TEST_CHECK(cu_array_for_each_chunk(&arr, 8, chunk_sum, &log) == 0 && log.calls == 0);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        cu_array_append(&arr, &i);
+    }
+    CU_TEST_CHECK(cu_array_end(&arr) - cu_array_begin(&arr) == (ptrdiff_t)(1000 * sizeof(int)));
+    long long sum = 0;
+    CU_ARRAY_FOREACH(int, x, &arr)
+    {
+        sum += *x;
+    }
+    CU_TEST_CHECK(sum == 999 * 1000 / 2);
+
+    it = cu_array_iter(&arr);
+    CU_TEST_CHECK(it.stride == sizeof(int));
+    int ok = 1;
+    int expect = 0;
+    for (CU_UNIT *item; (item = cu_array_iter_next(&it)) != NULL; expect++)
+    {
+        ok &= *(int *)item == expect;
+    }
+    CU_TEST_CHECK(ok && expect == 1000);
+    CU_TEST_CHECK(cu_array_iter_next(&it) == NULL);
+
+    CU_TEST_COMMENT("Chunks cover every item once, the last one is shorter.");
+    CU_TEST_CHECK(cu_array_for_each_chunk(&arr, 64, chunk_sum, &log) == 0);
+    CU_TEST_CHECK(log.calls == 16 && log.items == 1000 && log.max_count == 64 && log.in_order);
+    CU_TEST_CHECK(log.sum == sum);
+    log = (chunk_log_t){0, 0, 0, 0, 1};
+    CU_TEST_CHECK(cu_array_for_each_chunk(&arr, 5000, chunk_sum, &log) == 0);
+    CU_TEST_CHECK(log.calls == 1 && log.items == 1000 && log.sum == sum);
+    CU_TEST_CHECK(cu_array_for_each_chunk(&arr, 0, chunk_sum, &log) == 1);
+    CU_TEST_CHECK(cu_array_for_each_chunk(&arr, 8, NULL, &log) == 1);
+    CU_TEST_CHECK(cu_array_for_each_chunk(NULL, 8, chunk_sum, &log) == 1);
+    it = cu_array_iter(NULL);
+    CU_TEST_CHECK(cu_array_iter_next(&it) == NULL && cu_array_begin(NULL) == NULL);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_23()
+{
+    CU_TEST_START("cu_array aligned storage", "Checks that aligned storage stays aligned while growing and shrinking.");
+
+    cu_array_t arr = (cu_array_t){0};
+    CU_TEST_CHECK(cu_array_init_aligned(&arr, sizeof(int), 0) == 1);
+    CU_TEST_CHECK(cu_array_init_aligned(&arr, sizeof(int), 48) == 1);
+    CU_TEST_CHECK(cu_array_init_aligned(&arr, 0, 64) == 1);
+    CU_TEST_REQUIRE(cu_array_init_aligned(&arr, sizeof(int), 64) == 0);
+    CU_TEST_CHECK(arr.alignment == 64 && arr.item_size == sizeof(int));
+
+    int ok = 1;
+    CU_UNIT *last_data = NULL;
+    size_t moves = 0;
+    for (int i = 0; i < 5000; i++)
+    {
+        ok &= cu_array_append(&arr, &i) == 0;
+        ok &= ((uintptr_t)arr.data & 63u) == 0u;
+        moves += arr.data != last_data;
+        last_data = arr.data;
+    }
+    CU_TEST_CHECK(ok && moves > 3);
+    ok = 1;
+    for (int i = 0; i < 5000; i++)
+    {
+        ok &= *(int *)cu_array_at(&arr, (size_t)i) == i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_reserve(&arr, 20000) == 0 && ((uintptr_t)arr.data & 63u) == 0u);
+    CU_TEST_CHECK(cu_array_shrink_to_fit(&arr) == 0 && ((uintptr_t)arr.data & 63u) == 0u);
+    CU_TEST_CHECK(arr.capacity == 5000 && *(int *)cu_array_at(&arr, 4999) == 4999);
+    cu_array_qsort(&arr, compare_int_desc);
+    CU_TEST_CHECK(*(int *)cu_array_at(&arr, 0) == 4999);
+    cu_array_deinit(&arr);
+    CU_TEST_CHECK(arr.alignment == 0);
+
+    CU_TEST_COMMENT("Small alignments are raised to fit the stored block pointer.");
+    CU_TEST_CHECK(cu_array_init_aligned(&arr, 1, 2) == 0 && arr.alignment == sizeof(void *));
+    char c = 'x';
+    CU_TEST_CHECK(cu_array_append(&arr, &c) == 0 && ((uintptr_t)arr.data % sizeof(void *)) == 0u);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Padded items each start on their own cache line.");
+    CU_TEST_CHECK(cu_array_init_padded(&arr, 12, 64) == 0);
+    CU_TEST_CHECK(arr.item_size == 64 && arr.alignment == 64);
+    CU_UNIT *items = cu_array_emplace_n(&arr, 100);
+    CU_TEST_REQUIRE(items != NULL);
+    ok = 1;
+    for (size_t i = 0; i < 100; i++)
+    {
+        CU_UNIT *item = cu_array_at(&arr, i);
+        ok &= ((uintptr_t)item & 63u) == 0u;
+        memcpy(item, &i, sizeof(i));
+    }
+    CU_TEST_CHECK(ok);
+    cu_array_remove_at(&arr, 0);
+    size_t first = 0;
+    memcpy(&first, cu_array_at(&arr, 0), sizeof(first));
+    CU_TEST_CHECK(first == 1);
+    cu_array_deinit(&arr);
+    CU_TEST_CHECK(cu_array_init_padded(&arr, 12, 24) == 1);
+    CU_TEST_END();
+}
+
+typedef struct sized_heap_s
+{
+    size_t live_bytes;
+    size_t last_free_size;
+} sized_heap_t;
+
+void *sized_heap_alloc(void *ctx, size_t size)
+{
+    ((sized_heap_t *)ctx)->live_bytes += size;
+    return malloc(size);
+}
+
+void *sized_heap_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+    sized_heap_t *heap = (sized_heap_t *)ctx;
+    void *tmp = realloc(ptr, new_size);
+    if (tmp != NULL)
+    {
+        heap->live_bytes = heap->live_bytes - old_size + new_size;
+    }
+    return tmp;
+}
+
+void sized_heap_free(void *ctx, void *ptr, size_t size)
+{
+    sized_heap_t *heap = (sized_heap_t *)ctx;
+    heap->live_bytes -= size;
+    heap->last_free_size = size;
+    free(ptr);
+}
+
+int test_cu_array_tc_24()
+{
+    CU_TEST_START("cu_array move, swap, detach and views", "Checks the O(1) ownership transfers and the non-owning slices.");
+
+    cu_array_t a = (cu_array_t){0};
+    cu_array_t b = (cu_array_t){0};
+    cu_array_init(&a, sizeof(int));
+    for (int i = 0; i < 100; i++)
+    {
+        cu_array_append(&a, &i);
+    }
+    CU_UNIT *data = a.data;
+    CU_TEST_CHECK(cu_array_move(&b, &a) == 0);
+    CU_TEST_CHECK(b.data == data && b.length == 100 && *(int *)cu_array_at(&b, 99) == 99);
+    CU_TEST_CHECK(a.data == NULL && a.length == 0 && a.capacity == 0 && a.item_size == sizeof(int));
+    CU_TEST_CHECK(b.stats.peak_length == 100 && a.stats.peak_length == 0);
+    CU_TEST_CHECK(cu_array_move(&b, &b) == 0 && b.data == data);
+    CU_TEST_CHECK(cu_array_move(&b, NULL) == 1 && cu_array_move(NULL, &b) == 1);
+
+    CU_TEST_COMMENT("The moved-from array is still usable, an initialized destination is deinitialized first.");
+    int x = 7;
+    CU_TEST_CHECK(cu_array_append(&a, &x) == 0 && a.length == 1);
+    CU_TEST_CHECK(cu_array_swap(&a, &b) == 0);
+    CU_TEST_CHECK(a.data == data && a.length == 100 && b.length == 1 && *(int *)cu_array_at(&b, 0) == 7);
+    CU_TEST_CHECK(cu_array_move(&b, &a) == 0 && b.data == data && b.length == 100 && a.length == 0);
+    CU_TEST_CHECK(cu_array_swap(&a, NULL) == 1);
+
+    CU_TEST_COMMENT("Views and slices share the items of the array.");
+    cu_array_view_t view = cu_array_view(&b);
+    CU_TEST_CHECK(view.data == b.data && view.length == 100 && view.item_size == sizeof(int));
+    cu_array_view_t slice;
+    CU_TEST_REQUIRE(cu_array_slice(&b, 20, 10, &slice) == 0);
+    CU_TEST_CHECK(slice.data == cu_array_at(&b, 20) && slice.length == 10);
+    CU_TEST_CHECK(*(int *)cu_array_view_at(slice, 9) == 29 && cu_array_view_at(slice, 10) == NULL);
+    CU_TEST_CHECK(cu_array_slice(&b, 95, 6, &slice) == 1 && cu_array_slice(&b, 101, 0, &slice) == 1);
+    CU_TEST_CHECK(cu_array_slice(&b, 100, 0, &slice) == 0 && slice.length == 0 && slice.data == NULL);
+    cu_array_view_t sub;
+    CU_TEST_REQUIRE(cu_array_slice(&b, 20, 10, &slice) == 0);
+    CU_TEST_CHECK(cu_array_view_slice(slice, 5, 5, &sub) == 0 && *(int *)cu_array_view_at(sub, 0) == 25);
+    CU_TEST_CHECK(cu_array_view_slice(slice, 5, 6, &sub) == 1);
+
+    CU_TEST_CHECK(cu_array_view_qsort(slice, compare_int_desc) == 0);
+    int ok = *(int *)cu_array_at(&b, 19) == 19 && *(int *)cu_array_at(&b, 30) == 30;
+    for (int i = 0; i < 10; i++)
+    {
+        ok &= *(int *)cu_array_at(&b, 20 + (size_t)i) == 29 - i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_view_qsort(slice, cu_compare_int) == 0);
+    int key = 27;
+    CU_TEST_CHECK(cu_array_view_lower_bound(slice, &key, cu_compare_int) == 7);
+    CU_TEST_CHECK(cu_array_view_bsearch(slice, &key, cu_compare_int) == cu_array_at(&b, 27));
+    key = 50;
+    CU_TEST_CHECK(cu_array_view_lower_bound(slice, &key, cu_compare_int) == 10);
+    CU_TEST_CHECK(cu_array_view_bsearch(slice, &key, cu_compare_int) == NULL);
+
+    CU_TEST_COMMENT("An array over a view writes through until it grows.");
+    cu_array_t over = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_from_view(&over, slice) == 0);
+    CU_TEST_CHECK(over.data == slice.data && over.length == 10 && (over.flags & CU_ARRAY_EXTERNAL_STORAGE));
+    x = -1;
+    *(int *)cu_array_at(&over, 0) = x;
+    CU_TEST_CHECK(*(int *)cu_array_at(&b, 20) == -1);
+    CU_TEST_CHECK(cu_array_append(&over, &x) == 0 && over.data != slice.data && b.length == 100);
+    cu_array_deinit(&over);
+    cu_array_view_t empty = {0};
+    empty.item_size = sizeof(int);
+    CU_TEST_CHECK(cu_array_from_view(&over, empty) == 0 && over.length == 0 && over.data == NULL);
+    cu_array_deinit(&over);
+    empty.length = 1;
+    CU_TEST_CHECK(cu_array_from_view(&over, empty) == 1 && cu_array_view_qsort(empty, cu_compare_int) == 1);
+
+    CU_TEST_COMMENT("Detached buffers belong to the caller.");
+    size_t len = 1234;
+    int *raw = (int *)cu_array_detach(&b, &len);
+    CU_TEST_CHECK(raw != NULL && len == 100 && raw[99] == 99 && raw[20] == -1);
+    CU_TEST_CHECK(b.data == NULL && b.length == 0 && b.capacity == 0 && b.item_size == sizeof(int));
+    cu_free(raw);
+    CU_TEST_CHECK(cu_array_detach(&b, &len) == NULL && len == 0);
+    cu_array_deinit(&b);
+    cu_array_deinit(&a);
+
+    sized_heap_t heap = {0};
+    cu_allocator_t allocator = {sized_heap_alloc, sized_heap_realloc, sized_heap_free, &heap};
+    CU_TEST_REQUIRE(cu_array_init_with_allocator(&a, sizeof(int), &allocator) == 0);
+    for (int i = 0; i < 40; i++)
+    {
+        cu_array_append(&a, &i);
+    }
+    CU_TEST_CHECK(a.capacity > 40);
+    raw = (int *)cu_array_detach(&a, &len);
+    CU_TEST_CHECK(raw != NULL && len == 40 && raw[39] == 39 && heap.live_bytes == 40 * sizeof(int));
+    allocator.free(allocator.ctx, raw, sizeof(int) * len);
+    CU_TEST_CHECK(heap.live_bytes == 0 && heap.last_free_size == 40 * sizeof(int));
+    cu_array_deinit(&a);
+
+    CU_TEST_COMMENT("Inline storage is copied out, aligned storage can't be detached.");
+    CU_SARRAY(int, 8) sarr;
+    CU_SARRAY_INIT(&sarr);
+    for (int i = 0; i < 3; i++)
+    {
+        cu_array_append(&sarr.base, &i);
+    }
+    raw = (int *)cu_array_detach(&sarr.base, NULL);
+    CU_TEST_CHECK(raw != NULL && (void *)raw != (void *)sarr.storage && raw[2] == 2);
+    CU_TEST_CHECK(sarr.base.flags == 0 && sarr.base.data == NULL);
+    cu_free(raw);
+    cu_array_deinit(&sarr.base);
+    CU_TEST_CHECK(cu_array_init_aligned(&a, sizeof(int), 64) == 0 && cu_array_append(&a, &x) == 0);
+    CU_TEST_CHECK(cu_array_detach(&a, &len) == NULL && a.length == 1);
+    cu_array_deinit(&a);
+    CU_TEST_END();
+}
+
+typedef struct stamped_item_s
+{
+    int key;
+    int seq;
+} stamped_item_t;
+
+int compare_stamped_key(void *a, void *b)
+{
+    g_num_compares += 1;
+    return cu_compare_int(&((stamped_item_t *)a)->key, &((stamped_item_t *)b)->key);
+}
+
+int compare_stamped_key_seq(void *a, void *b)
+{
+    int c = cu_compare_int(&((stamped_item_t *)a)->key, &((stamped_item_t *)b)->key);
+    return c != 0 ? c : cu_compare_int(&((stamped_item_t *)a)->seq, &((stamped_item_t *)b)->seq);
+}
+
+/// Fills `arr` with `n` items in one of a few patterns, `seq` is the original position.
+void fill_stamped(cu_array_t *arr, size_t n, int pattern, unsigned int *state)
+{
+    cu_array_clear(arr);
+    for (size_t i = 0; i < n; i++)
+    {
+        *state = *state * 1103515245u + 12345u;
+        stamped_item_t item = {0, (int)i};
+        switch (pattern)
+        {
+        case 0: // random with many duplicates
+            item.key = (int)((*state >> 16) % 50u);
+            break;
+        case 1: // sorted
+            item.key = (int)(i / 3u);
+            break;
+        case 2: // reversed, with equal neighbours
+            item.key = (int)((n - i) / 2u);
+            break;
+        case 3: // ascending runs of random length
+            item.key = (int)(i % 37u) + (int)((*state >> 16) % 3u);
+            break;
+        default: // strictly descending
+            item.key = (int)(n - i);
+            break;
+        }
+        cu_array_append(arr, &item);
+    }
+}
+
+int test_cu_array_tc_25()
+{
+    CU_TEST_START("cu_array stable sort", "Checks that the merge sort keeps equal items in order for many patterns and sizes.");
+
+    static const size_t sizes[] = {0, 1, 2, 31, 64, 65, 200, 1000, 10007};
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_t expected = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(stamped_item_t));
+    cu_array_init(&expected, sizeof(stamped_item_t));
+    unsigned int state = 12345u;
+    int ok = 1;
+    for (int pattern = 0; pattern < 5; pattern++)
+    {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            fill_stamped(&arr, sizes[s], pattern, &state);
+            cu_array_clear(&expected);
+            cu_array_extend(&expected, arr.data, arr.length);
+            // With unique `seq`, the stable order by key is the order by (key, seq).
+            cu_array_qsort(&expected, compare_stamped_key_seq);
+            ok &= cu_array_stable_sort(&arr, compare_stamped_key) == 0;
+            ok &= arr.length == sizes[s];
+            ok &= arr.length == 0 || memcmp(arr.data, expected.data, arr.length * arr.item_size) == 0;
+        }
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Sorted and strictly descending input takes n - 1 comparisons.");
+    fill_stamped(&arr, 5000, 1, &state);
+    g_num_compares = 0;
+    CU_TEST_CHECK(cu_array_stable_sort(&arr, compare_stamped_key) == 0 && g_num_compares == 4999);
+    fill_stamped(&arr, 5000, 4, &state);
+    g_num_compares = 0;
+    CU_TEST_CHECK(cu_array_stable_sort(&arr, compare_stamped_key) == 0 && g_num_compares == 4999);
+    CU_TEST_CHECK(((stamped_item_t *)cu_array_at(&arr, 0))->key == 1);
+
+    CU_TEST_COMMENT("Random input stays within n log n comparisons.");
+    fill_stamped(&arr, 4096, 0, &state);
+    g_num_compares = 0;
+    CU_TEST_CHECK(cu_array_stable_sort(&arr, compare_stamped_key) == 0 && g_num_compares < 4096u * 12u);
+    cu_array_deinit(&arr);
+    cu_array_deinit(&expected);
+
+    CU_TEST_COMMENT("Large items, with a context.");
+    cu_array_init(&arr, sizeof(big_item_t));
+    for (int i = 0; i < 300; i++)
+    {
+        big_item_t item;
+        memset(&item, 0, sizeof(item));
+        item.key = (i * 7) % 10;
+        memcpy(item.payload, &i, sizeof(i));
+        cu_array_append(&arr, &item);
+    }
+    int direction = -1;
+    CU_TEST_CHECK(cu_array_stable_sort_r(&arr, compare_big_item_r, &direction) == 0);
+    ok = 1;
+    for (size_t i = 1; i < arr.length; i++)
+    {
+        big_item_t *prev = (big_item_t *)cu_array_at(&arr, i - 1);
+        big_item_t *cur = (big_item_t *)cu_array_at(&arr, i);
+        int pi, ci;
+        memcpy(&pi, prev->payload, sizeof(pi));
+        memcpy(&ci, cur->payload, sizeof(ci));
+        ok &= prev->key > cur->key || (prev->key == cur->key && pi < ci);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_stable_sort(&arr, NULL) == 1 && cu_array_stable_sort(NULL, compare_stamped_key) == 1);
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_26()
+{
+    CU_TEST_START("cu_array k-way merge", "Checks that merging sorted shards equals a stable sort of their concatenation.");
+
+    enum
+    {
+        num_shards = 21
+    };
+    cu_array_t shards[num_shards];
+    cu_array_t *srcs[num_shards];
+    cu_array_t expected = (cu_array_t){0};
+    cu_array_init(&expected, sizeof(stamped_item_t));
+    unsigned int state = 99u;
+    for (int s = 0; s < num_shards; s++)
+    {
+        shards[s] = (cu_array_t){0};
+        cu_array_init(&shards[s], sizeof(stamped_item_t));
+        // Shard 5 stays empty.
+        size_t n = s == 5 ? 0u : (size_t)(s * 37 % 101);
+        for (size_t i = 0; i < n; i++)
+        {
+            state = state * 1103515245u + 12345u;
+            stamped_item_t item = {(int)((state >> 16) % 40u), s * 1000 + (int)i};
+            cu_array_append(&shards[s], &item);
+        }
+        cu_array_stable_sort(&shards[s], compare_stamped_key);
+        cu_array_extend(&expected, shards[s].data, shards[s].length);
+        srcs[s] = &shards[s];
+    }
+    cu_array_stable_sort(&expected, compare_stamped_key);
+
+    cu_array_t merged = (cu_array_t){0};
+    cu_array_init(&merged, sizeof(stamped_item_t));
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs, num_shards, compare_stamped_key) == 0);
+    CU_TEST_CHECK(merged.length == expected.length && merged.stats.grows == 1);
+    CU_TEST_CHECK(memcmp(merged.data, expected.data, merged.length * merged.item_size) == 0);
+
+    CU_TEST_COMMENT("The output is appended after the items already in dst.");
+    stamped_item_t marker = {-1, -1};
+    cu_array_clear(&merged);
+    cu_array_append(&merged, &marker);
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs + 1, 1, compare_stamped_key) == 0);
+    CU_TEST_CHECK(merged.length == shards[1].length + 1 && ((stamped_item_t *)cu_array_at(&merged, 0))->seq == -1);
+    CU_TEST_CHECK(memcmp(cu_array_at(&merged, 1), shards[1].data, shards[1].length * shards[1].item_size) == 0);
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs, 0, compare_stamped_key) == 0 && merged.length == shards[1].length + 1);
+
+    CU_TEST_COMMENT("Invalid arguments leave dst unchanged.");
+    size_t length = merged.length;
+    srcs[3] = &merged;
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs, num_shards, compare_stamped_key) == 1);
+    srcs[3] = NULL;
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs, num_shards, compare_stamped_key) == 1);
+    cu_array_t ints = (cu_array_t){0};
+    cu_array_init(&ints, sizeof(int));
+    srcs[3] = &ints;
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs, num_shards, compare_stamped_key) == 1);
+    CU_TEST_CHECK(cu_array_merge_k(&merged, NULL, 2, compare_stamped_key) == 1 && merged.length == length);
+
+    cu_array_deinit(&ints);
+    cu_array_deinit(&merged);
+    cu_array_deinit(&expected);
+    for (int s = 0; s < num_shards; s++)
+    {
+        cu_array_deinit(&shards[s]);
+    }
+    CU_TEST_END();
+}
+
+int test_cu_array_tc_27()
+{
+    CU_TEST_START("cu_array streaming I/O", "Checks batched writes and window reads on a file and a pipe.");
+
+    const char *path = "build/test_cu_array_tc_27.bin";
+    cu_array_t parts[3];
+    cu_array_t *srcs[3] = {&parts[0], &parts[1], &parts[2]};
+    int value = 0;
+    for (int p = 0; p < 3; p++)
+    {
+        parts[p] = (cu_array_t){0};
+        cu_array_init(&parts[p], sizeof(int));
+        // The middle array stays empty.
+        for (int i = 0; p != 1 && i < 1250; i++, value++)
+        {
+            cu_array_append(&parts[p], &value);
+        }
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CU_TEST_REQUIRE(fd >= 0);
+    CU_TEST_CHECK(cu_array_writev_fd(srcs, 3, fd) == 0);
+    CU_TEST_CHECK(cu_array_write_fd(&parts[0], fd) == 0);
+    CU_TEST_CHECK(cu_array_writev_fd(srcs, 3, -1) == 1 && cu_array_writev_fd(NULL, 1, fd) == 1);
+    close(fd);
+
+    CU_TEST_COMMENT("The windows reuse the same storage.");
+    fd = open(path, O_RDONLY);
+    CU_TEST_REQUIRE(fd >= 0);
+    cu_array_t window = (cu_array_t){0};
+    cu_array_init(&window, sizeof(int));
+    size_t lengths[5] = {0};
+    size_t num_windows = 0;
+    int ok = 1;
+    int expected = 0;
+    CU_UNIT *data = NULL;
+    while (cu_array_read_chunk(&window, fd, 1000) == 0 && window.length > 0 && num_windows < 5)
+    {
+        data = data == NULL ? window.data : data;
+        ok &= window.data == data;
+        lengths[num_windows++] = window.length;
+        CU_ARRAY_FOREACH(int, x, &window)
+        {
+            // The file is 0..2499 followed by 0..1249.
+            ok &= *x == expected;
+            expected = expected == 2499 ? 0 : expected + 1;
+        }
+    }
+    CU_TEST_CHECK(ok && num_windows == 4 && window.length == 0 && window.stats.grows == 1);
+    CU_TEST_CHECK(window.stats.reserves == 1);
+    CU_TEST_CHECK(lengths[0] == 1000 && lengths[1] == 1000 && lengths[2] == 1000 && lengths[3] == 750);
+    CU_TEST_CHECK(cu_array_read_chunk(&window, -1, 10) == 1 && cu_array_read_chunk(NULL, fd, 10) == 1);
+    close(fd);
+    cu_array_deinit(&window);
+
+    CU_TEST_COMMENT("A small array refills its inline storage, a partial item at the end is an error.");
+    int pipe_fds[2];
+    CU_TEST_REQUIRE(pipe(pipe_fds) == 0);
+    CU_TEST_CHECK(cu_array_write_fd(&parts[0], pipe_fds[1]) == 0);
+    CU_TEST_CHECK(write(pipe_fds[1], "abc", 3) == 3);
+    close(pipe_fds[1]);
+    CU_SARRAY(int, 256) sarr;
+    CU_SARRAY_INIT(&sarr);
+    size_t total = 0;
+    int res;
+    ok = 1;
+    while ((res = cu_array_read_chunk(&sarr.base, pipe_fds[0], 0)) == 0 && sarr.base.length > 0)
+    {
+        ok &= sarr.base.data == (CU_UNIT *)sarr.storage && sarr.base.length <= 256;
+        ok &= *(int *)cu_array_at(&sarr.base, 0) == (int)total;
+        total += sarr.base.length;
+    }
+    CU_TEST_CHECK(ok && res == 1 && total + sarr.base.length == 1250);
+    close(pipe_fds[0]);
+    cu_array_deinit(&sarr.base);
+
+    for (int p = 0; p < 3; p++)
+    {
+        cu_array_deinit(&parts[p]);
+    }
+    remove(path);
+    CU_TEST_END();
+}
@@ -0,0 +1,406 @@
+#define CU_ARRAY_IMPL
+#define CU_ARRAY_SIMD_IMPL
+#define CU_BITSET_IMPL
+#include "../cu_array_simd.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+int test_cu_array_simd_tc_1();
+int test_cu_array_simd_tc_2();
+int test_cu_array_simd_tc_3();
+int test_cu_array_simd_tc_4();
+int test_cu_array_simd_tc_5();
+
+CU_RUN_TESTS("cu_array_simd unit test")
+{
+    test_cu_array_simd_tc_1();
+    test_cu_array_simd_tc_2();
+    test_cu_array_simd_tc_3();
+    test_cu_array_simd_tc_4();
+    test_cu_array_simd_tc_5();
+
+    CU_RUN_END();
+}
+
+uint64_t simd_test_random(uint64_t *state)
+{
+    // xorshift64, deterministic across runs.
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Fills `arr` with `len` items of type `T` that are all different from `(T)fill`, except position `pos`.
+#define SIMD_TEST_FILL_WITH_NEEDLE(arr, T, len, pos, needle, fill) \
+    do                                                             \
+    {                                                              \
+        cu_array_clear(arr);                                       \
+        for (size_t j = 0; j < (len); j++)                         \
+        {                                                          \
+            T x = (T)(fill);                                       \
+            if (j == (pos))                                        \
+            {                                                      \
+                x = (T)(needle);                                   \
+            }                                                      \
+            cu_array_append(arr, &x);                              \
+        }                                                          \
+    } while (0)
+
+// Checks find and count for every length in [0, 80) and every needle position, plus a long array.
+#define SIMD_TEST_FIND(ok, T, type)                                                            \
+    do                                                                                         \
+    {                                                                                          \
+        cu_array_t arr = (cu_array_t){0};                                                      \
+        cu_array_init(&arr, sizeof(T));                                                        \
+        T needle = (T)7;                                                                       \
+        for (size_t len = 0; len < 80u; len++)                                                 \
+        {                                                                                      \
+            for (size_t pos = 0; pos <= len; pos++)                                            \
+            {                                                                                  \
+                SIMD_TEST_FILL_WITH_NEEDLE(&arr, T, len, pos, needle, 3);                      \
+                (ok) &= cu_array_simd_find(&arr, &needle, type) == pos;                        \
+                (ok) &= cu_array_simd_count_eq(&arr, &needle, type) == (pos < len ? 1u : 0u);  \
+            }                                                                                  \
+        }                                                                                      \
+        cu_array_clear(&arr);                                                                  \
+        size_t expected = 0;                                                                   \
+        size_t first = 5000u;                                                                  \
+        for (size_t j = 0; j < 5000u; j++)                                                     \
+        {                                                                                      \
+            T x = (T)(j % 5u == 2u || j % 7u == 0u ? 7 : 1);                                   \
+            if (x == needle)                                                                   \
+            {                                                                                  \
+                first = first < j ? first : j;                                                 \
+                expected++;                                                                    \
+            }                                                                                  \
+            cu_array_append(&arr, &x);                                                         \
+        }                                                                                      \
+        (ok) &= cu_array_simd_find(&arr, &needle, type) == first;                              \
+        (ok) &= cu_array_simd_count_eq(&arr, &needle, type) == expected;                       \
+        cu_array_deinit(&arr);                                                                 \
+    } while (0)
+
+// Compares eq_mask against `cu_bitset_select` with a plain `==`, for lengths around the 64-item words.
+#define SIMD_TEST_EQ_MASK(ok, T, type, seed)                                                   \
+    do                                                                                         \
+    {                                                                                          \
+        uint64_t state = (seed);                                                               \
+        cu_array_t arr = (cu_array_t){0};                                                      \
+        cu_bitset_t got = (cu_bitset_t){0};                                                    \
+        cu_array_init(&arr, sizeof(T));                                                        \
+        cu_bitset_init(&got);                                                                  \
+        T needle = (T)3;                                                                       \
+        for (size_t len = 0; len < 700u; len += 13u)                                           \
+        {                                                                                      \
+            cu_array_clear(&arr);                                                              \
+            size_t expected = 0;                                                               \
+            for (size_t j = 0; j < len; j++)                                                   \
+            {                                                                                  \
+                T x = (T)(simd_test_random(&state) % 4u);                                      \
+                expected += x == needle;                                                       \
+                cu_array_append(&arr, &x);                                                     \
+            }                                                                                  \
+            (ok) &= cu_array_simd_eq_mask(&arr, &needle, type, &got) == 0;                     \
+            (ok) &= got.length == len && cu_bitset_count(&got) == expected;                    \
+            for (size_t j = 0; j < len; j++)                                                   \
+            {                                                                                  \
+                (ok) &= cu_bitset_test(&got, j) == (*(T *)cu_array_at(&arr, j) == needle);     \
+            }                                                                                  \
+        }                                                                                      \
+        cu_bitset_deinit(&got);                                                                \
+        cu_array_deinit(&arr);                                                                 \
+    } while (0)
+
+// Compares min and max against a plain loop over random items, for lengths around the vector widths.
+#define SIMD_TEST_MIN_MAX(ok, T, type, seed)                                                   \
+    do                                                                                         \
+    {                                                                                          \
+        uint64_t state = (seed);                                                               \
+        cu_array_t arr = (cu_array_t){0};                                                      \
+        cu_array_init(&arr, sizeof(T));                                                        \
+        for (size_t len = 1; len < 300u; len += 7u)                                            \
+        {                                                                                      \
+            cu_array_clear(&arr);                                                              \
+            T lo = (T)0;                                                                       \
+            T hi = (T)0;                                                                       \
+            for (size_t j = 0; j < len; j++)                                                   \
+            {                                                                                  \
+                uint64_t r = simd_test_random(&state);                                         \
+                T x;                                                                           \
+                if ((type) == CU_SIMD_FLOAT)                                                   \
+                {                                                                              \
+                    x = (T)((double)(int64_t)(r % 2000001u) - 1000000.0) / (T)8;             \
+                }                                                                              \
+                else                                                                           \
+                {                                                                              \
+                    cu_memcpy(&x, &r, sizeof(T));                                              \
+                }                                                                              \
+                lo = (j == 0 || x < lo) ? x : lo;                                              \
+                hi = (j == 0 || x > hi) ? x : hi;                                              \
+                cu_array_append(&arr, &x);                                                     \
+            }                                                                                  \
+            T got_lo = (T)1;                                                                   \
+            T got_hi = (T)1;                                                                   \
+            (ok) &= cu_array_simd_min(&arr, &got_lo, type) == 0 && got_lo == lo;               \
+            (ok) &= cu_array_simd_max(&arr, &got_hi, type) == 0 && got_hi == hi;               \
+        }                                                                                      \
+        cu_array_deinit(&arr);                                                                 \
+    } while (0)
+
+// Compares the sum against a plain loop over random items, with the same wrapping `SUM_T`.
+#define SIMD_TEST_SUM(ok, T, SUM_T, type, seed)                                                \
+    do                                                                                         \
+    {                                                                                          \
+        uint64_t state = (seed);                                                               \
+        cu_array_t arr = (cu_array_t){0};                                                      \
+        cu_array_init(&arr, sizeof(T));                                                        \
+        for (size_t len = 0; len < 2000u; len += 37u)                                          \
+        {                                                                                      \
+            cu_array_clear(&arr);                                                              \
+            uint64_t expected = 0;                                                             \
+            for (size_t j = 0; j < len; j++)                                                   \
+            {                                                                                  \
+                uint64_t r = simd_test_random(&state);                                         \
+                T x;                                                                           \
+                cu_memcpy(&x, &r, sizeof(T));                                                  \
+                expected += (uint64_t)x;                                                       \
+                cu_array_append(&arr, &x);                                                     \
+            }                                                                                  \
+            SUM_T got = (SUM_T)1;                                                              \
+            SUM_T want;                                                                        \
+            cu_memcpy(&want, &expected, sizeof(want));                                         \
+            (ok) &= cu_array_simd_sum(&arr, &got, type) == 0 && got == want;                   \
+        }                                                                                      \
+        cu_array_deinit(&arr);                                                                 \
+    } while (0)
+
+int test_cu_array_simd_tc_1()
+{
+    CU_TEST_START("cu_array_simd find and count_eq", "Checks every element type against a plain loop.");
+
+    int ok = 1;
+    SIMD_TEST_FIND(ok, uint8_t, CU_SIMD_UNSIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, int8_t, CU_SIMD_SIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, uint16_t, CU_SIMD_UNSIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, int16_t, CU_SIMD_SIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, uint32_t, CU_SIMD_UNSIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, int32_t, CU_SIMD_SIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, uint64_t, CU_SIMD_UNSIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, int64_t, CU_SIMD_SIGNED);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, float, CU_SIMD_FLOAT);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_FIND(ok, double, CU_SIMD_FLOAT);
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("More than 255 matches per lane, the 8-bit counters must not wrap.");
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, 1);
+    uint8_t zero = 0;
+    for (size_t i = 0; i < 100000u; i++)
+    {
+        cu_array_append(&arr, &zero);
+    }
+    CU_TEST_CHECK(cu_array_simd_count_eq(&arr, &zero, CU_SIMD_UNSIGNED) == 100000u);
+    CU_TEST_CHECK(cu_array_simd_find(&arr, &zero, CU_SIMD_UNSIGNED) == 0u);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Floats compare with ==.");
+    cu_array_init(&arr, sizeof(float));
+    float values[5] = {1.0f, -0.0f, 2.0f, 0.0f, 3.0f};
+    cu_array_extend(&arr, values, 5);
+    float positive_zero = 0.0f;
+    CU_TEST_CHECK(cu_array_simd_find(&arr, &positive_zero, CU_SIMD_FLOAT) == 1u);
+    CU_TEST_CHECK(cu_array_simd_count_eq(&arr, &positive_zero, CU_SIMD_FLOAT) == 2u);
+    cu_array_deinit(&arr);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_simd_tc_2()
+{
+    CU_TEST_START("cu_array_simd min and max", "Checks every element type against a plain loop.");
+
+    int ok = 1;
+    SIMD_TEST_MIN_MAX(ok, uint8_t, CU_SIMD_UNSIGNED, 1u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, int8_t, CU_SIMD_SIGNED, 2u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, uint16_t, CU_SIMD_UNSIGNED, 3u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, int16_t, CU_SIMD_SIGNED, 4u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, uint32_t, CU_SIMD_UNSIGNED, 5u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, int32_t, CU_SIMD_SIGNED, 6u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, uint64_t, CU_SIMD_UNSIGNED, 7u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, int64_t, CU_SIMD_SIGNED, 8u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, float, CU_SIMD_FLOAT, 9u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_MIN_MAX(ok, double, CU_SIMD_FLOAT, 10u);
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Unsigned and signed order differ for the same bits.");
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(uint32_t));
+    for (uint32_t i = 0; i < 64u; i++)
+    {
+        uint32_t x = i == 33u ? 0x80000000u : i + 1u;
+        cu_array_append(&arr, &x);
+    }
+    uint32_t umax = 0;
+    int32_t smin = 0;
+    CU_TEST_CHECK(cu_array_simd_max(&arr, &umax, CU_SIMD_UNSIGNED) == 0 && umax == 0x80000000u);
+    CU_TEST_CHECK(cu_array_simd_min(&arr, &smin, CU_SIMD_SIGNED) == 0 && smin == INT32_MIN);
+    cu_array_clear(&arr);
+    CU_TEST_CHECK(cu_array_simd_min(&arr, &umax, CU_SIMD_UNSIGNED) == 1);
+    cu_array_deinit(&arr);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_simd_tc_3()
+{
+    CU_TEST_START("cu_array_simd sum", "Checks integer sums modulo 2^64 and float sums in double precision.");
+
+    int ok = 1;
+    SIMD_TEST_SUM(ok, uint8_t, uint64_t, CU_SIMD_UNSIGNED, 11u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, int8_t, int64_t, CU_SIMD_SIGNED, 12u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, uint16_t, uint64_t, CU_SIMD_UNSIGNED, 13u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, int16_t, int64_t, CU_SIMD_SIGNED, 14u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, uint32_t, uint64_t, CU_SIMD_UNSIGNED, 15u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, int32_t, int64_t, CU_SIMD_SIGNED, 16u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, uint64_t, uint64_t, CU_SIMD_UNSIGNED, 17u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_SUM(ok, int64_t, int64_t, CU_SIMD_SIGNED, 18u);
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Small integers are exact in double precision, whatever the order.");
+    cu_array_t floats = (cu_array_t){0};
+    cu_array_t doubles = (cu_array_t){0};
+    cu_array_init(&floats, sizeof(float));
+    cu_array_init(&doubles, sizeof(double));
+    double expected = 0.0;
+    for (int i = 0; i < 1003; i++)
+    {
+        float f = (float)(i % 17 - 8);
+        double d = (double)(i * 3 - 700);
+        expected += (double)f;
+        cu_array_append(&floats, &f);
+        cu_array_append(&doubles, &d);
+    }
+    double got = 1.0;
+    CU_TEST_CHECK(cu_array_simd_sum(&floats, &got, CU_SIMD_FLOAT) == 0 && got == expected);
+    CU_TEST_CHECK(cu_array_simd_sum(&doubles, &got, CU_SIMD_FLOAT) == 0 && got == 1003.0 * 1002.0 * 3.0 / 2.0 - 700.0 * 1003.0);
+    cu_array_clear(&floats);
+    CU_TEST_CHECK(cu_array_simd_sum(&floats, &got, CU_SIMD_FLOAT) == 0 && got == 0.0);
+    cu_array_deinit(&floats);
+    cu_array_deinit(&doubles);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_simd_tc_4()
+{
+    CU_TEST_START("cu_array_simd invalid arguments", "Checks item sizes and types the kernels don't support.");
+
+    cu_array_t arr = (cu_array_t){0};
+    uint32_t x = 1;
+    uint64_t sum = 0;
+    CU_TEST_CHECK(cu_array_simd_find(NULL, &x, CU_SIMD_UNSIGNED) == 0u);
+    CU_TEST_CHECK(cu_array_simd_find(&arr, &x, CU_SIMD_UNSIGNED) == 0u);
+    CU_TEST_CHECK(cu_array_simd_sum(&arr, &sum, CU_SIMD_UNSIGNED) == 1);
+
+    cu_array_init(&arr, 3);
+    unsigned char item[3] = {1, 2, 3};
+    cu_array_append(&arr, item);
+    CU_TEST_CHECK(cu_array_simd_find(&arr, item, CU_SIMD_UNSIGNED) == 1u);
+    CU_TEST_CHECK(cu_array_simd_count_eq(&arr, item, CU_SIMD_UNSIGNED) == 0u);
+    CU_TEST_CHECK(cu_array_simd_min(&arr, item, CU_SIMD_UNSIGNED) == 1);
+    cu_array_deinit(&arr);
+
+    cu_array_init(&arr, sizeof(uint16_t));
+    uint16_t y = 1;
+    cu_array_append(&arr, &y);
+    CU_TEST_CHECK(cu_array_simd_max(&arr, &y, CU_SIMD_FLOAT) == 1);
+    CU_TEST_CHECK(cu_array_simd_max(&arr, &y, 42u) == 1);
+    CU_TEST_CHECK(cu_array_simd_find(&arr, NULL, CU_SIMD_UNSIGNED) == 1u);
+    CU_TEST_CHECK(cu_array_simd_sum(&arr, NULL, CU_SIMD_UNSIGNED) == 1);
+    cu_array_deinit(&arr);
+
+    const char *backend = cu_array_simd_backend();
+    CU_TEST_CHECK(backend != NULL && backend[0] != '\0');
+
+    CU_TEST_END();
+}
+
+int test_cu_array_simd_tc_5()
+{
+    CU_TEST_START("cu_array_simd eq_mask", "Checks the bitset of matches for every element type.");
+
+    int ok = 1;
+    SIMD_TEST_EQ_MASK(ok, uint8_t, CU_SIMD_UNSIGNED, 21u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, int8_t, CU_SIMD_SIGNED, 22u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, uint16_t, CU_SIMD_UNSIGNED, 23u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, int16_t, CU_SIMD_SIGNED, 24u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, uint32_t, CU_SIMD_UNSIGNED, 25u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, int32_t, CU_SIMD_SIGNED, 26u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, uint64_t, CU_SIMD_UNSIGNED, 27u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, int64_t, CU_SIMD_SIGNED, 28u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, float, CU_SIMD_FLOAT, 29u);
+    CU_TEST_CHECK(ok);
+    SIMD_TEST_EQ_MASK(ok, double, CU_SIMD_FLOAT, 30u);
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("The previous bits are replaced, then the mask selects the matching items.");
+    cu_array_t arr = (cu_array_t){0};
+    cu_bitset_t mask = (cu_bitset_t){0};
+    cu_array_init(&arr, sizeof(int16_t));
+    cu_bitset_init(&mask);
+    cu_bitset_resize(&mask, 1000);
+    cu_bitset_fill(&mask, 1);
+    for (int16_t i = 0; i < 300; i++)
+    {
+        int16_t x = (int16_t)(i % 3 == 0 ? -1 : i);
+        cu_array_append(&arr, &x);
+    }
+    int16_t minus_one = -1;
+    CU_TEST_CHECK(cu_array_simd_eq_mask(&arr, &minus_one, CU_SIMD_SIGNED, &mask) == 0);
+    CU_TEST_CHECK(mask.length == 300u && cu_bitset_count(&mask) == 100u);
+    CU_TEST_CHECK(cu_bitset_retain(&mask, &arr) == 0 && arr.length == 100u);
+    CU_TEST_CHECK(cu_array_simd_count_eq(&arr, &minus_one, CU_SIMD_SIGNED) == 100u);
+
+    CU_TEST_COMMENT("Invalid arguments.");
+    CU_TEST_CHECK(cu_array_simd_eq_mask(&arr, NULL, CU_SIMD_SIGNED, &mask) == 1);
+    CU_TEST_CHECK(cu_array_simd_eq_mask(&arr, &minus_one, CU_SIMD_FLOAT, &mask) == 1);
+    CU_TEST_CHECK(cu_array_simd_eq_mask(&arr, &minus_one, CU_SIMD_SIGNED, NULL) == 1);
+    cu_bitset_deinit(&mask);
+    cu_array_deinit(&arr);
+
+    CU_TEST_END();
+}
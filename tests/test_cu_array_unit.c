@@ -0,0 +1,430 @@
+#define _GNU_SOURCE
+#define CU_ARRAY_IMPL
+#define CU_ARRAY_THREADS
+#define CU_ARRAY_PSORT_THRESHOLD (256u)
+#define CU_ARRAY_MMAP
+#include "../cu_array.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+// Built once per storage unit width, e.g. `-DCU_UNIT=uint64_t` (see the Makefile), defaults to bytes.
+
+#define UNIT_TEST_STR2(x) #x
+#define UNIT_TEST_STR(x) UNIT_TEST_STR2(x)
+#define UNIT_TEST_MAX_ITEM (24u)
+#define UNIT_TEST_MAX_ITEMS (600u)
+
+int test_cu_array_unit_tc_1();
+int test_cu_array_unit_tc_2();
+int test_cu_array_unit_tc_3();
+int test_cu_array_unit_tc_4();
+
+CU_RUN_TESTS("cu_array CU_UNIT=" UNIT_TEST_STR(CU_UNIT) " unit test")
+{
+    test_cu_array_unit_tc_1();
+    test_cu_array_unit_tc_2();
+    test_cu_array_unit_tc_3();
+    test_cu_array_unit_tc_4();
+
+    CU_RUN_END();
+}
+
+static const size_t g_item_sizes[5] = {4u, 8u, 12u, 16u, 24u};
+static uint32_t g_seed = 12345u;
+
+static uint32_t unit_test_rand(void)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return g_seed >> 8;
+}
+
+/// Items are a `uint32_t` key, a `uint32_t` sequence number if there is room, then bytes derived from both.
+static void unit_test_fill(void *item, size_t item_size, uint32_t key, uint32_t seq)
+{
+    unsigned char *bytes = (unsigned char *)item;
+    memcpy(bytes, &key, sizeof(key));
+    if (item_size >= 8u)
+    {
+        memcpy(bytes + 4u, &seq, sizeof(seq));
+    }
+    for (size_t j = 8u; j < item_size; j++)
+    {
+        bytes[j] = (unsigned char)(key * 31u + seq * 7u + (uint32_t)j);
+    }
+}
+
+static uint32_t unit_test_key(const void *item)
+{
+    uint32_t key;
+    memcpy(&key, item, sizeof(key));
+    return key;
+}
+
+static uint32_t unit_test_seq(const void *item, size_t item_size)
+{
+    uint32_t seq = 0u;
+    if (item_size >= 8u)
+    {
+        memcpy(&seq, (const unsigned char *)item + 4u, sizeof(seq));
+    }
+    return seq;
+}
+
+static int unit_test_intact(const void *item, size_t item_size)
+{
+    uint64_t expected[UNIT_TEST_MAX_ITEM / 8u];
+    unit_test_fill(expected, item_size, unit_test_key(item), unit_test_seq(item, item_size));
+    return memcmp(expected, item, item_size) == 0;
+}
+
+int unit_test_compare(void *a, void *b)
+{
+    uint32_t x = unit_test_key(a);
+    uint32_t y = unit_test_key(b);
+    return (x > y) - (x < y);
+}
+
+int unit_test_keep_even(void *item, void *ctx)
+{
+    (void)ctx;
+    return unit_test_key(item) % 2u == 0u;
+}
+
+int test_cu_array_unit_tc_1()
+{
+    CU_TEST_START("cu_array layout with wide units", "Checks item sizes, offsets and alignment of the storage.");
+
+    size_t unit = sizeof(CU_UNIT);
+    cu_array_t arr = (cu_array_t){0};
+    if (unit > 1u)
+    {
+        CU_TEST_COMMENT("Item sizes that are not a multiple of the unit are rejected.");
+        CU_TEST_CHECK(cu_array_init(&arr, unit + 1u) == 1);
+        CU_TEST_CHECK(cu_array_init(&arr, unit / 2u) == 1);
+        unsigned char buffer[64];
+        CU_TEST_CHECK(cu_array_init_with_buffer(&arr, unit * 3u - 1u, buffer, 4) == 1);
+        CU_TEST_CHECK(arr.data == NULL && arr.item_size == 0u);
+    }
+
+    int ok = 1;
+    for (size_t s = 0; s < 5u; s++)
+    {
+        size_t item_size = g_item_sizes[s];
+        arr = (cu_array_t){0};
+        if (item_size % unit != 0u)
+        {
+            ok &= cu_array_init(&arr, item_size) == 1;
+            continue;
+        }
+        ok &= cu_array_init(&arr, item_size) == 0;
+        uint64_t item[UNIT_TEST_MAX_ITEM / 8u];
+        for (uint32_t i = 0; i < 100u; i++)
+        {
+            unit_test_fill(item, item_size, i, i);
+            ok &= cu_array_append(&arr, item) == 0;
+        }
+        ok &= (uintptr_t)arr.data % unit == 0u;
+        ok &= (size_t)((unsigned char *)cu_array_end(&arr) - (unsigned char *)cu_array_begin(&arr)) == 100u * item_size;
+        for (size_t i = 0; i < 100u; i++)
+        {
+            unsigned char *at = (unsigned char *)cu_array_at(&arr, i);
+            ok &= at == (unsigned char *)arr.data + i * item_size;
+            ok &= unit_test_key(at) == i && unit_test_intact(at, item_size);
+        }
+        ok &= cu_array_at(&arr, 100) == NULL;
+
+        size_t count = 0;
+        cu_array_iter_t it = cu_array_iter(&arr);
+        for (CU_UNIT *p; (p = cu_array_iter_next(&it)) != NULL; count++)
+        {
+            ok &= unit_test_key(p) == count;
+        }
+        ok &= count == 100u;
+        cu_array_deinit(&arr);
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Aligned storage is at least aligned to the unit.");
+    arr = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_init_aligned(&arr, 8u * unit, 1) == 0);
+    CU_TEST_CHECK(arr.alignment >= unit);
+    CU_TEST_CHECK(cu_array_reserve(&arr, 33) == 0 && (uintptr_t)arr.data % unit == 0u);
+    cu_array_deinit(&arr);
+    CU_TEST_REQUIRE(cu_array_init_padded(&arr, 24u, 64) == 0);
+    CU_TEST_CHECK(arr.item_size == 64u && cu_array_reserve(&arr, 5) == 0 && (uintptr_t)arr.data % 64u == 0u);
+    cu_array_deinit(&arr);
+
+    CU_TEST_COMMENT("Typed arrays over 8-byte items.");
+    cu_array_t words = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_init(&words, sizeof(uint64_t)) == 0);
+    for (uint64_t i = 0; i < 50u; i++)
+    {
+        uint64_t v = i * 0x0101010101010101ull;
+        cu_array_append(&words, &v);
+    }
+    uint64_t i = 0;
+    CU_ARRAY_FOREACH(uint64_t, w, &words)
+    {
+        ok &= *w == i * 0x0101010101010101ull;
+        i++;
+    }
+    CU_TEST_CHECK(ok && i == 50u);
+    cu_array_deinit(&words);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_unit_tc_2()
+{
+    CU_TEST_START("cu_array edits with wide units", "Checks inserts, removals and growth against a byte buffer.");
+
+    static unsigned char ref[UNIT_TEST_MAX_ITEMS * UNIT_TEST_MAX_ITEM];
+    int ok = 1;
+    for (size_t s = 0; s < 5u; s++)
+    {
+        size_t item_size = g_item_sizes[s];
+        if (item_size % sizeof(CU_UNIT) != 0u)
+        {
+            continue;
+        }
+        cu_array_t arr = (cu_array_t){0};
+        cu_array_init(&arr, item_size);
+        size_t len = 0;
+        uint64_t items[4u * UNIT_TEST_MAX_ITEM / 8u];
+        for (uint32_t step = 0; step < 2000u && ok; step++)
+        {
+            uint32_t op = unit_test_rand() % 8u;
+            size_t pos = len == 0u ? 0u : unit_test_rand() % (len + 1u);
+            size_t n = 1u + unit_test_rand() % 4u;
+            if (len + n > UNIT_TEST_MAX_ITEMS)
+            {
+                op = 4u;
+            }
+            if (op <= 1u)
+            {
+                unit_test_fill(items, item_size, step, 0u);
+                ok &= cu_array_append(&arr, items) == 0;
+                memcpy(ref + len * item_size, items, item_size);
+                len++;
+            }
+            else if (op == 2u)
+            {
+                unit_test_fill(items, item_size, step, 1u);
+                ok &= cu_array_insert(&arr, items, pos) == 0;
+                memmove(ref + (pos + 1u) * item_size, ref + pos * item_size, (len - pos) * item_size);
+                memcpy(ref + pos * item_size, items, item_size);
+                len++;
+            }
+            else if (op == 3u)
+            {
+                for (size_t k = 0; k < n; k++)
+                {
+                    unit_test_fill((unsigned char *)items + k * item_size, item_size, step, (uint32_t)k);
+                }
+                ok &= cu_array_insert_range(&arr, items, n, pos) == 0;
+                memmove(ref + (pos + n) * item_size, ref + pos * item_size, (len - pos) * item_size);
+                memcpy(ref + pos * item_size, items, n * item_size);
+                len += n;
+            }
+            else if (len == 0u)
+            {
+                ok &= cu_array_remove_at(&arr, 0) == 1;
+            }
+            else if (op == 4u)
+            {
+                n = n > len - pos ? len - pos : n;
+                ok &= cu_array_remove_range(&arr, pos, n) == 0;
+                memmove(ref + pos * item_size, ref + (pos + n) * item_size, (len - pos - n) * item_size);
+                len -= n;
+            }
+            else if (op == 5u)
+            {
+                pos = pos % len;
+                ok &= cu_array_remove_at(&arr, pos) == 0;
+                memmove(ref + pos * item_size, ref + (pos + 1u) * item_size, (len - pos - 1u) * item_size);
+                len--;
+            }
+            else if (op == 6u)
+            {
+                pos = pos % len;
+                ok &= cu_array_swap_remove(&arr, pos) == 0;
+                memcpy(ref + pos * item_size, ref + (len - 1u) * item_size, item_size);
+                len--;
+            }
+            else
+            {
+                ok &= cu_array_shrink_to_fit(&arr) == 0 && arr.capacity == arr.length;
+            }
+            ok &= arr.length == len && (len == 0u || memcmp(arr.data, ref, len * item_size) == 0);
+        }
+
+        CU_TEST_COMMENT("retain keeps the kept items in order.");
+        ok &= cu_array_retain(&arr, unit_test_keep_even, NULL) == 0;
+        size_t kept = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            if (unit_test_key(ref + i * item_size) % 2u == 0u)
+            {
+                memmove(ref + kept * item_size, ref + i * item_size, item_size);
+                kept++;
+            }
+        }
+        ok &= arr.length == kept && memcmp(arr.data, ref, kept * item_size) == 0;
+        ok &= cu_array_reserve(&arr, 4096) == 0 && arr.capacity >= 4096u && memcmp(arr.data, ref, kept * item_size) == 0;
+        cu_array_deinit(&arr);
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_END();
+}
+
+int test_cu_array_unit_tc_3()
+{
+    CU_TEST_START("cu_array sorts with wide units", "Checks every sort moves whole items, and the searches.");
+
+    int ok = 1;
+    for (size_t s = 0; s < 5u; s++)
+    {
+        size_t item_size = g_item_sizes[s];
+        if (item_size % sizeof(CU_UNIT) != 0u)
+        {
+            continue;
+        }
+        for (int sort = 0; sort < 4; sort++)
+        {
+            cu_array_t arr = (cu_array_t){0};
+            cu_array_init(&arr, item_size);
+            uint64_t item[UNIT_TEST_MAX_ITEM / 8u];
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < 1000u; i++)
+            {
+                uint32_t key = unit_test_rand() % 300u;
+                unit_test_fill(item, item_size, key, i);
+                cu_array_append(&arr, item);
+                sum += key;
+            }
+            int rc = sort == 0   ? cu_array_qsort(&arr, unit_test_compare)
+                     : sort == 1 ? cu_array_stable_sort(&arr, unit_test_compare)
+                     : sort == 2 ? cu_array_radix_sort(&arr, 0, sizeof(uint32_t), CU_RADIX_UNSIGNED)
+                                 : cu_array_psort(&arr, unit_test_compare, 4);
+            ok &= rc == 0;
+            uint64_t sorted_sum = 0;
+            for (size_t i = 0; i < arr.length; i++)
+            {
+                CU_UNIT *p = cu_array_at(&arr, i);
+                sorted_sum += unit_test_key(p);
+                ok &= unit_test_intact(p, item_size);
+                if (i > 0u)
+                {
+                    CU_UNIT *q = cu_array_at(&arr, i - 1u);
+                    ok &= unit_test_key(q) <= unit_test_key(p);
+                    if ((sort == 1 || sort == 2) && item_size >= 8u && unit_test_key(q) == unit_test_key(p))
+                    {
+                        ok &= unit_test_seq(q, item_size) < unit_test_seq(p, item_size);
+                    }
+                }
+            }
+            ok &= sorted_sum == sum;
+
+            unit_test_fill(item, item_size, 150u, 0u);
+            size_t lb = cu_array_lower_bound(&arr, item, unit_test_compare);
+            ok &= lb == arr.length || unit_test_key(cu_array_at(&arr, lb)) >= 150u;
+            ok &= lb == 0u || unit_test_key(cu_array_at(&arr, lb - 1u)) < 150u;
+            CU_UNIT *found = cu_array_bsearch(&arr, item, unit_test_compare);
+            ok &= found == NULL || unit_test_key(found) == 150u;
+            cu_array_deinit(&arr);
+        }
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Eytzinger layout and merge_k.");
+    size_t item_size = 8u * sizeof(CU_UNIT) <= UNIT_TEST_MAX_ITEM ? 8u * sizeof(CU_UNIT) : 16u;
+    cu_array_t a = (cu_array_t){0};
+    cu_array_t b = (cu_array_t){0};
+    cu_array_t merged = (cu_array_t){0};
+    cu_array_init(&a, item_size);
+    cu_array_init(&b, item_size);
+    cu_array_init(&merged, item_size);
+    uint64_t item[UNIT_TEST_MAX_ITEM / 8u];
+    for (uint32_t i = 0; i < 200u; i++)
+    {
+        unit_test_fill(item, item_size, 2u * i, i);
+        cu_array_append(&a, item);
+        unit_test_fill(item, item_size, 2u * i + 1u, i);
+        cu_array_append(&b, item);
+    }
+    cu_array_t *srcs[2] = {&a, &b};
+    CU_TEST_CHECK(cu_array_merge_k(&merged, srcs, 2, unit_test_compare) == 0 && merged.length == 400u);
+    for (size_t i = 0; i < merged.length; i++)
+    {
+        ok &= unit_test_key(cu_array_at(&merged, i)) == i && unit_test_intact(cu_array_at(&merged, i), item_size);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_array_eytzinger_build(&merged) == 0);
+    for (uint32_t key = 0; key < 400u; key += 7u)
+    {
+        unit_test_fill(item, item_size, key, 0u);
+        CU_UNIT *found = cu_array_eytzinger_search(&merged, item, unit_test_compare);
+        ok &= found != NULL && unit_test_key(found) == key && unit_test_intact(found, item_size);
+    }
+    unit_test_fill(item, item_size, 400u, 0u);
+    CU_TEST_CHECK(ok && cu_array_eytzinger_search(&merged, item, unit_test_compare) == NULL);
+
+    cu_array_deinit(&a);
+    cu_array_deinit(&b);
+    cu_array_deinit(&merged);
+    CU_TEST_END();
+}
+
+int test_cu_array_unit_tc_4()
+{
+    CU_TEST_START("cu_array views and files with wide units", "Checks slices, from_view and a save/map round trip.");
+
+    size_t item_size = 2u * sizeof(CU_UNIT) < 8u ? 8u : 2u * sizeof(CU_UNIT);
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_init(&arr, item_size);
+    uint64_t item[UNIT_TEST_MAX_ITEM / 8u];
+    for (uint32_t i = 0; i < 64u; i++)
+    {
+        unit_test_fill(item, item_size, 63u - i, i);
+        cu_array_append(&arr, item);
+    }
+
+    cu_array_view_t view = (cu_array_view_t){0};
+    cu_array_view_t sub = (cu_array_view_t){0};
+    CU_TEST_REQUIRE(cu_array_slice(&arr, 10, 20, &view) == 0);
+    CU_TEST_CHECK((unsigned char *)view.data == (unsigned char *)arr.data + 10u * item_size);
+    CU_TEST_CHECK(cu_array_view_slice(view, 5, 10, &sub) == 0);
+    CU_TEST_CHECK(unit_test_key(cu_array_view_at(sub, 0)) == 48u && cu_array_view_at(sub, 10) == NULL);
+
+    CU_TEST_COMMENT("Sorting the view only reorders the viewed items.");
+    CU_TEST_CHECK(cu_array_view_qsort(view, unit_test_compare) == 0);
+    int ok = 1;
+    for (size_t i = 0; i < arr.length; i++)
+    {
+        uint32_t expected = i >= 10u && i < 30u ? (uint32_t)(i - 10u) + 34u : 63u - (uint32_t)i;
+        ok &= unit_test_key(cu_array_at(&arr, i)) == expected && unit_test_intact(cu_array_at(&arr, i), item_size);
+    }
+    CU_TEST_CHECK(ok);
+
+    cu_array_t copy = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_from_view(&copy, sub) == 0);
+    CU_TEST_CHECK(copy.length == 10u && copy.data == sub.data);
+    unit_test_fill(item, item_size, 1000u, 0u);
+    CU_TEST_CHECK(cu_array_append(&copy, item) == 0 && copy.data != sub.data);
+    CU_TEST_CHECK(memcmp(copy.data, sub.data, 10u * item_size) == 0 && unit_test_key(cu_array_at(&copy, 10)) == 1000u);
+    cu_array_deinit(&copy);
+
+    const char *path = "build/test_cu_array_unit_" UNIT_TEST_STR(CU_UNIT) ".bin";
+    cu_array_t mapped = (cu_array_t){0};
+    CU_TEST_REQUIRE(cu_array_save(&arr, path) == 0);
+    CU_TEST_REQUIRE(cu_array_map(&mapped, path, CU_ARRAY_MAP_READONLY) == 0);
+    CU_TEST_CHECK(mapped.item_size == item_size && mapped.length == arr.length);
+    CU_TEST_CHECK((uintptr_t)mapped.data % sizeof(CU_UNIT) == 0u);
+    CU_TEST_CHECK(memcmp(mapped.data, arr.data, arr.length * item_size) == 0);
+    cu_array_deinit(&mapped);
+    remove(path);
+
+    cu_array_deinit(&arr);
+    CU_TEST_END();
+}
@@ -0,0 +1,238 @@
+#define CU_ARRAY_IMPL
+#define CU_BITSET_IMPL
+#include "../cu_bitset.h"
+#define CU_ARENA_IMPL
+#include "../cu_arena.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+int test_cu_bitset_tc_1();
+int test_cu_bitset_tc_2();
+int test_cu_bitset_tc_3();
+int test_cu_bitset_tc_4();
+
+CU_RUN_TESTS("cu_bitset unit test")
+{
+    test_cu_bitset_tc_1();
+    test_cu_bitset_tc_2();
+    test_cu_bitset_tc_3();
+    test_cu_bitset_tc_4();
+
+    CU_RUN_END();
+}
+
+int bitset_test_is_odd(void *item, void *ctx)
+{
+    (void)ctx;
+    return *(int *)item % 2 != 0;
+}
+
+int bitset_test_is_multiple(void *item, void *ctx)
+{
+    return *(int *)item % *(int *)ctx == 0;
+}
+
+int test_cu_bitset_tc_1()
+{
+    CU_TEST_START("cu_bitset set, test and count", "Checks single bits, resizing and the zeroed tail.");
+
+    cu_bitset_t bs = (cu_bitset_t){0};
+    CU_TEST_CHECK(cu_bitset_init(NULL) == 1);
+    CU_TEST_REQUIRE(cu_bitset_init(&bs) == 0);
+    CU_TEST_CHECK(bs.length == 0u && cu_bitset_count(&bs) == 0u);
+    CU_TEST_CHECK(cu_bitset_test(&bs, 0) == 0);
+    CU_TEST_CHECK(cu_bitset_set(&bs, 0) == 1);
+
+    CU_TEST_CHECK(cu_bitset_resize(&bs, 130) == 0);
+    CU_TEST_CHECK(bs.length == 130u && bs.words.length == 3u && cu_bitset_count(&bs) == 0u);
+    CU_TEST_CHECK(cu_bitset_set(&bs, 0) == 0);
+    CU_TEST_CHECK(cu_bitset_set(&bs, 63) == 0);
+    CU_TEST_CHECK(cu_bitset_set(&bs, 64) == 0);
+    CU_TEST_CHECK(cu_bitset_set(&bs, 129) == 0);
+    CU_TEST_CHECK(cu_bitset_set(&bs, 130) == 1);
+    CU_TEST_CHECK(cu_bitset_count(&bs) == 4u);
+    CU_TEST_CHECK(cu_bitset_test(&bs, 63) == 1 && cu_bitset_test(&bs, 62) == 0 && cu_bitset_test(&bs, 130) == 0);
+    CU_TEST_CHECK(cu_bitset_unset(&bs, 63) == 0 && cu_bitset_test(&bs, 63) == 0);
+    CU_TEST_CHECK(cu_bitset_assign(&bs, 5, 7) == 0 && cu_bitset_test(&bs, 5) == 1);
+
+    CU_TEST_COMMENT("Shrinking drops the bits past the end, growing again brings back zeros.");
+    CU_TEST_CHECK(cu_bitset_resize(&bs, 65) == 0);
+    CU_TEST_CHECK(bs.words.length == 2u && cu_bitset_count(&bs) == 3u);
+    CU_TEST_CHECK(cu_bitset_resize(&bs, 200) == 0);
+    CU_TEST_CHECK(cu_bitset_count(&bs) == 3u && cu_bitset_test(&bs, 129) == 0);
+
+    CU_TEST_COMMENT("fill keeps the tail of the last word zero.");
+    CU_TEST_CHECK(cu_bitset_fill(&bs, 1) == 0 && cu_bitset_count(&bs) == 200u);
+    CU_TEST_CHECK(((uint64_t *)(void *)bs.words.data)[3] == (((uint64_t)1u << 8) - 1u));
+    CU_TEST_CHECK(cu_bitset_fill(&bs, 0) == 0 && cu_bitset_count(&bs) == 0u);
+
+    CU_TEST_COMMENT("push appends bits one at a time.");
+    CU_TEST_CHECK(cu_bitset_clear(&bs) == 0 && bs.length == 0u && bs.words.capacity >= 4u);
+    int ok = 1;
+    for (size_t i = 0; i < 1000u; i++)
+    {
+        ok &= cu_bitset_push(&bs, i % 3u == 0u) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(bs.length == 1000u && bs.words.length == 16u && cu_bitset_count(&bs) == 334u);
+    for (size_t i = 0; i < 1000u; i++)
+    {
+        ok &= cu_bitset_test(&bs, i) == (i % 3u == 0u);
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_CHECK(cu_bitset_reserve(&bs, 10000) == 0 && bs.words.capacity >= 157u && bs.length == 1000u);
+    CU_TEST_CHECK(cu_bitset_deinit(&bs) == 0 && bs.length == 0u && bs.words.data == NULL);
+
+    CU_TEST_END();
+}
+
+int test_cu_bitset_tc_2()
+{
+    CU_TEST_START("cu_bitset find_next", "Checks the search for set and unset bits across words.");
+
+    cu_bitset_t bs = (cu_bitset_t){0};
+    cu_bitset_init(&bs);
+    CU_TEST_CHECK(cu_bitset_find_next(&bs, 0) == 0u);
+    CU_TEST_CHECK(cu_bitset_find_next(NULL, 0) == 0u);
+    cu_bitset_resize(&bs, 1000);
+    CU_TEST_CHECK(cu_bitset_find_next(&bs, 0) == 1000u);
+    CU_TEST_CHECK(cu_bitset_find_next_unset(&bs, 0) == 0u);
+
+    size_t positions[6] = {3, 63, 64, 200, 511, 999};
+    for (size_t i = 0; i < 6u; i++)
+    {
+        cu_bitset_set(&bs, positions[i]);
+    }
+    size_t found[6] = {0};
+    size_t count = 0;
+    for (size_t i = cu_bitset_find_next(&bs, 0); i < bs.length; i = cu_bitset_find_next(&bs, i + 1u))
+    {
+        if (count < 6u)
+        {
+            found[count] = i;
+        }
+        count++;
+    }
+    CU_TEST_CHECK(count == 6u);
+    CU_TEST_CHECK(memcmp(found, positions, sizeof(positions)) == 0);
+    CU_TEST_CHECK(cu_bitset_find_next(&bs, 65) == 200u);
+    CU_TEST_CHECK(cu_bitset_find_next(&bs, 1000) == 1000u);
+
+    CU_TEST_COMMENT("Unset bits, the zero tail past the end must not be found.");
+    cu_bitset_fill(&bs, 1);
+    CU_TEST_CHECK(cu_bitset_find_next_unset(&bs, 0) == 1000u);
+    cu_bitset_unset(&bs, 128);
+    cu_bitset_unset(&bs, 700);
+    CU_TEST_CHECK(cu_bitset_find_next_unset(&bs, 0) == 128u);
+    CU_TEST_CHECK(cu_bitset_find_next_unset(&bs, 129) == 700u);
+    CU_TEST_CHECK(cu_bitset_find_next_unset(&bs, 701) == 1000u);
+    CU_TEST_CHECK(cu_bitset_find_next(&bs, 128) == 129u);
+
+    cu_bitset_deinit(&bs);
+    CU_TEST_END();
+}
+
+int test_cu_bitset_tc_3()
+{
+    CU_TEST_START("cu_bitset logical operations", "Checks and/or/xor/andnot against a per-bit loop.");
+
+    cu_bitset_t a = (cu_bitset_t){0};
+    cu_bitset_t b = (cu_bitset_t){0};
+    cu_bitset_init(&a);
+    cu_bitset_init(&b);
+    for (size_t i = 0; i < 777u; i++)
+    {
+        cu_bitset_push(&a, i % 2u == 0u);
+        cu_bitset_push(&b, i % 3u == 0u);
+    }
+
+    cu_bitset_t c = (cu_bitset_t){0};
+    cu_bitset_init(&c);
+    int ok = 1;
+    for (int op = 0; op < 4; op++)
+    {
+        cu_bitset_resize(&c, 0);
+        for (size_t i = 0; i < 777u; i++)
+        {
+            cu_bitset_push(&c, cu_bitset_test(&a, i));
+        }
+        int rc = op == 0 ? cu_bitset_and(&c, &b) : op == 1 ? cu_bitset_or(&c, &b) : op == 2 ? cu_bitset_xor(&c, &b) : cu_bitset_andnot(&c, &b);
+        ok &= rc == 0;
+        size_t expected = 0;
+        for (size_t i = 0; i < 777u; i++)
+        {
+            int x = cu_bitset_test(&a, i);
+            int y = cu_bitset_test(&b, i);
+            int want = op == 0 ? (x & y) : op == 1 ? (x | y) : op == 2 ? (x ^ y) : (x & !y);
+            ok &= cu_bitset_test(&c, i) == want;
+            expected += (size_t)want;
+        }
+        ok &= cu_bitset_count(&c) == expected;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_bitset_count(&a) == 389u && cu_bitset_count(&b) == 259u);
+
+    CU_TEST_COMMENT("The lengths must match.");
+    cu_bitset_push(&c, 1);
+    CU_TEST_CHECK(cu_bitset_and(&c, &b) == 1);
+    CU_TEST_CHECK(cu_bitset_or(&c, NULL) == 1);
+    CU_TEST_CHECK(cu_bitset_xor(NULL, &b) == 1);
+
+    cu_bitset_deinit(&a);
+    cu_bitset_deinit(&b);
+    cu_bitset_deinit(&c);
+    CU_TEST_END();
+}
+
+int test_cu_bitset_tc_4()
+{
+    CU_TEST_START("cu_bitset select and retain", "Checks masks built from predicates and applied to an array.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 4096);
+    cu_bitset_t odd = (cu_bitset_t){0};
+    cu_bitset_t multiple = (cu_bitset_t){0};
+    CU_TEST_REQUIRE(cu_bitset_init_with_allocator(&odd, cu_arena_allocator(&arena)) == 0);
+    CU_TEST_REQUIRE(cu_bitset_init_with_allocator(&multiple, cu_arena_allocator(&arena)) == 0);
+
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_t expected = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(int));
+    cu_array_init(&expected, sizeof(int));
+    for (int i = 0; i < 1000; i++)
+    {
+        cu_array_append(&arr, &i);
+        cu_array_append(&expected, &i);
+    }
+
+    int five = 5;
+    CU_TEST_CHECK(cu_bitset_select(&odd, &arr, bitset_test_is_odd, NULL) == 0);
+    CU_TEST_CHECK(cu_bitset_select(&multiple, &arr, bitset_test_is_multiple, &five) == 0);
+    CU_TEST_CHECK(odd.length == 1000u && cu_bitset_count(&odd) == 500u && cu_bitset_count(&multiple) == 200u);
+    CU_TEST_CHECK(arena.head != NULL);
+
+    CU_TEST_COMMENT("Odd multiples of 5, the same items cu_array_retain keeps.");
+    CU_TEST_CHECK(cu_bitset_and(&odd, &multiple) == 0 && cu_bitset_count(&odd) == 100u);
+    CU_TEST_CHECK(cu_bitset_retain(&odd, &arr) == 0);
+    cu_array_retain(&expected, bitset_test_is_odd, NULL);
+    cu_array_retain(&expected, bitset_test_is_multiple, &five);
+    CU_TEST_CHECK(arr.length == 100u && expected.length == 100u);
+    CU_TEST_CHECK(memcmp(arr.data, expected.data, arr.length * sizeof(int)) == 0);
+
+    CU_TEST_COMMENT("The mask must have one bit per item.");
+    CU_TEST_CHECK(cu_bitset_retain(&odd, &arr) == 1);
+    CU_TEST_CHECK(cu_bitset_select(&odd, &arr, NULL, NULL) == 1);
+
+    CU_TEST_COMMENT("All or nothing.");
+    cu_bitset_resize(&odd, arr.length);
+    cu_bitset_fill(&odd, 1);
+    CU_TEST_CHECK(cu_bitset_retain(&odd, &arr) == 0 && arr.length == 100u);
+    cu_bitset_fill(&odd, 0);
+    CU_TEST_CHECK(cu_bitset_retain(&odd, &arr) == 0 && arr.length == 0u);
+
+    cu_array_deinit(&arr);
+    cu_array_deinit(&expected);
+    cu_arena_deinit(&arena);
+    CU_TEST_END();
+}
@@ -0,0 +1,154 @@
+#define CU_CONC_ARRAY_IMPL
+#include "../cu_conc_array.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+#include <pthread.h>
+
+int test_cu_conc_array_tc_1();
+int test_cu_conc_array_tc_2();
+int test_cu_conc_array_tc_3();
+
+CU_RUN_TESTS("cu_conc_array unit test")
+{
+    test_cu_conc_array_tc_1();
+    test_cu_conc_array_tc_2();
+    test_cu_conc_array_tc_3();
+
+    CU_RUN_END();
+}
+
+#define CONC_TEST_THREADS (4u)
+#define CONC_TEST_PER_THREAD (50000u)
+
+typedef struct conc_test_item_s
+{
+    uint32_t thread;
+    uint32_t seq;
+} conc_test_item_t;
+
+typedef struct conc_test_worker_s
+{
+    cu_conc_array_t *arr;
+    uint32_t thread;
+    int ok;
+} conc_test_worker_t;
+
+void *conc_test_pusher(void *arg)
+{
+    conc_test_worker_t *w = (conc_test_worker_t *)arg;
+    w->ok = 1;
+    for (uint32_t i = 0; i < CONC_TEST_PER_THREAD; i++)
+    {
+        conc_test_item_t item = {w->thread, i};
+        size_t index = SIZE_MAX;
+        conc_test_item_t *stored = (conc_test_item_t *)cu_conc_array_push(w->arr, &item, &index);
+        // Our own item is readable right away, through the index and the returned pointer.
+        w->ok &= stored != NULL && (conc_test_item_t *)cu_conc_array_at(w->arr, index) == stored;
+        w->ok &= stored->thread == w->thread && stored->seq == i;
+    }
+    return NULL;
+}
+
+int test_cu_conc_array_tc_1()
+{
+    CU_TEST_START("cu_conc_array push and at", "Checks indexing across segment boundaries on one thread.");
+
+    cu_conc_array_t arr = (cu_conc_array_t){0};
+    CU_TEST_CHECK(cu_conc_array_init(&arr, 0) == 1);
+    CU_TEST_REQUIRE(cu_conc_array_init(&arr, sizeof(int)) == 0);
+    CU_TEST_CHECK(cu_conc_array_init(&arr, sizeof(int)) == 1);
+    CU_TEST_CHECK(cu_conc_array_length(&arr) == 0);
+    CU_TEST_CHECK(cu_conc_array_at(&arr, 0) == NULL);
+
+    int ok = 1;
+    for (int i = 0; i < 10000; i++)
+    {
+        size_t index = 0;
+        ok &= cu_conc_array_push(&arr, &i, &index) != NULL && index == (size_t)i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_conc_array_length(&arr) == 10000);
+    ok = 1;
+    for (int i = 0; i < 10000; i++)
+    {
+        int *x = (int *)cu_conc_array_at(&arr, (size_t)i);
+        ok &= x != NULL && *x == i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_conc_array_at(&arr, 10000) == NULL);
+
+    CU_TEST_COMMENT("Segments double in size: 64, 128, 256, ...");
+    size_t first = (size_t)1 << CU_CONC_ARRAY_FIRST_SEGMENT_SHIFT;
+    CU_TEST_CHECK((unsigned char *)cu_conc_array_at(&arr, first - 1) + sizeof(int) !=
+                  (unsigned char *)cu_conc_array_at(&arr, first));
+    CU_TEST_CHECK((unsigned char *)cu_conc_array_at(&arr, first) + sizeof(int) ==
+                  (unsigned char *)cu_conc_array_at(&arr, first + 1));
+    CU_TEST_CHECK(arr.segments[8] == NULL);
+
+    cu_conc_array_deinit(&arr);
+    CU_TEST_CHECK(arr.item_size == 0 && cu_conc_array_push(&arr, &ok, NULL) == NULL);
+    CU_TEST_END();
+}
+
+int test_cu_conc_array_tc_2()
+{
+    CU_TEST_START("cu_conc_array stable addresses", "Checks that items never move while the array grows.");
+
+    cu_conc_array_t arr = (cu_conc_array_t){0};
+    cu_conc_array_init(&arr, sizeof(double));
+    double first = 1.5;
+    double *stored = (double *)cu_conc_array_push(&arr, &first, NULL);
+    for (int i = 0; i < 100000; i++)
+    {
+        double x = (double)i;
+        cu_conc_array_push(&arr, &x, NULL);
+    }
+    CU_TEST_CHECK((double *)cu_conc_array_at(&arr, 0) == stored);
+    CU_TEST_CHECK(*stored == 1.5);
+    cu_conc_array_deinit(&arr);
+    CU_TEST_END();
+}
+
+int test_cu_conc_array_tc_3()
+{
+    CU_TEST_START("cu_conc_array concurrent pushes", "Checks that every item pushed from several threads is stored once.");
+
+    cu_conc_array_t arr = (cu_conc_array_t){0};
+    cu_conc_array_init(&arr, sizeof(conc_test_item_t));
+    conc_test_worker_t workers[CONC_TEST_THREADS];
+    pthread_t threads[CONC_TEST_THREADS];
+    for (uint32_t t = 0; t < CONC_TEST_THREADS; t++)
+    {
+        workers[t] = (conc_test_worker_t){&arr, t, 0};
+        pthread_create(&threads[t], NULL, conc_test_pusher, &workers[t]);
+    }
+    int ok = 1;
+    for (uint32_t t = 0; t < CONC_TEST_THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+        ok &= workers[t].ok;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_conc_array_length(&arr) == CONC_TEST_THREADS * CONC_TEST_PER_THREAD);
+
+    // Each thread's items appear in the order it pushed them.
+    uint32_t next_seq[CONC_TEST_THREADS] = {0};
+    ok = 1;
+    for (size_t i = 0; i < cu_conc_array_length(&arr); i++)
+    {
+        conc_test_item_t *item = (conc_test_item_t *)cu_conc_array_at(&arr, i);
+        ok &= item != NULL && item->thread < CONC_TEST_THREADS && item->seq == next_seq[item->thread];
+        if (item != NULL && item->thread < CONC_TEST_THREADS)
+        {
+            next_seq[item->thread]++;
+        }
+    }
+    CU_TEST_CHECK(ok);
+    for (uint32_t t = 0; t < CONC_TEST_THREADS; t++)
+    {
+        CU_TEST_CHECK(next_seq[t] == CONC_TEST_PER_THREAD);
+    }
+
+    cu_conc_array_deinit(&arr);
+    CU_TEST_END();
+}
@@ -0,0 +1,167 @@
+#define CU_ARRAY_IMPL
+#define CU_DEQUE_IMPL
+#include "../cu_deque.h"
+#define CU_ARENA_IMPL
+#include "../cu_arena.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+int test_cu_deque_tc_1();
+int test_cu_deque_tc_2();
+int test_cu_deque_tc_3();
+
+CU_RUN_TESTS("cu_deque unit test")
+{
+    test_cu_deque_tc_1();
+    test_cu_deque_tc_2();
+    test_cu_deque_tc_3();
+
+    CU_RUN_END();
+}
+
+int test_cu_deque_tc_1()
+{
+    CU_TEST_START("cu_deque push and pop at both ends", "Checks the order of items pushed and popped at either end.");
+
+    cu_deque_t dq = (cu_deque_t){0};
+    CU_TEST_CHECK(cu_deque_init(&dq, 0) == 1);
+    CU_TEST_REQUIRE(cu_deque_init(&dq, sizeof(int)) == 0);
+    int out = -1;
+    CU_TEST_CHECK(cu_deque_pop_front(&dq, &out) == 1);
+    CU_TEST_CHECK(cu_deque_pop_back(&dq, &out) == 1);
+    CU_TEST_CHECK(cu_deque_at(&dq, 0) == NULL);
+
+    // Front gets 99..0, back gets 100..199, so the deque holds 0..199 mirrored around 100.
+    int ok = 1;
+    for (int i = 0; i < 100; i++)
+    {
+        int front = 99 - i;
+        int back = 100 + i;
+        ok &= cu_deque_push_front(&dq, &front) == 0;
+        ok &= cu_deque_push_back(&dq, &back) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(dq.length == 200 && dq.capacity >= 200);
+    CU_TEST_CHECK((dq.capacity & (dq.capacity - 1u)) == 0u);
+    ok = 1;
+    for (size_t i = 0; i < 200; i++)
+    {
+        ok &= *(int *)cu_deque_at(&dq, i) == (int)i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_deque_at(&dq, 200) == NULL);
+
+    CU_TEST_CHECK(cu_deque_pop_front(&dq, &out) == 0 && out == 0);
+    CU_TEST_CHECK(cu_deque_pop_back(&dq, &out) == 0 && out == 199);
+    CU_TEST_CHECK(cu_deque_pop_front(&dq, NULL) == 0);
+    CU_TEST_CHECK(dq.length == 197 && *(int *)cu_deque_at(&dq, 0) == 2);
+
+    CU_TEST_CHECK(cu_deque_clear(&dq) == 0);
+    CU_TEST_CHECK(dq.length == 0 && cu_deque_pop_back(&dq, &out) == 1);
+    cu_deque_deinit(&dq);
+    CU_TEST_CHECK(dq.data == NULL && dq.capacity == 0);
+    CU_TEST_CHECK(cu_deque_deinit(&dq) == 1);
+    CU_TEST_END();
+}
+
+int test_cu_deque_tc_2()
+{
+    CU_TEST_START("cu_deque wrap-around, growth and drain",
+                  "Checks that growing a wrapped deque and draining it keep the order.");
+
+    cu_deque_t dq = (cu_deque_t){0};
+    cu_deque_init(&dq, sizeof(uint64_t));
+    CU_TEST_CHECK(cu_deque_reserve(&dq, 10) == 0);
+    CU_TEST_CHECK(dq.capacity == 16);
+
+    CU_TEST_COMMENT("Used as a FIFO, head walks around the buffer without growing it.");
+    uint64_t next = 0;
+    uint64_t expect = 0;
+    int ok = 1;
+    for (int round = 0; round < 100; round++)
+    {
+        for (int i = 0; i < 10; i++, next++)
+        {
+            ok &= cu_deque_push_back(&dq, &next) == 0;
+        }
+        for (int i = 0; i < 7; i++, expect++)
+        {
+            uint64_t out = 0;
+            ok &= cu_deque_pop_front(&dq, &out) == 0 && out == expect;
+        }
+        if (dq.length > 16)
+        {
+            break;
+        }
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(dq.head != 0);
+
+    CU_TEST_COMMENT("Keep pushing until the wrapped buffer has to grow.");
+    for (int i = 0; i < 1000; i++, next++)
+    {
+        ok &= cu_deque_push_back(&dq, &next) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    for (size_t i = 0; i < dq.length; i++)
+    {
+        ok &= *(uint64_t *)cu_deque_at(&dq, i) == expect + i;
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Wrap the front again, then drain into a contiguous array.");
+    for (int i = 0; i < 5; i++)
+    {
+        expect--;
+        ok &= cu_deque_push_front(&dq, &expect) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    size_t length = dq.length;
+    cu_array_t arr = (cu_array_t){0};
+    cu_array_t wrong = (cu_array_t){0};
+    cu_array_init(&arr, sizeof(uint64_t));
+    cu_array_init(&wrong, sizeof(uint32_t));
+    CU_TEST_CHECK(cu_deque_drain(&dq, &wrong) == 1);
+    CU_TEST_CHECK(dq.length == length);
+    uint64_t first = 12345;
+    cu_array_append(&arr, &first);
+    CU_TEST_CHECK(cu_deque_drain(&dq, &arr) == 0);
+    CU_TEST_CHECK(dq.length == 0 && arr.length == length + 1);
+    uint64_t *items = (uint64_t *)arr.data;
+    CU_TEST_CHECK(items[0] == 12345);
+    for (size_t i = 0; i < length; i++)
+    {
+        ok &= items[i + 1] == expect + i;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_deque_drain(&dq, &arr) == 0 && arr.length == length + 1);
+
+    cu_array_deinit(&arr);
+    cu_array_deinit(&wrong);
+    cu_deque_deinit(&dq);
+    CU_TEST_END();
+}
+
+int test_cu_deque_tc_3()
+{
+    CU_TEST_START("cu_deque with an allocator", "Checks that the ring buffer comes from the allocator.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 4096);
+    cu_deque_t dq = (cu_deque_t){0};
+    CU_TEST_REQUIRE(cu_deque_init_with_allocator(&dq, sizeof(int), cu_arena_allocator(&arena)) == 0);
+    int ok = 1;
+    for (int i = 0; i < 500; i++)
+    {
+        ok &= (i % 2 ? cu_deque_push_back(&dq, &i) : cu_deque_push_front(&dq, &i)) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(arena.head != NULL && dq.length == 500);
+    CU_TEST_CHECK(*(int *)cu_deque_at(&dq, 0) == 498 && *(int *)cu_deque_at(&dq, 499) == 499);
+    int out = 0;
+    CU_TEST_CHECK(cu_deque_pop_front(&dq, &out) == 0 && out == 498);
+    CU_TEST_CHECK(cu_deque_pop_back(&dq, &out) == 0 && out == 499);
+    cu_deque_deinit(&dq);
+    cu_arena_deinit(&arena);
+    CU_TEST_END();
+}
@@ -0,0 +1,198 @@
+#define CU_ARRAY_IMPL
+#define CU_MAP_IMPL
+#include "../cu_map.h"
+#define CU_ARENA_IMPL
+#include "../cu_arena.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+int test_cu_map_tc_1();
+int test_cu_map_tc_2();
+int test_cu_map_tc_3();
+
+CU_RUN_TESTS("cu_map unit test")
+{
+    test_cu_map_tc_1();
+    test_cu_map_tc_2();
+    test_cu_map_tc_3();
+
+    CU_RUN_END();
+}
+
+int test_cu_map_tc_1()
+{
+    CU_TEST_START("cu_map insert, get and remove", "Checks the basic operations on a map of integers.");
+
+    cu_map_t map = (cu_map_t){0};
+    CU_TEST_CHECK(cu_map_init(&map, 0, sizeof(int), NULL, NULL) == 1);
+    CU_TEST_REQUIRE(cu_map_init(&map, sizeof(int), sizeof(double), NULL, NULL) == 0);
+    CU_TEST_CHECK(cu_map_init(&map, sizeof(int), sizeof(double), NULL, NULL) == 1);
+    int key = 42;
+    CU_TEST_CHECK(cu_map_get(&map, &key) == NULL && cu_map_find(&map, &key) == 0);
+    CU_TEST_CHECK(cu_map_remove(&map, &key) == 1);
+
+    int ok = 1;
+    for (int i = 0; i < 100; i++)
+    {
+        double value = i * 1.5;
+        ok &= cu_map_insert(&map, &i, &value) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(map.keys.length == 100 && map.values.length == 100);
+    CU_TEST_CHECK(map.capacity * 7u >= 100u * 8u);
+    CU_TEST_CHECK(*(double *)cu_map_get(&map, &key) == 63.0);
+    CU_TEST_CHECK(cu_map_find(&map, &key) == 42);
+    CU_TEST_CHECK(cu_map_find(&map, NULL) == 100u && cu_map_get(&map, NULL) == NULL);
+    CU_TEST_CHECK(cu_map_find(NULL, &key) == 0u && cu_map_get(NULL, &key) == NULL);
+
+    CU_TEST_COMMENT("Inserting an existing key overwrites its value.");
+    double value = -1.0;
+    CU_TEST_CHECK(cu_map_insert(&map, &key, &value) == 0);
+    CU_TEST_CHECK(map.keys.length == 100 && *(double *)cu_map_get(&map, &key) == -1.0);
+
+    CU_TEST_COMMENT("Removal moves the last entry into the hole.");
+    CU_TEST_CHECK(cu_map_remove(&map, &key) == 0);
+    CU_TEST_CHECK(cu_map_get(&map, &key) == NULL && map.keys.length == 99);
+    CU_TEST_CHECK(*(int *)cu_map_key_at(&map, 42) == 99 && *(double *)cu_map_value_at(&map, 42) == 99 * 1.5);
+    int last = 99;
+    CU_TEST_CHECK(cu_map_find(&map, &last) == 42);
+    CU_TEST_CHECK(cu_map_key_at(&map, 99) == NULL && cu_map_value_at(&map, 99) == NULL);
+    ok = 1;
+    for (int i = 0; i < 100; i++)
+    {
+        double *found = (double *)cu_map_get(&map, &i);
+        ok &= i == 42 ? found == NULL : found != NULL && *found == i * 1.5;
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_CHECK(cu_map_clear(&map) == 0);
+    CU_TEST_CHECK(map.keys.length == 0 && cu_map_get(&map, &last) == NULL);
+    cu_map_deinit(&map);
+    CU_TEST_CHECK(map.slots == NULL && map.capacity == 0);
+    CU_TEST_CHECK(cu_map_deinit(&map) == 1);
+    CU_TEST_END();
+}
+
+static uint32_t map_test_rand(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+int test_cu_map_tc_2()
+{
+    CU_TEST_START("cu_map random inserts and removals",
+                  "Checks a map against a lookup table and that removals leave no tombstones.");
+
+    enum
+    {
+        KEYS = 4096
+    };
+    static unsigned char present[KEYS];
+    cu_map_t map = (cu_map_t){0};
+    cu_map_init(&map, sizeof(uint64_t), sizeof(uint32_t), NULL, NULL);
+    CU_TEST_CHECK(cu_map_reserve(&map, KEYS) == 0);
+    size_t capacity = map.capacity;
+    CU_TEST_CHECK(capacity * 7u >= KEYS * 8u && map.keys.capacity >= KEYS);
+
+    uint32_t state = 12345u;
+    size_t count = 0;
+    int ok = 1;
+    for (int step = 0; step < 200000; step++)
+    {
+        uint32_t r = map_test_rand(&state);
+        uint64_t key = (uint64_t)(r % KEYS) << 20;
+        uint32_t value = r;
+        if (r & 0x10000u)
+        {
+            ok &= cu_map_insert(&map, &key, &value) == 0;
+            count += present[r % KEYS] == 0;
+            present[r % KEYS] = 1;
+        }
+        else
+        {
+            ok &= cu_map_remove(&map, &key) == (present[r % KEYS] ? 0 : 1);
+            count -= present[r % KEYS];
+            present[r % KEYS] = 0;
+        }
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(map.keys.length == count && map.values.length == count);
+    CU_TEST_CHECK(map.capacity == capacity);
+    for (uint64_t k = 0; k < KEYS; k++)
+    {
+        uint64_t key = k << 20;
+        ok &= (cu_map_get(&map, &key) != NULL) == present[k];
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Every entry of the dense storage is found at its own index.");
+    for (size_t i = 0; i < map.keys.length; i++)
+    {
+        ok &= cu_map_find(&map, cu_map_key_at(&map, i)) == i;
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Removing everything leaves an empty table.");
+    for (uint64_t k = 0; k < KEYS; k++)
+    {
+        uint64_t key = k << 20;
+        cu_map_remove(&map, &key);
+    }
+    CU_TEST_CHECK(map.keys.length == 0);
+    size_t used = 0;
+    for (size_t i = 0; i < map.capacity; i++)
+    {
+        used += map.slots[i].entry != 0u;
+    }
+    CU_TEST_CHECK(used == 0);
+    cu_map_deinit(&map);
+    CU_TEST_END();
+}
+
+static size_t map_test_hash_str(const void *key, size_t key_size)
+{
+    (void)key_size;
+    const char *str = *(const char *const *)key;
+    return cu_map_hash_bytes(str, strlen(str));
+}
+
+static int map_test_eq_str(const void *a, const void *b, size_t key_size)
+{
+    (void)key_size;
+    return strcmp(*(const char *const *)a, *(const char *const *)b) == 0;
+}
+
+int test_cu_map_tc_3()
+{
+    CU_TEST_START("cu_map custom hash, sets and allocators",
+                  "Checks string keys through caller functions and a set backed by an arena.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 4096);
+    cu_map_t set = (cu_map_t){0};
+    CU_TEST_REQUIRE(cu_map_init_with_allocator(&set, sizeof(const char *), 0, map_test_hash_str, map_test_eq_str,
+                                               cu_arena_allocator(&arena)) == 0);
+    const char *words[5] = {"alpha", "beta", "gamma", "beta", "delta"};
+    int ok = 1;
+    for (int i = 0; i < 5; i++)
+    {
+        ok &= cu_map_insert(&set, &words[i], NULL) == 0;
+    }
+    CU_TEST_CHECK(ok && set.keys.length == 4);
+    CU_TEST_CHECK(arena.head != NULL && set.keys.allocator == cu_arena_allocator(&arena));
+
+    char buffer[8] = "gamma";
+    const char *probe = buffer;
+    CU_TEST_COMMENT("A set returns the stored key, which is not the probe.");
+    const char **stored = (const char **)cu_map_get(&set, &probe);
+    CU_TEST_CHECK(stored != NULL && *stored == words[2]);
+    CU_TEST_CHECK(cu_map_value_at(&set, 0) == NULL);
+    buffer[0] = 'G';
+    CU_TEST_CHECK(cu_map_get(&set, &probe) == NULL);
+    CU_TEST_CHECK(cu_map_remove(&set, &words[0]) == 0 && set.keys.length == 3);
+    CU_TEST_CHECK(cu_map_find(&set, &words[4]) == 0);
+    cu_map_deinit(&set);
+    cu_arena_deinit(&arena);
+    CU_TEST_END();
+}
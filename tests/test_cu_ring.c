@@ -0,0 +1,273 @@
+#define _POSIX_C_SOURCE 200809L
+#define CU_RING_IMPL
+#include "../cu_ring.h"
+#define CU_ARENA_IMPL
+#include "../cu_arena.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+
+int test_cu_ring_tc_1();
+int test_cu_ring_tc_2();
+int test_cu_ring_tc_3();
+int test_cu_ring_tc_4();
+
+CU_RUN_TESTS("cu_ring unit test")
+{
+    test_cu_ring_tc_1();
+    test_cu_ring_tc_2();
+    test_cu_ring_tc_3();
+    test_cu_ring_tc_4();
+
+    CU_RUN_END();
+}
+
+#define RING_TEST_ITEMS (200000u)
+#define RING_TEST_THREADS (4u)
+
+typedef struct ring_test_worker_s
+{
+    cu_ring_t *ring;
+    uint64_t first;
+    uint64_t count;
+    uint64_t sum;
+    int ok;
+} ring_test_worker_t;
+
+void *ring_test_spsc_producer(void *arg)
+{
+    ring_test_worker_t *w = (ring_test_worker_t *)arg;
+    uint64_t next = 0;
+    while (next < w->count)
+    {
+        // Alternate between single pushes and in-place batches.
+        if (next % 3u == 0u)
+        {
+            if (cu_ring_push(w->ring, &next) != 0)
+            {
+                sched_yield();
+                continue;
+            }
+            next++;
+            continue;
+        }
+        CU_UNIT *slots = NULL;
+        size_t n = cu_ring_reserve(w->ring, 50, &slots);
+        size_t i = 0;
+        for (; i < n && next + i < w->count; i++)
+        {
+            uint64_t x = next + i;
+            memcpy((unsigned char *)slots + sizeof(uint64_t) * i, &x, sizeof(x));
+        }
+        cu_ring_commit(w->ring, i);
+        next += i;
+        if (i == 0u)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void *ring_test_spsc_consumer(void *arg)
+{
+    ring_test_worker_t *w = (ring_test_worker_t *)arg;
+    uint64_t expected = 0;
+    w->ok = 1;
+    while (expected < w->count)
+    {
+        uint64_t batch[17];
+        size_t n = cu_ring_pop_n(w->ring, batch, 17);
+        if (n == 0u)
+        {
+            sched_yield();
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            w->ok &= batch[i] == expected;
+            expected++;
+        }
+    }
+    return NULL;
+}
+
+void *ring_test_mpmc_producer(void *arg)
+{
+    ring_test_worker_t *w = (ring_test_worker_t *)arg;
+    for (uint64_t i = 0; i < w->count; i++)
+    {
+        uint64_t x = w->first + i;
+        while (cu_ring_push(w->ring, &x) != 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void *ring_test_mpmc_consumer(void *arg)
+{
+    ring_test_worker_t *w = (ring_test_worker_t *)arg;
+    for (uint64_t i = 0; i < w->count; i++)
+    {
+        uint64_t x;
+        while (cu_ring_pop(w->ring, &x) != 0)
+        {
+            sched_yield();
+        }
+        w->sum += x;
+    }
+    return NULL;
+}
+
+int test_cu_ring_tc_1()
+{
+    CU_TEST_START("cu_ring push and pop", "Checks FIFO order, full and empty rings and the capacity rounding.");
+
+    cu_ring_t ring = (cu_ring_t){0};
+    CU_TEST_CHECK(cu_ring_init(&ring, 0, 8) == 1);
+    CU_TEST_CHECK(cu_ring_init(&ring, sizeof(int), 0) == 1);
+    CU_TEST_REQUIRE(cu_ring_init(&ring, sizeof(int), 5) == 0);
+    CU_TEST_CHECK(ring.capacity == 8);
+    CU_TEST_CHECK(cu_ring_init(&ring, sizeof(int), 5) == 1);
+    CU_TEST_CHECK(offsetof(cu_ring_t, tail) - offsetof(cu_ring_t, head) >= CU_RING_CACHE_LINE);
+
+    int x = 0;
+    CU_TEST_CHECK(cu_ring_pop(&ring, &x) == 1);
+    int ok = 1;
+    for (int round = 0; round < 5; round++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            int v = round * 100 + i;
+            ok &= cu_ring_push(&ring, &v) == 0;
+        }
+        ok &= cu_ring_push(&ring, &x) == 1;
+        ok &= cu_ring_size(&ring) == 8;
+        for (int i = 0; i < 5; i++)
+        {
+            ok &= cu_ring_pop(&ring, &x) == 0 && x == round * 100 + i;
+        }
+        for (int i = 5; i < 8; i++)
+        {
+            ok &= cu_ring_pop(&ring, &x) == 0 && x == round * 100 + i;
+        }
+        ok &= cu_ring_pop(&ring, &x) == 1 && cu_ring_size(&ring) == 0;
+    }
+    CU_TEST_CHECK(ok);
+
+    CU_TEST_COMMENT("Batches wrap around the end of the storage.");
+    int in[6] = {1, 2, 3, 4, 5, 6};
+    int out[8] = {0};
+    CU_TEST_CHECK(cu_ring_push_n(&ring, in, 5) == 5);
+    CU_TEST_CHECK(cu_ring_pop_n(&ring, out, 5) == 5);
+    CU_TEST_CHECK(cu_ring_push_n(&ring, in, 6) == 6);
+    CU_TEST_CHECK(cu_ring_push_n(&ring, in, 6) == 2);
+    CU_TEST_CHECK(cu_ring_pop_n(&ring, out, 8) == 8);
+    CU_TEST_CHECK(out[0] == 1 && out[5] == 6 && out[6] == 1 && out[7] == 2);
+    CU_TEST_CHECK(cu_ring_pop_n(&ring, out, 8) == 0);
+
+    cu_ring_deinit(&ring);
+    CU_TEST_CHECK(ring.data == NULL && cu_ring_push(&ring, &x) == 1);
+    CU_TEST_END();
+}
+
+int test_cu_ring_tc_2()
+{
+    CU_TEST_START("cu_ring reserve, commit, peek and consume", "Checks in-place batches and their limits.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 1024);
+    cu_ring_t ring = (cu_ring_t){0};
+    CU_TEST_REQUIRE(cu_ring_init_with_allocator(&ring, sizeof(int), 8, 0u, cu_arena_allocator(&arena)) == 0);
+
+    CU_UNIT *slots = NULL;
+    CU_TEST_CHECK(cu_ring_reserve(&ring, 6, &slots) == 6);
+    for (int i = 0; i < 6; i++)
+    {
+        ((int *)(void *)slots)[i] = i;
+    }
+    CU_TEST_CHECK(cu_ring_size(&ring) == 0);
+    CU_TEST_CHECK(cu_ring_commit(&ring, 9) == 1);
+    CU_TEST_CHECK(cu_ring_commit(&ring, 6) == 0);
+    CU_TEST_CHECK(cu_ring_size(&ring) == 6);
+
+    CU_UNIT *items = NULL;
+    CU_TEST_CHECK(cu_ring_peek(&ring, 4, &items) == 4);
+    CU_TEST_CHECK(((int *)(void *)items)[3] == 3);
+    CU_TEST_CHECK(cu_ring_consume(&ring, 7) == 1);
+    CU_TEST_CHECK(cu_ring_consume(&ring, 4) == 0);
+
+    CU_TEST_COMMENT("Reservations stop at the end of the storage, the rest comes with the next call.");
+    CU_TEST_CHECK(cu_ring_reserve(&ring, 6, &slots) == 2);
+    CU_TEST_CHECK(cu_ring_commit(&ring, 2) == 0);
+    CU_TEST_CHECK(cu_ring_reserve(&ring, 6, &slots) == 4);
+    CU_TEST_CHECK(slots == ring.data);
+    CU_TEST_CHECK(cu_ring_commit(&ring, 4) == 0);
+    CU_TEST_CHECK(cu_ring_reserve(&ring, 1, &slots) == 0);
+    CU_TEST_CHECK(cu_ring_peek(&ring, 8, &items) == 4);
+    CU_TEST_CHECK(((int *)(void *)items)[0] == 4 && ((int *)(void *)items)[1] == 5);
+
+    cu_ring_deinit(&ring);
+    cu_arena_deinit(&arena);
+    CU_TEST_END();
+}
+
+int test_cu_ring_tc_3()
+{
+    CU_TEST_START("cu_ring single producer single consumer", "Checks that every item arrives once and in order across threads.");
+
+    cu_ring_t ring = (cu_ring_t){0};
+    CU_TEST_REQUIRE(cu_ring_init(&ring, sizeof(uint64_t), 256) == 0);
+    ring_test_worker_t producer = {&ring, 0, RING_TEST_ITEMS, 0, 0};
+    ring_test_worker_t consumer = {&ring, 0, RING_TEST_ITEMS, 0, 0};
+    pthread_t threads[2];
+    pthread_create(&threads[0], NULL, ring_test_spsc_producer, &producer);
+    pthread_create(&threads[1], NULL, ring_test_spsc_consumer, &consumer);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    CU_TEST_CHECK(consumer.ok);
+    CU_TEST_CHECK(cu_ring_size(&ring) == 0);
+
+    cu_ring_deinit(&ring);
+    CU_TEST_END();
+}
+
+int test_cu_ring_tc_4()
+{
+    CU_TEST_START("cu_ring multiple producers and consumers", "Checks that no item is lost or duplicated.");
+
+    cu_ring_t ring = (cu_ring_t){0};
+    CU_TEST_REQUIRE(cu_ring_init_mpmc(&ring, sizeof(uint64_t), 64) == 0);
+    CU_UNIT *slots = NULL;
+    CU_TEST_CHECK(cu_ring_reserve(&ring, 1, &slots) == 0);
+
+    ring_test_worker_t producers[RING_TEST_THREADS];
+    ring_test_worker_t consumers[RING_TEST_THREADS];
+    pthread_t threads[2u * RING_TEST_THREADS];
+    uint64_t per_thread = RING_TEST_ITEMS / RING_TEST_THREADS;
+    for (size_t i = 0; i < RING_TEST_THREADS; i++)
+    {
+        producers[i] = (ring_test_worker_t){&ring, per_thread * i, per_thread, 0, 0};
+        consumers[i] = (ring_test_worker_t){&ring, 0, per_thread, 0, 0};
+        pthread_create(&threads[i], NULL, ring_test_mpmc_producer, &producers[i]);
+        pthread_create(&threads[RING_TEST_THREADS + i], NULL, ring_test_mpmc_consumer, &consumers[i]);
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < 2u * RING_TEST_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    for (size_t i = 0; i < RING_TEST_THREADS; i++)
+    {
+        sum += consumers[i].sum;
+    }
+    uint64_t n = per_thread * RING_TEST_THREADS;
+    CU_TEST_CHECK(sum == n * (n - 1u) / 2u);
+    CU_TEST_CHECK(cu_ring_size(&ring) == 0);
+
+    cu_ring_deinit(&ring);
+    CU_TEST_END();
+}
@@ -0,0 +1,147 @@
+#define CU_ARRAY_IMPL
+#define CU_SOA_IMPL
+#include "../cu_soa.h"
+#define CU_ARENA_IMPL
+#include "../cu_arena.h"
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+
+int test_cu_soa_tc_1();
+int test_cu_soa_tc_2();
+int test_cu_soa_tc_3();
+
+CU_RUN_TESTS("cu_soa unit test")
+{
+    test_cu_soa_tc_1();
+    test_cu_soa_tc_2();
+    test_cu_soa_tc_3();
+
+    CU_RUN_END();
+}
+
+// Fields of the test records: id, x, weight, flag (one storage unit wide, so it also works with a wider `CU_UNIT`).
+static const size_t soa_test_fields[4] = {sizeof(uint32_t), sizeof(float), sizeof(double), sizeof(CU_UNIT)};
+
+int soa_test_append(cu_soa_t *soa, uint32_t id)
+{
+    float x = (float)id * 0.5f;
+    double weight = (double)id * 2.0;
+    CU_UNIT flag = (CU_UNIT)(id % 2u);
+    const void *record[4] = {&id, &x, &weight, &flag};
+    return cu_soa_append(soa, record);
+}
+
+int soa_test_check(cu_soa_t *soa, size_t pos, uint32_t id)
+{
+    return *(uint32_t *)cu_soa_at(soa, 0, pos) == id && *(float *)cu_soa_at(soa, 1, pos) == (float)id * 0.5f &&
+           *(double *)cu_soa_at(soa, 2, pos) == (double)id * 2.0 && *cu_soa_at(soa, 3, pos) == (CU_UNIT)(id % 2u);
+}
+
+int test_cu_soa_tc_1()
+{
+    CU_TEST_START("cu_soa init, append and at", "Checks that every field lands in its own column.");
+
+    cu_soa_t soa = (cu_soa_t){0};
+    size_t bad_fields[2] = {4, 0};
+    CU_TEST_CHECK(cu_soa_init(&soa, bad_fields, 2) == 1);
+    CU_TEST_CHECK(cu_soa_init(&soa, soa_test_fields, 0) == 1);
+    CU_TEST_REQUIRE(cu_soa_init(&soa, soa_test_fields, 4) == 0);
+    CU_TEST_CHECK(cu_soa_init(&soa, soa_test_fields, 4) == 1);
+    CU_TEST_CHECK(soa.length == 0 && soa.num_fields == 4);
+    CU_TEST_CHECK(cu_soa_column(&soa, 0) == NULL);
+
+    int ok = 1;
+    for (uint32_t i = 0; i < 1000u; i++)
+    {
+        ok &= soa_test_append(&soa, i) == 0;
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(soa.length == 1000);
+    for (size_t f = 0; f < 4; f++)
+    {
+        CU_TEST_CHECK(soa.columns[f].length == 1000 && soa.columns[f].item_size == soa_test_fields[f]);
+    }
+    ok = 1;
+    for (uint32_t i = 0; i < 1000u; i++)
+    {
+        ok &= soa_test_check(&soa, i, i);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(cu_soa_at(&soa, 4, 0) == NULL);
+    CU_TEST_CHECK(cu_soa_at(&soa, 0, 1000) == NULL);
+
+    CU_TEST_COMMENT("A column is a plain contiguous array of one field.");
+    float *xs = (float *)cu_soa_column(&soa, 1);
+    double sum = 0.0;
+    for (size_t i = 0; i < soa.length; i++)
+    {
+        sum += (double)xs[i];
+    }
+    CU_TEST_CHECK(sum == 0.5 * 999.0 * 1000.0 / 2.0);
+
+    const void *missing[4] = {&sum, &sum, NULL, &sum};
+    CU_TEST_CHECK(cu_soa_append(&soa, missing) == 1);
+    CU_TEST_CHECK(soa.length == 1000 && soa.columns[0].length == 1000);
+
+    cu_soa_deinit(&soa);
+    CU_TEST_CHECK(soa.columns == NULL && soa.length == 0);
+    CU_TEST_CHECK(cu_soa_deinit(&soa) == 1);
+    CU_TEST_END();
+}
+
+int test_cu_soa_tc_2()
+{
+    CU_TEST_START("cu_soa reserve and remove", "Checks that reserve and removals keep the columns in step.");
+
+    cu_soa_t soa = (cu_soa_t){0};
+    CU_TEST_REQUIRE(cu_soa_init(&soa, soa_test_fields, 4) == 0);
+    CU_TEST_CHECK(cu_soa_reserve(&soa, 100) == 0);
+    for (size_t f = 0; f < 4; f++)
+    {
+        CU_TEST_CHECK(soa.columns[f].capacity >= 100);
+    }
+    for (uint32_t i = 0; i < 10u; i++)
+    {
+        soa_test_append(&soa, i);
+    }
+
+    CU_TEST_CHECK(cu_soa_remove_at(&soa, 0) == 0);
+    CU_TEST_CHECK(soa.length == 9 && soa_test_check(&soa, 0, 1) && soa_test_check(&soa, 8, 9));
+    CU_TEST_CHECK(cu_soa_swap_remove(&soa, 2) == 0);
+    CU_TEST_CHECK(soa.length == 8 && soa_test_check(&soa, 2, 9) && soa_test_check(&soa, 7, 8));
+    CU_TEST_CHECK(cu_soa_remove_at(&soa, 8) == 1);
+    CU_TEST_CHECK(cu_soa_swap_remove(&soa, 8) == 1);
+    for (size_t f = 0; f < 4; f++)
+    {
+        CU_TEST_CHECK(soa.columns[f].length == 8);
+    }
+
+    CU_TEST_CHECK(cu_soa_clear(&soa) == 0);
+    CU_TEST_CHECK(soa.length == 0 && soa.columns[2].length == 0 && soa.columns[2].capacity >= 100);
+    cu_soa_deinit(&soa);
+    CU_TEST_END();
+}
+
+int test_cu_soa_tc_3()
+{
+    CU_TEST_START("cu_soa with an allocator", "Checks that the columns and the column table come from the allocator.");
+
+    cu_arena_t arena = (cu_arena_t){0};
+    cu_arena_init(&arena, 4096);
+    cu_soa_t soa = (cu_soa_t){0};
+    CU_TEST_REQUIRE(cu_soa_init_with_allocator(&soa, soa_test_fields, 4, cu_arena_allocator(&arena)) == 0);
+    CU_TEST_CHECK(arena.head != NULL);
+    int ok = 1;
+    for (uint32_t i = 0; i < 300u; i++)
+    {
+        ok &= soa_test_append(&soa, i) == 0;
+    }
+    for (uint32_t i = 0; i < 300u; i++)
+    {
+        ok &= soa_test_check(&soa, i, i);
+    }
+    CU_TEST_CHECK(ok);
+    CU_TEST_CHECK(soa.columns[0].allocator == cu_arena_allocator(&arena));
+    cu_arena_deinit(&arena);
+    CU_TEST_END();
+}
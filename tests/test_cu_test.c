@@ -0,0 +1,63 @@
+#define _POSIX_C_SOURCE 200809L
+#define CU_TEST_PARALLEL
+#define CU_TEST_SILENT
+#include "../cu_test.h"
+#include <stdint.h>
+
+int test_cu_test_tc_1();
+int test_cu_test_tc_2();
+int test_cu_test_tc_3();
+int test_cu_test_tc_4();
+
+static const cu_test_entry_t tests[] = {
+    CU_TEST_ENTRY(test_cu_test_tc_1),
+    CU_TEST_ENTRY(test_cu_test_tc_2),
+    CU_TEST_ENTRY(test_cu_test_tc_3),
+    CU_TEST_ENTRY(test_cu_test_tc_4),
+};
+
+CU_RUN_TEST_TABLE("cu_test unit test", tests)
+
+int test_cu_test_tc_1()
+{
+    CU_TEST_START("cu_test checks", "Checks that passing checks are counted.");
+
+    CU_TEST_CHECK(1 + 1 == 2);
+    CU_TEST_REQUIRE(sizeof(tests[0].name) == sizeof(const char *));
+    CU_TEST_CHECK(__cu_test_result == 0);
+    CU_TEST_END();
+}
+
+// Many checks from several workers at once, the totals must still add up.
+int cu_test_many_checks(uint32_t seed)
+{
+    CU_TEST_START("cu_test many checks", "Runs a lot of checks.");
+
+    uint32_t x = seed;
+    for (int i = 0; i < 20000; i++)
+    {
+        x = x * 1664525u + 1013904223u;
+        CU_TEST_CHECK((x & 1u) == (x % 2u));
+    }
+    CU_TEST_END();
+}
+
+int test_cu_test_tc_2()
+{
+    return cu_test_many_checks(1u);
+}
+
+int test_cu_test_tc_3()
+{
+    return cu_test_many_checks(2u);
+}
+
+int test_cu_test_tc_4()
+{
+    CU_TEST_START("cu_test table", "Checks the generated table entries.");
+
+    CU_TEST_CHECK(sizeof(tests) / sizeof(tests[0]) == 4);
+    CU_TEST_CHECK(strcmp(tests[3].name, "test_cu_test_tc_4") == 0);
+    CU_TEST_CHECK(tests[3].fn == test_cu_test_tc_4);
+    CU_TEST_END();
+}